@@ -4,6 +4,7 @@ from dataclasses import dataclass
 
 import matplotlib.pyplot as plt
 import numpy as np
+import trace_stream
 from matplotlib.ticker import EngFormatter
 from run_analysis import icfg, rolling_mean
 from utils import (INDENT, get_test_title, print_file_saved,
@@ -52,7 +53,11 @@ class dependency_results:
                f"insts={self.n_inst}, dep_cnt={self.dep_arr_cnt})"
 
 def read_rf_trace(path: str) -> np.ndarray:
-    return np.fromfile(path, dtype=RF_DTYPE)
+    cols = trace_stream.read_rf_trace(path)
+    out = np.empty(len(cols["rd"]), dtype=RF_DTYPE)
+    for name, col in zip(RF_DTYPE.names, trace_stream.RF_TRACE_COLS):
+        out[name] = cols[col]
+    return out
 
 def decode_mnm(opc_g_val: int, opc_b_val: int) -> str:
     if opc_g_val != icfg.OPC_NONE:
@@ -0,0 +1,789 @@
+#!/usr/bin/env python3
+
+# Renders the binary execution log 'exec.bin' (--log_bin) as 'exec.log' text
+# Operands, memory addresses and SIMD lanes are decoded from the instruction
+# and the register file, tracked from the logged register updates
+# Layout is documented in src/exec_log.h
+
+import argparse
+import json
+import sys
+
+from trace_stream import open_trace
+
+TYPE_MASK = 0x3
+FLAG_CNT = 1 << 2
+FLAG_AUX = 1 << 3
+FLAG_RF = 1 << 4
+T_INST, T_TEXT, T_META = range(3)
+# column order, as in el_col_t
+C_TYPE, C_CNT, C_PC, C_INST, C_RD, C_RD_VAL, C_RDP, C_RDP_VAL, C_AUX, C_HM, \
+    C_TEXT, C_RF = range(12)
+
+INDENT = "    "
+M32 = 0xffffffff
+HM_NAMES = ["MISS", "HIT", None]
+
+RF_NAMES = [
+    ("x0", "zero"), ("x1", "ra"), ("x2", "sp"), ("x3", "gp"), ("x4", "tp"),
+    ("x5", "t0"), ("x6", "t1"), ("x7", "t2"), ("x8", "s0"), ("x9", "s1"),
+    ("x10", "a0"), ("x11", "a1"), ("x12", "a2"), ("x13", "a3"),
+    ("x14", "a4"), ("x15", "a5"), ("x16", "a6"), ("x17", "a7"),
+    ("x18", "s2"), ("x19", "s3"), ("x20", "s4"), ("x21", "s5"),
+    ("x22", "s6"), ("x23", "s7"), ("x24", "s8"), ("x25", "s9"),
+    ("x26", "s10"), ("x27", "s11"), ("x28", "t3"), ("x29", "t4"),
+    ("x30", "t5"), ("x31", "t6"),
+]
+
+# decoder tables, as in src/types.h
+ALU_REG = {0b0000: "add", 0b1000: "sub", 0b0001: "sll", 0b0101: "srl",
+           0b1101: "sra", 0b0010: "slt", 0b0011: "sltu", 0b0100: "xor",
+           0b0110: "or", 0b0111: "and"}
+ALU_MUL = ["mul", "mulh", "mulhsu", "mulhu", "div", "divu", "rem", "remu"]
+ALU_ZBB = {0x4: "min", 0x5: "minu", 0x6: "max", 0x7: "maxu"}
+ALU_IMM = {0b0000: "addi", 0b0001: "slli", 0b0101: "srli", 0b1101: "srai",
+           0b0010: "slti", 0b0011: "sltiu", 0b0100: "xori", 0b0110: "ori",
+           0b0111: "andi"}
+LOAD = {0: "lb", 1: "lh", 2: "lw", 4: "lbu", 5: "lhu"}
+STORE = {0: "sb", 1: "sh", 2: "sw"}
+BRANCH = {0: "beq", 1: "bne", 4: "blt", 5: "bge", 6: "bltu", 7: "bgeu"}
+CSR_OP = {1: "csrrw", 2: "csrrs", 3: "csrrc", 5: "csrrwi", 6: "csrrsi",
+          7: "csrrci"}
+I_NOP = 0x00000013
+I_MRET = 0x30200073
+I_WFI = 0x10500073
+I_FENCE_I = 0x0000100f
+I_RET = (0x00008067, 0x00028067)
+I_C_RET = 0x8082
+
+# simd, funct7 -> funct3 -> (name, params), as in src/core.cpp
+SIMD = {
+    0x00: {0: ("add16", (16, True, "add", False)),
+           2: ("add8", (8, True, "add", False)),
+           4: ("sub16", (16, True, "sub", False)),
+           6: ("sub8", (8, True, "sub", False))},
+    0x01: {0: ("qadd16", (16, True, "add", True)),
+           1: ("qadd16u", (16, False, "add", True)),
+           2: ("qadd8", (8, True, "add", True)),
+           3: ("qadd8u", (8, False, "add", True)),
+           4: ("qsub16", (16, True, "sub", True)),
+           5: ("qsub16u", (16, False, "sub", True)),
+           6: ("qsub8", (8, True, "sub", True)),
+           7: ("qsub8u", (8, False, "sub", True))},
+    0x02: {0: ("mul16", (16, True, False)), 2: ("mul8", (8, True, False)),
+           4: ("mulh16", (16, True, True)), 5: ("mulh16u", (16, False, True)),
+           6: ("mulh8", (8, True, True)), 7: ("mulh8u", (8, False, True))},
+    0x03: {0: ("wmul16", (16, True)), 1: ("wmul16u", (16, False)),
+           2: ("wmul8", (8, True)), 3: ("wmul8u", (8, False))},
+    0x04: {0: ("dot16", (16, True)), 1: ("dot16u", (16, False)),
+           2: ("dot8", (8, True)), 3: ("dot8u", (8, False)),
+           4: ("dot4", (4, True)), 5: ("dot4u", (4, False)),
+           6: ("dot2", (2, True)), 7: ("dot2u", (2, False))},
+    0x08: {0: ("min16", (16, True, min)), 1: ("min16u", (16, False, min)),
+           2: ("min8", (8, True, min)), 3: ("min8u", (8, False, min)),
+           4: ("max16", (16, True, max)), 5: ("max16u", (16, False, max)),
+           6: ("max8", (8, True, max)), 7: ("max8u", (8, False, max))},
+    0x09: {0: ("slli16", (16, False, "l")), 2: ("slli8", (8, False, "l")),
+           4: ("srli16", (16, False, "r")), 6: ("srli8", (8, False, "r")),
+           5: ("srai16", (16, True, "r")), 7: ("srai8", (8, True, "r"))},
+    0x20: {6: ("widen16", (16, True)), 7: ("widen16u", (16, False)),
+           0: ("widen8", (8, True)), 1: ("widen8u", (8, False)),
+           2: ("widen4", (4, True)), 3: ("widen4u", (4, False)),
+           4: ("widen2", (2, True)), 5: ("widen2u", (2, False))},
+    0x22: {0: ("narrow32", (32, False, False)),
+           2: ("narrow16", (16, False, False)),
+           4: ("narrow8", (8, False, False)),
+           6: ("narrow4", (4, False, False))},
+    0x23: {0: ("qnarrow32", (32, True, True)),
+           1: ("qnarrow32u", (32, True, False)),
+           2: ("qnarrow16", (16, True, True)),
+           3: ("qnarrow16u", (16, True, False)),
+           4: ("qnarrow8", (8, True, True)),
+           5: ("qnarrow8u", (8, True, False)),
+           6: ("qnarrow4", (4, True, True)),
+           7: ("qnarrow4u", (4, True, False))},
+    0x30: {0: ("txp16", (16,)), 2: ("txp8", (8,)), 4: ("txp4", (4,)),
+           6: ("txp2", (2,))},
+    0x3c: {0: ("dup16", (16,)), 1: ("vins16", (16,)), 2: ("dup8", (8,)),
+           3: ("vins8", (8,)), 4: ("dup4", (4,)), 5: ("vins4", (4,)),
+           6: ("dup2", (2,)), 7: ("vins2", (2,))},
+    0x3d: {0: ("vext16", (16, True)), 1: ("vext16u", (16, False)),
+           2: ("vext8", (8, True)), 3: ("vext8u", (8, False)),
+           4: ("vext4", (4, True)), 5: ("vext4u", (4, False)),
+           6: ("vext2", (2, True)), 7: ("vext2u", (2, False))},
+    0x7f: {0: ("scp.lcl", ()), 1: ("scp.rel", ())},
+}
+
+def s32(v):
+    v &= M32
+    return v - (1 << 32) if v & 0x80000000 else v
+
+def bits(v, hi, lo):
+    return (v >> lo) & ((1 << (hi - lo + 1)) - 1)
+
+def sext(v, b):
+    """Sign extend the low b bits of v"""
+    v &= (1 << b) - 1
+    return v - (1 << b) if v >> (b - 1) else v
+
+def extract_val(v, vbits, signed):
+    """As extract_val in src/core_exec_custom_simd.h"""
+    v &= (1 << vbits) - 1
+    if signed and (v >> (vbits - 1)):
+        v -= 1 << vbits
+    return v
+
+class ostream:
+    """
+    std::ostringstream as used by the disassembler: width applies to the next
+    value only, while adjustment, fill and base are sticky until cleared
+    """
+    def __init__(self):
+        self.buf = []
+        self.pos = 0
+        self.left = False
+        self.fill = " "
+        self.hex = False
+        self.width = 0
+
+    def clear(self): # as dasm_str::clear_str, str("") and std::right
+        self.buf = []
+        self.pos = 0
+        self.left = False
+
+    def str(self):
+        return "".join(self.buf)
+
+    def _put(self, s):
+        pad = self.width - len(s)
+        self.width = 0
+        if pad > 0:
+            s = (s + self.fill * pad) if self.left else (self.fill * pad + s)
+        self.buf.append(s)
+        self.pos += len(s)
+        return self
+
+    def s(self, s):
+        return self._put(s)
+
+    def i(self, v):
+        """Integer, v in the range of its C++ type"""
+        return self._put(format(v & M32, "x") if self.hex else str(v))
+
+    def setw(self, w):
+        self.width = w
+        return self
+
+    def setfill(self, c):
+        self.fill = c
+        return self
+
+    def set_left(self, left):
+        self.left = left
+        return self
+
+    def set_hex(self, h):
+        self.hex = h
+        return self
+
+    # format macros in src/defines.h
+    def fhexz(self, v, w):
+        return self.s("0x").setw(w).setfill("0").set_hex(True).i(v) \
+                   .set_hex(False)
+
+    def fhexn(self, v, w):
+        return self.s("0x").set_left(True).setw(w).setfill(" ") \
+                   .set_hex(True).i(v).set_hex(False)
+
+    def mem_addr(self, a):
+        return self.setw(8).setfill("0").set_hex(True).i(a & M32) \
+                   .set_hex(False)
+
+    def frf(self, name, rfw, v):
+        return self.set_left(True).setw(rfw).setfill(" ").s(name) \
+                   .s(": 0x").set_left(False).setw(8).setfill("0") \
+                   .set_hex(True).i(v).set_hex(False)
+
+    def csrf(self, addr, name, csrw, v):
+        return self.set_hex(True).s("0x").setw(4).setfill("0").i(addr) \
+                   .s(" ").set_left(True).setw(csrw).setfill(" ").s(name) \
+                   .s(": 0x").set_left(False).setw(8).setfill("0").i(v) \
+                   .set_hex(False).setfill(" ")
+
+def fhexz_str(v, w):
+    return "0x" + format(v & M32, "x").rjust(w, "0")
+
+def lanes_str(vals):
+    return "[ " + "".join(f"{v} " for v in vals)
+
+class renderer:
+    def __init__(self, meta, rf_names=None, hw=False):
+        self.csrs = {int(a): n for a, n in meta["csrs"].items()}
+        self.csrw = max(len(n) for n in self.csrs.values())
+        self.uart = (meta["uart_tx"], meta["uart_rx"])
+        names = rf_names or meta.get("rf_names", "x")
+        self.rfi = 1 if names == "abi" else 0
+        self.rfw = 4 if names == "abi" else 3
+        self.hw = hw and meta.get("hw_models", False)
+        self.asm = ostream() # dasm.asm_ss
+
+    def rn(self, r):
+        return RF_NAMES[r][self.rfi]
+
+    def line(self, cnt, cnt_en, pc, inst, pre, post, aux, hm):
+        """One 'exec.log' line, pre and post are the rf around the inst"""
+        self.pre, self.post = pre, post
+        self.inst_w = 4 if (inst & 0x3) != 0x3 else 8
+        self.simd = ""
+        o = self.asm
+        o.clear()
+        if (inst & 0x3) != 0x3:
+            self.compressed(inst, pc)
+        else:
+            self.full(inst, pc, aux)
+        self.align()
+        out = (INDENT + (str(cnt + 1) if cnt_en else "").rjust(6) + ": " +
+               format(pc, "08x") + ": " + format(inst, f"0{self.inst_w}x") +
+               " " + o.str() + self.simd)
+        if self.hw:
+            out += self.hw_str(hm)
+        return out + "\n"
+
+    def hw_str(self, hm):
+        out = ""
+        for name, sh in (("icache", 0), ("dcache", 2), ("bpred", 4)):
+            st = HM_NAMES[(hm >> sh) & 0x3]
+            if st:
+                out += f"HW - {name}: {st}; "
+        return out
+
+    # asm building blocks, as the DASM_* macros
+    def align(self):
+        self.asm.setw(38 - self.inst_w - self.asm.pos).setfill(" ").s("  ")
+
+    def rd_update(self, rd):
+        if rd:
+            self.align()
+            self.asm.frf(self.rn(rd), self.rfw, self.post[rd])
+
+    def rd_update_pair(self, rd):
+        if rd:
+            self.asm.s(", ")
+            self.rd_update(rd + 1)
+
+    def mem_update(self, addr, rs):
+        o = self.asm
+        val = self.post[rs]
+        self.align()
+        o.s("mem[").mem_addr(addr).s("] <- ").s(self.rn(rs)).s(" (") \
+            .fhexz(val, 8).s(")")
+        if (addr & M32) in self.uart:
+            if 0x20 <= val <= 0x7e:
+                o.s(f" # '{chr(val)}'")
+            elif val in (0x0a, 0x0d, 0x09):
+                o.s(" # '\\" + {0x0a: "n", 0x0d: "r", 0x09: "t"}[val] + "'")
+
+    def op_rd(self, op, rd):
+        self.asm.s(op).s(" ").s(self.rn(rd))
+
+    def full(self, inst, pc, aux):
+        o = self.asm
+        opc = inst & 0x7f
+        rd, f3 = bits(inst, 11, 7), bits(inst, 14, 12)
+        rs1, rs2, f7 = bits(inst, 19, 15), bits(inst, 24, 20), bits(inst, 31, 25)
+        imm_i = sext(inst >> 20, 12)
+        if opc == 0b0110011: # alu_reg
+            if f7 == 0x01:
+                op = ALU_MUL[f3]
+            elif f7 == 0x05:
+                op = ALU_ZBB[f3]
+            else:
+                op = ALU_REG[(bits(inst, 30, 30) << 3) | f3]
+            self.op_rd(op, rd)
+            o.s(",").s(self.rn(rs1)).s(",").s(self.rn(rs2))
+            self.rd_update(rd)
+        elif opc == 0b0010011: # alu_imm
+            shift = (f3 & 0x3) == 1
+            sel = ((bits(inst, 30, 30) << 3) | f3) if shift else f3
+            self.op_rd(ALU_IMM[sel], rd)
+            o.s(",").s(self.rn(rs1)).s(",")
+            if shift:
+                o.fhexn(rs2, 2)
+            else:
+                o.i(imm_i)
+            self.rd_update(rd)
+            if inst == I_NOP:
+                o.clear()
+                o.s("nop")
+        elif opc == 0b0000011: # load
+            self.op_rd(LOAD[f3], rd)
+            o.s(",").i(imm_i).s("(").s(self.rn(rs1)).s(")")
+            self.rd_update(rd)
+            if rd:
+                o.s(" <- mem[").mem_addr(imm_i + self.pre[rs1]).s("]")
+        elif opc == 0b0100011: # store
+            imm_s = sext((bits(inst, 31, 25) << 5) | rd, 12)
+            o.s(STORE[f3]).s(" ").s(self.rn(rs2)).s(",").i(imm_s).s("(") \
+                .s(self.rn(rs1)).s(")")
+            self.mem_update(self.post[rs1] + imm_s, rs2)
+        elif opc == 0b1100011: # branch
+            imm_b = sext((bits(inst, 31, 31) << 12) | (bits(inst, 7, 7) << 11)
+                         | (bits(inst, 30, 25) << 5) | (bits(inst, 11, 8) << 1),
+                         13)
+            o.s(BRANCH[f3]).s(" ").s(self.rn(rs1)).s(",").s(self.rn(rs2)) \
+                .s(",").set_hex(True).i((pc + imm_b) & M32).set_hex(False)
+        elif opc == 0b1100111: # jalr
+            self.op_rd("jalr", rd)
+            o.s(",").i(imm_i).s("(").s(self.rn(rs1)).s(")")
+            if inst in I_RET:
+                o.s(" # ret")
+            self.rd_update(rd)
+        elif opc == 0b1101111: # jal
+            imm_j = sext((bits(inst, 31, 31) << 20) | (bits(inst, 19, 12) << 12)
+                         | (bits(inst, 20, 20) << 11)
+                         | (bits(inst, 30, 21) << 1), 21)
+            self.op_rd("jal", rd)
+            o.s(",").set_hex(True).i((pc + imm_j) & M32).set_hex(False)
+            self.rd_update(rd)
+        elif opc in (0b0110111, 0b0010111): # lui, auipc
+            self.op_rd("lui" if opc == 0b0110111 else "auipc", rd)
+            o.s(", ").fhexn(inst >> 12, 5)
+            self.rd_update(rd)
+        elif opc == 0b1110011: # system
+            if f3:
+                self.csr(inst, rd, f3, rs1, aux)
+            else:
+                o.s({I_MRET: "mret", I_WFI: "wfi"}[inst])
+        elif opc == 0b0001111: # misc_mem
+            o.s("fence.i" if inst == I_FENCE_I else "fence")
+        elif opc == 0b0001011: # custom simd
+            self.custom(inst, rd, f3, rs1, rs2, f7)
+
+    def csr(self, inst, rd, f3, rs1, aux):
+        o = self.asm
+        addr = inst >> 20
+        imm_type = f3 & 0x4
+        self.op_rd(CSR_OP[f3], rd)
+        o.s(",").s(self.csrs[addr]).s(",")
+        if imm_type:
+            o.i(rs1)
+        else:
+            o.s(self.rn(rs1))
+        self.rd_update(rd)
+        if rs1 or imm_type:
+            if rd:
+                o.s("; ")
+            self.align()
+            o.csrf(addr, self.csrs[addr], self.csrw, aux)
+
+    def compressed(self, inst, pc):
+        o = self.asm
+        op2, f3 = inst & 0x3, bits(inst, 15, 13)
+        rd, c_rs2 = bits(inst, 11, 7), bits(inst, 6, 2)
+        regh, regl = 0x8 | bits(inst, 9, 7), 0x8 | bits(inst, 4, 2)
+        imm_arith = sext((bits(inst, 12, 12) << 5) | bits(inst, 6, 2), 6)
+        imm_mem = ((bits(inst, 5, 5) << 6) | (bits(inst, 12, 10) << 3)
+                   | (bits(inst, 6, 6) << 2))
+        if op2 == 0x0:
+            if f3 == 0x0:
+                imm = ((bits(inst, 10, 7) << 6) | (bits(inst, 12, 11) << 4)
+                       | (bits(inst, 5, 5) << 3) | (bits(inst, 6, 6) << 2))
+                o.s("c.addi4spn ").s(self.rn(regl)).s(",x2,").i(imm)
+                self.rd_update(regl)
+            elif f3 == 0x2:
+                o.s("c.lw ").s(self.rn(regl)).s(",").i(imm_mem).s("(") \
+                    .s(self.rn(regh)).s(")")
+                self.rd_update(regl)
+                if rd:
+                    o.s(" <- mem[").mem_addr(imm_mem + self.pre[regh]).s("]")
+            else: # c.sw
+                o.s("c.sw ").s(self.rn(regl)).s(",").i(imm_mem).s("(") \
+                    .s(self.rn(regh)).s(")")
+                self.mem_update(imm_mem + self.post[regh], regl)
+        elif op2 == 0x1:
+            if f3 in (0x0, 0x2):
+                self.op_rd("c.addi" if f3 == 0x0 else "c.li", rd)
+                o.s(",").i(imm_arith)
+                self.rd_update(rd)
+            elif f3 in (0x1, 0x5):
+                imm_j = sext((bits(inst, 12, 12) << 11)
+                             | (bits(inst, 8, 8) << 10)
+                             | (bits(inst, 10, 9) << 8)
+                             | (bits(inst, 6, 6) << 7) | (bits(inst, 7, 7) << 6)
+                             | (bits(inst, 2, 2) << 5)
+                             | (bits(inst, 11, 11) << 4)
+                             | (bits(inst, 5, 3) << 1), 12)
+                o.s("c.jal " if f3 == 0x1 else "c.j ").set_hex(True) \
+                    .i((pc + imm_j) & M32).set_hex(False)
+                if f3 == 0x1:
+                    self.rd_update(1)
+            elif f3 == 0x3:
+                if rd == 0x0:
+                    o.s("c.nop")
+                elif rd == 0x2:
+                    imm = sext((bits(inst, 12, 12) << 9)
+                               | (bits(inst, 4, 3) << 7)
+                               | (bits(inst, 5, 5) << 6)
+                               | (bits(inst, 2, 2) << 5)
+                               | (bits(inst, 6, 6) << 4), 10)
+                    self.op_rd("c.addi16sp", rd)
+                    o.s(",").i(imm)
+                    self.rd_update(2)
+                else:
+                    self.op_rd("c.lui", rd)
+                    o.s(",").fhexn((imm_arith << 12 & M32) >> 12, 5)
+                    self.rd_update(rd)
+            elif f3 == 0x4:
+                f2h = bits(inst, 11, 10)
+                if f2h == 0x3:
+                    op = {0x8c: "c.sub", 0x8d: "c.xor", 0x8e: "c.or",
+                          0x8f: "c.and"}[(bits(inst, 15, 10) << 2)
+                                         | bits(inst, 6, 5)]
+                    o.s(op).s(" ").s(self.rn(regh)).s(",").s(self.rn(regl))
+                else:
+                    op = ["c.srli", "c.srai", "c.andi"][f2h]
+                    o.s(op).s(" ").s(self.rn(regh)).s(",").i(imm_arith)
+                self.rd_update(regh)
+            else: # c.beqz, c.bnez
+                imm_b = sext((bits(inst, 12, 12) << 8)
+                             | (bits(inst, 6, 5) << 6)
+                             | (bits(inst, 2, 2) << 5)
+                             | (bits(inst, 11, 10) << 3)
+                             | (bits(inst, 4, 3) << 1), 9)
+                o.s("c.beqz " if f3 == 0x6 else "c.bnez ").s(self.rn(regh)) \
+                    .s(",").set_hex(True).i((pc + imm_b) & M32).set_hex(False)
+        else:
+            if f3 == 0x0:
+                imm = (bits(inst, 12, 12) << 5) | bits(inst, 6, 2)
+                self.op_rd("c.slli", rd)
+                o.s(",").fhexn(imm, 2)
+                self.rd_update(rd)
+            elif f3 == 0x2:
+                imm = ((bits(inst, 3, 2) << 6) | (bits(inst, 12, 12) << 5)
+                       | (bits(inst, 6, 4) << 2))
+                self.op_rd("c.lwsp", rd)
+                o.s(",").i(imm).s("(").s(self.rn(2)).s(")")
+                self.rd_update(rd)
+                if rd:
+                    o.s(" <- mem[").mem_addr(imm + self.post[2]).s("]")
+            elif f3 == 0x6:
+                imm = (bits(inst, 8, 7) << 6) | (bits(inst, 12, 9) << 2)
+                o.s("c.swsp ").s(self.rn(c_rs2)).s(",").i(imm).s("(") \
+                    .s(self.rn(2)).s(")")
+                self.mem_update(imm + self.post[2], c_rs2)
+            elif bits(inst, 15, 12) == 0x8:
+                if c_rs2 == 0:
+                    self.op_rd("c.jr", rd)
+                    if inst == I_C_RET:
+                        o.s(" # ret")
+                else:
+                    self.op_rd("c.mv", rd)
+                    o.s(",").s(self.rn(c_rs2))
+                    self.rd_update(rd)
+            else:
+                if c_rs2 == 0 and rd == 0:
+                    o.s("c.ebreak")
+                elif c_rs2 == 0:
+                    self.op_rd("c.jalr", rd)
+                    self.rd_update(1)
+                else:
+                    self.op_rd("c.add", rd)
+                    o.s(",").s(self.rn(c_rs2))
+                    self.rd_update(rd)
+
+    def custom(self, inst, rd, f3, rs1, rs2, f7):
+        o = self.asm
+        op, p = SIMD[f7][f3]
+        a, b = self.pre[rs1] & M32, self.pre[rs2] & M32
+        self.op_rd(op, rd)
+        o.s(",").s(self.rn(rs1))
+        if f7 in (0x00, 0x01, 0x02, 0x04, 0x08, 0x22, 0x23):
+            o.s(",").s(self.rn(rs2))
+            self.rd_update(rd)
+        elif f7 == 0x09:
+            o.s(",").fhexn(rs2, 2)
+            self.rd_update(rd)
+        elif f7 in (0x03, 0x30):
+            o.s(",").s(self.rn(rs2))
+            self.rd_update(rd)
+            self.rd_update_pair(rd)
+        elif f7 == 0x20:
+            o.s(",").fhexn(rs2, 2)
+            self.rd_update(rd)
+            self.rd_update_pair(rd)
+        elif f7 in (0x3c, 0x3d):
+            if f7 == 0x3d or (f3 & 0x1):
+                o.s(",").fhexn(rs2 & [0x1, 0x3, 0x7, 0xf][f3 >> 1], 1)
+            self.rd_update(rd)
+        else:
+            self.rd_update(rd)
+            return
+        if not rd: # lanes are shown only when rd is written
+            return
+        self.simd = getattr(self, f"simd_{f7:02x}")(
+            a, b, self.pre[rd] & M32, rs2, f3, *p)
+
+    # simd lanes, as the kernels in src/core_exec_custom_simd_*.cpp
+    @staticmethod
+    def cab(c, a, b):
+        return f"RD = {c}], RS1 = {a}], RS2 = {b}]; "
+
+    def simd_00(self, a, b, _c, _rs2, _f3, vbits, sg, op, sat):
+        e = 32 // vbits
+        lo = -(1 << (vbits - 1)) if sg else 0
+        hi = ((1 << (vbits - 1)) - 1) if sg else ((1 << vbits) - 1)
+        cs, as_, bs = [], [], []
+        for i in range(e):
+            va = extract_val(a >> (i * vbits), vbits, sg)
+            vb = extract_val(b >> (i * vbits), vbits, sg)
+            r = (va + vb) if op == "add" else (va - vb)
+            if sat:
+                r = min(max(r, lo), hi)
+            cs.append(r)
+            as_.append(va)
+            bs.append(vb)
+        return self.cab(lanes_str(cs), lanes_str(as_), lanes_str(bs))
+
+    simd_01 = simd_00
+
+    def simd_02(self, a, b, _c, _rs2, _f3, vbits, sg, upper):
+        mask = (1 << vbits) - 1
+        cs, as_, bs = [], [], []
+        for i in range(32 // vbits):
+            va = extract_val(a >> (i * vbits), vbits, sg)
+            vb = extract_val(b >> (i * vbits), vbits, sg)
+            prod = (va * vb) & M32
+            cs.append(((prod >> vbits) if upper else prod) & mask)
+            as_.append(va)
+            bs.append(vb)
+        return self.cab(lanes_str(cs), lanes_str(as_), lanes_str(bs))
+
+    def simd_03(self, a, b, _c, _rs2, _f3, vbits, sg):
+        e = 32 // vbits
+        res, as_, bs = [], [], []
+        for i in range(e):
+            va = extract_val(a >> (i * vbits), vbits, sg)
+            vb = extract_val(b >> (i * vbits), vbits, sg)
+            res.append(s32(va * vb))
+            as_.append(va)
+            bs.append(vb)
+        return self.cab(self.wide_str(res), lanes_str(as_), lanes_str(bs))
+
+    @staticmethod
+    def wide_str(vals):
+        half = len(vals) // 2
+        return "[ " + "".join(
+            f"{v}" + (" ], [ " if i == half - 1 else " ")
+            for i, v in enumerate(vals))
+
+    def simd_04(self, a, b, c, _rs2, _f3, vbits, sg):
+        res = 0
+        as_, bs = [], []
+        for i in range(32 // vbits):
+            va = extract_val(a >> (i * vbits), vbits, sg)
+            vb = extract_val(b >> (i * vbits), vbits, sg)
+            as_.append(va)
+            bs.append(vb)
+            res = s32(res + va * vb)
+        res = s32(res + c)
+        return (f"RD = {res}, RS1 = {lanes_str(as_)}], "
+                f"RS2 = {lanes_str(bs)}], RS3 = {s32(c)}; ")
+
+    def simd_08(self, a, b, _c, _rs2, _f3, vbits, sg, fn):
+        cs, as_, bs = [], [], []
+        for i in range(32 // vbits):
+            va = extract_val(a >> (i * vbits), vbits, sg)
+            vb = extract_val(b >> (i * vbits), vbits, sg)
+            cs.append(fn(va, vb))
+            as_.append(va)
+            bs.append(vb)
+        return self.cab(lanes_str(cs), lanes_str(as_), lanes_str(bs))
+
+    def simd_09(self, a, _b, _c, rs2, _f3, vbits, arith, op):
+        mask = (1 << vbits) - 1
+        shamt = rs2 & (vbits - 1)
+        w = vbits >> 2
+        cs, as_ = "[ ", "[ "
+        for i in range(32 // vbits):
+            va = extract_val(a >> (i * vbits), vbits, arith)
+            r = s32(va << shamt) if op == "l" else (va >> shamt)
+            cs += fhexz_str(r & mask, w) + " "
+            as_ += fhexz_str(va, w) + " "
+        return f"RD = {cs}], RS1 = {as_}], SHAMT = {shamt}; "
+
+    def simd_20(self, a, _b, _c, rs2, _f3, vbits, sg):
+        shamt = rs2 & (2 * vbits - 1)
+        vals = [extract_val(a >> (i * vbits), vbits, sg)
+                for i in range(32 // vbits)]
+        res = [s32(v << shamt) for v in vals]
+        return (f"RD = {self.wide_str(res)}], RS1 = {lanes_str(vals)}], "
+                f"SHAMT = {shamt}; ")
+
+    def simd_22(self, a, b, _c, _rs2, _f3, vbits, sat, sg):
+        out_bits = vbits // 2
+        out_mask = (1 << out_bits) - 1
+        lo = -(1 << (out_bits - 1)) if sg else 0
+        hi = ((1 << (out_bits - 1)) - 1) if sg else ((1 << out_bits) - 1)
+        e = 32 // vbits
+        outs = []
+        for v in (a, b):
+            for i in range(e):
+                raw = extract_val(v >> (i * vbits), vbits, sg)
+                if sat:
+                    raw = min(max(raw, lo), hi)
+                m = raw & out_mask
+                outs.append(sext(m, out_bits) if (sg and sat) else m)
+        as_ = [extract_val(a >> (i * vbits), vbits, sg) for i in range(e)]
+        bs = [extract_val(b >> (i * vbits), vbits, sg) for i in range(e)]
+        return self.cab(lanes_str(outs), lanes_str(as_), lanes_str(bs))
+
+    simd_23 = simd_22
+
+    def simd_30(self, a, b, _c, _rs2, _f3, vbits):
+        mask = (1 << vbits) - 1
+        lane = lambda v, i: (v >> (i * vbits)) & mask
+        half = 32 // vbits // 2
+        as_, bs, cs = [], [], []
+        for j in range(half):
+            as_ += [lane(a, 2 * j), lane(a, 2 * j + 1)]
+            bs += [lane(b, 2 * j), lane(b, 2 * j + 1)]
+        cs = "[ " + "".join(f"{lane(a, 2 * j)} {lane(b, 2 * j)} "
+                            for j in range(half))
+        cs += "], [ " + "".join(f"{lane(a, 2 * j + 1)} {lane(b, 2 * j + 1)} "
+                                for j in range(half))
+        return self.cab(cs, lanes_str(as_), lanes_str(bs))
+
+    def simd_3c(self, a, _b, c, rs2, f3, vbits):
+        e = 32 // vbits
+        mask = (1 << vbits) - 1
+        if not (f3 & 0x1): # dup
+            sc = extract_val(a, vbits, True)
+            return f"RD = {lanes_str([sc] * e)}], RS1 = {sc}; "
+        idx = rs2 & (e - 1)
+        res = (c & ~(mask << (idx * vbits)) & M32) | ((a & mask) << (idx * vbits))
+        cs = [extract_val(res >> (i * vbits), vbits, True) for i in range(e)]
+        return (f"RD = {lanes_str(cs)}], RS1 = {extract_val(a, vbits, True)}"
+                f", IDX = {idx}; ")
+
+    def simd_3d(self, a, _b, _c, rs2, _f3, vbits, sg):
+        e = 32 // vbits
+        idx = rs2 & (e - 1)
+        res = extract_val(a >> (idx * vbits), vbits, sg)
+        as_ = [extract_val(a >> (i * vbits), vbits, True) for i in range(e)]
+        return f"RD = {res}, RS1 = {lanes_str(as_)}], IDX = {idx}; "
+
+class col_reader:
+    """Sequential reads from the columns of one chunk"""
+    def __init__(self, cols):
+        self.b = [c.tobytes() for c in cols]
+        self.p = [0] * len(cols)
+
+    def u8(self, c):
+        v = self.b[c][self.p[c]]
+        self.p[c] += 1
+        return v
+
+    def u32(self, c):
+        p = self.p[c]
+        self.p[c] = p + 4
+        return int.from_bytes(self.b[c][p:p + 4], "little")
+
+    def varint(self, c):
+        v, sh = 0, 0
+        while True:
+            x = self.u8(c)
+            v |= (x & 0x7f) << sh
+            sh += 7
+            if x < 0x80:
+                return v
+
+    def text(self):
+        n = self.varint(C_TEXT)
+        p = self.p[C_TEXT]
+        self.p[C_TEXT] = p + n
+        return self.b[C_TEXT][p:p + n].decode("latin-1")
+
+def entries(tf, chunk):
+    """Decoded entries of one chunk: (type, cnt, fields)"""
+    n, cols = tf.read_chunk(chunk)
+    r = col_reader(cols)
+    cnt, pc = 0, 0
+    rf = None
+    for _ in range(n):
+        t = r.u8(C_TYPE)
+        cnt += r.varint(C_CNT)
+        if t & FLAG_RF:
+            rf = [0] + [r.u32(C_RF) for _ in range(31)]
+        if (t & TYPE_MASK) != T_INST:
+            yield (t & TYPE_MASK), cnt, (r.text(), rf)
+            continue
+        z = r.varint(C_PC)
+        pc = (pc + ((z >> 1) ^ -(z & 1))) & M32
+        inst = r.u32(C_INST)
+        rd = r.u8(C_RD)
+        rd_val = r.u32(C_RD_VAL) if rd else 0
+        rdp = r.u8(C_RDP)
+        rdp_val = r.u32(C_RDP_VAL) if rdp else 0
+        aux = r.u32(C_AUX) if t & FLAG_AUX else 0
+        hm = r.u8(C_HM)
+        yield T_INST, cnt, (bool(t & FLAG_CNT), pc, inst, rf,
+                            (rd, rd_val, rdp, rdp_val), aux, hm)
+
+def render(path, out, begin=None, end=None, rf_names=None, hw=False):
+    tf = open_trace(path, "exec_log")
+    if not tf.index:
+        tf.close()
+        return
+    # first entry of the file is the metadata
+    kind, _, (meta, _) = next(entries(tf, tf.index[0]))
+    if kind != T_META:
+        raise ValueError(f"'{path}': metadata entry missing")
+    rnd = renderer(json.loads(meta), rf_names, hw)
+    # keys are 0-based inst counts, the range is in logged inst numbers
+    k_begin = None if begin is None else begin - 1
+    k_end = None if end is None else end - 1
+    for ch in tf.chunks(k_begin, k_end):
+        for kind, cnt, f in entries(tf, ch):
+            show = ((k_begin is None or cnt >= k_begin) and
+                    (k_end is None or cnt <= k_end))
+            if kind == T_META:
+                continue
+            if kind == T_TEXT:
+                if show:
+                    out.write(f[0] + "\n")
+                continue
+            cnt_en, pc, inst, rf, (rd, rd_val, rdp, rdp_val), aux, hm = f
+            post = list(rf)
+            if rd:
+                post[rd] = rd_val
+            if rdp:
+                post[rdp] = rdp_val
+            if show:
+                pre = [s32(v) for v in rf]
+                post_s = [s32(v) for v in post]
+                out.write(
+                    rnd.line(cnt, cnt_en, pc, inst, pre, post_s, aux, hm))
+            rf[:] = post # the same list carries on through the chunk
+    tf.close()
+
+def main():
+    parser = argparse.ArgumentParser(description="Render the binary execution log 'exec.bin' as the 'exec.log' text")
+    parser.add_argument('log', help="Input 'exec.bin'")
+    parser.add_argument('-o', '--output', default=None, help="Output file, stdout by default")
+    parser.add_argument('--begin', type=int, default=None, help="First instruction to render, as numbered in the log")
+    parser.add_argument('--end', type=int, default=None, help="Last instruction to render, as numbered in the log")
+    parser.add_argument('--rf_names', choices=['x', 'abi'], default=None, help="Register file names, as used by the simulator run by default")
+    parser.add_argument('--hw', action='store_true', help="Append HW model hit/miss for each instruction, if recorded")
+    args = parser.parse_args()
+
+    out = open(args.output, "w") if args.output else sys.stdout
+    try:
+        render(args.log, out, args.begin, args.end, args.rf_names, args.hw)
+    except BrokenPipeError:
+        pass
+    finally:
+        if args.output:
+            out.close()
+
+if __name__ == "__main__":
+    main()
@@ -209,23 +209,15 @@ def run_workloads(wp: workload_params):
     if wp.tag:
         tag_arg = ["--out_dir_tag", wp.tag]
 
-    bp_sweep = (wp.sweep == "bpred")
-    cache_sweep = (wp.sweep == "icache" or wp.sweep == "dcache")
-    if not bp_sweep and not cache_sweep:
+    if wp.sweep != "bpred":
         raise ValueError("Unknown sweep type")
 
-    if bp_sweep:
-        bp_agg = {"acc": [], "mpki": []} # aggregate across all workloads
-        bp_per_app = {
-            "acc": {}, "mpki": {}, "prof_inst": {}, "prof_branches": {}
-        }
-        bp_size = None
-        violated_thr = False
-    elif cache_sweep:
-        agg_hr = [] # aggregate hit rate across all workloads
-        per_app_hr = {}
-        cache_size = None
-        cache_ct = []
+    bp_agg = {"acc": [], "mpki": []} # aggregate across all workloads
+    bp_per_app = {
+        "acc": {}, "mpki": {}, "prof_inst": {}, "prof_branches": {}
+    }
+    bp_size = None
+    violated_thr = False
 
     msg_out = f"{wp.msg}\n"
     start_dir = os.getcwd()
@@ -266,78 +258,81 @@ def run_workloads(wp: workload_params):
             # if not, remove the entire dir, nothing to keep
             subprocess.run(["rm", "-r", out_dir])
 
-        if bp_sweep:
-            prof_branches = hw_stats[wp.sweep]["branches"]
-            if prof_branches == 0:
-                raise RuntimeError(f"No branches logged for {app}")
-            if bp_size is None: # bp, and therefore size, is constant
-                bp_size = hw_stats[wp.sweep]["size"]
-
-            # per app threshold, if any
-            app_thr_acc = workload["thr"].get("thr_bpred_acc", 0)
-            app_thr_mpki = workload["thr"].get("thr_bpred_mpki", 1000)
-
-            acc = hw_stats[wp.sweep]["accuracy"]
-            mpki = hw_stats[wp.sweep]["mpki"]
-            if acc < app_thr_acc or mpki > app_thr_mpki:
-                violated_thr = True
-                if not wp.ignore_thr:
-                    # skip rest of workloads if acc/mpki is violated on any
-                    bp_agg = {k: [] for k in bp_agg.keys()}
-                    if has_branches_csv:
-                        # and remove entire dir, nothing to keep
-                        subprocess.run(["rm", "-r", out_dir])
-                    break
-
-            bp_agg['acc'].append(acc)
-            bp_agg['mpki'].append(mpki)
-            testname = get_test_name(app)
-            bp_per_app['acc'][testname] = acc
-            bp_per_app['mpki'][testname] = mpki
-            bp_per_app['prof_inst'][testname] = prof_inst
-            bp_per_app['prof_branches'][testname] = prof_branches
-
-        elif cache_sweep:
-            if cache_size is None: # populate on first workload
-                cache_size = hw_stats[wp.sweep]["size"]["data"]
-            app_thr_hr = 0
-            if "thr" in workload:
-                app_thr_hr = workload["thr"][f"thr_{wp.sweep}_hr"]
-            hits_d = hw_stats[wp.sweep]["hits"]
-            hits = hits_d['reads'] + hits_d['writes']
-            references = hw_stats[wp.sweep]["references"]
-            if references == 0:
-                raise RuntimeError(f"No cache references logged for {app}")
-            hr = round(hits/references*100, 2)
-            if hr < app_thr_hr and not wp.ignore_thr:
-                agg_hr = []
+        prof_branches = hw_stats[wp.sweep]["branches"]
+        if prof_branches == 0:
+            raise RuntimeError(f"No branches logged for {app}")
+        if bp_size is None: # bp, and therefore size, is constant
+            bp_size = hw_stats[wp.sweep]["size"]
+
+        # per app threshold, if any
+        app_thr_acc = workload["thr"].get("thr_bpred_acc", 0)
+        app_thr_mpki = workload["thr"].get("thr_bpred_mpki", 1000)
+
+        acc = hw_stats[wp.sweep]["accuracy"]
+        mpki = hw_stats[wp.sweep]["mpki"]
+        if acc < app_thr_acc or mpki > app_thr_mpki:
+            violated_thr = True
+            if not wp.ignore_thr:
+                # skip rest of workloads if acc/mpki is violated on any
+                bp_agg = {k: [] for k in bp_agg.keys()}
                 if has_branches_csv:
                     # and remove entire dir, nothing to keep
                     subprocess.run(["rm", "-r", out_dir])
                 break
-            agg_hr.append(hr)
-            per_app_hr[get_test_name(app)] = hr
-            if len(wp.workloads) == 1:
-                cache_ct.append(hw_stats[wp.sweep]["ct_core"]["reads"])
-                cache_ct.append(hw_stats[wp.sweep]["ct_core"]["writes"])
-                cache_ct.append(hw_stats[wp.sweep]["ct_mem"]["reads"])
-                cache_ct.append(hw_stats[wp.sweep]["ct_mem"]["writes"])
+
+        bp_agg['acc'].append(acc)
+        bp_agg['mpki'].append(mpki)
+        testname = get_test_name(app)
+        bp_per_app['acc'][testname] = acc
+        bp_per_app['mpki'][testname] = mpki
+        bp_per_app['prof_inst'][testname] = prof_inst
+        bp_per_app['prof_branches'][testname] = prof_branches
 
     os.chdir(start_dir)
-    if bp_sweep:
-        bp_avg = {"acc": None, "mpki": None}
-        if len(bp_agg['acc']) > 0:
-            bp_avg['acc'] = round(sum(bp_agg['acc'])/len(bp_agg['acc']), 2)
-            bp_avg['mpki'] = round(sum(bp_agg['mpki'])/len(bp_agg['mpki']), 2)
-        return bp_size, bp_avg, bp_per_app, wp.ret_list, violated_thr, msg_out
-
-    elif cache_sweep:
-        avg_hr = None
-        if len(agg_hr) > 0:
-            avg_hr = round(sum(agg_hr)/len(agg_hr), 2)
-        prof_info = (prof_inst, references)
-        return cache_size, avg_hr, per_app_hr, cache_ct, prof_info, \
-            wp.ret_list, msg_out
+    bp_avg = {"acc": None, "mpki": None}
+    if len(bp_agg['acc']) > 0:
+        bp_avg['acc'] = round(sum(bp_agg['acc'])/len(bp_agg['acc']), 2)
+        bp_avg['mpki'] = round(sum(bp_agg['mpki'])/len(bp_agg['mpki']), 2)
+    return bp_size, bp_avg, bp_per_app, wp.ret_list, violated_thr, msg_out
+
+def run_cache_workload(
+    workload: Dict[str, Any],
+    ck: str,
+    cache_params: List[List[str]],
+    sim_args: List[str],
+    work_dir: str) -> Tuple[str, List[Dict], int, str]:
+    # all configs in a single run, simulator feeds each access to all of them
+    app = workload["app"]
+    specs = [] # sets:ways:re_policy
+    for cp in cache_params:
+        cpd = dict(zip(cp[0::2], cp[1::2]))
+        specs.append(":".join(
+            [cpd[f"--{ck}_sets"], cpd[f"--{ck}_ways"],
+             cpd[f"--{ck}_re_policy"]]))
+    tag = f"{ck}_sweep"
+    cmd = [SIM, app, f"--{ck}_sweep", ",".join(specs), "--out_dir_tag", tag]
+    cmd += sim_args + workload["args"]
+
+    start_dir = os.getcwd()
+    os.chdir(work_dir)
+    try:
+        res = run_sim(cmd)
+        out_dir = f"{get_test_name(app)}_out_{tag}"
+        json_hw_stats = os.path.join(out_dir, "hw_stats.json")
+        if not os.path.exists(json_hw_stats):
+            raise FileNotFoundError(f"hw_stats.json not found: {json_hw_stats}")
+        with open(json_hw_stats, "r") as f:
+            hw_stats = json.load(f)
+        subprocess.run(["rm", "-r", out_dir])
+    finally:
+        os.chdir(start_dir)
+
+    # sweep configs are logged in the order they were given
+    entries = [v for k, v in hw_stats.items() if k.startswith(f"{ck}_")]
+    if len(entries) != len(cache_params):
+        raise RuntimeError(f"Expected {len(cache_params)} {ck} configs in "
+                           f"hw_stats.json for {app}, got {len(entries)}")
+    return app, entries, hw_stats["profiled_inst"], res.stdout
 
 def run_cache_sweep(
     args: argparse.Namespace,
@@ -373,57 +368,76 @@ def run_cache_sweep(
 
     if not args.load_stats:
         idx_c = 1
-        PROG_BAT = 4 # progress batches
+        PROG_BAT = min(4, len(workloads)) # progress batches
         if args.track and not running_single_best:
             tt = track_time()
             print(f"{INDENT}"
                   f"Cache: {ck},\tconfigs: {len(cache_params):3},  progress: ",
                   end="")
-            idx_c = (len(cache_params) // PROG_BAT) + 1
+            idx_c = (len(workloads) // PROG_BAT)
 
+        # one run per workload, all configs simulated together
+        wl_res = {}
         with ProcessPoolExecutor(max_workers=args.max_workers) as executor:
-            futures = {
+            futures = [
                 executor.submit(
-                    run_workloads,
-                    workload_params(
-                        workloads=workloads,
-                        sweep=ck,
-                        sim_args=cp + bp_act,
-                        msg= f"==> SWEEP: {ck} {cp} <==",
-                        save_sim=args.save_sim,
-                        work_dir=args.work_dir,
-                        ignore_thr=False,
-                        tag="".join(cp[1::2]), # set (1), way (3), policy (5)
-                        ret_list=cp
-                    )
-                ): cp for cp in cache_params
-            }
+                    run_cache_workload,
+                    workload,
+                    ck,
+                    cache_params,
+                    bp_act,
+                    args.work_dir
+                ) for workload in workloads
+            ]
 
-            # get results as they come in
             cnt = 0
             for future in as_completed(futures):
-                size, hr, per_app_hr, ct, prof_info, cp, msg = future.result()
-
+                app, entries, prof_inst, stdout = future.result()
+                wl_res[app] = (entries, stdout)
                 cnt += 1
                 if args.track and cnt % idx_c == 0 and not running_single_best:
                     print(f"{cnt//idx_c}/{PROG_BAT}", end=", ", flush=True)
 
-                if hr == None:
-                    continue
-                with open(sweep_log_path, "a") as f:
-                    f.write(msg)
-                cpolicy, cset, cway = cp[5], int(cp[1]), int(cp[3])
-                if cpolicy not in sr:
-                    sr[cpolicy] = {}
-                if cset not in sr[cpolicy]:
-                    sr[cpolicy][cset] = {}
-                sr[cpolicy][cset][cway] = {
-                    "hr": hr, "size": size, "per_app_hr": per_app_hr}
-                if ct: # only for single workload sweeps
-                    sr[cpolicy][cset][cway]["ct_core"] = {
-                        "reads": ct[0], "writes": ct[1]}
-                    sr[cpolicy][cset][cway]["ct_mem"] = {
-                        "reads": ct[2], "writes": ct[3]}
+        if args.save_sim:
+            with open(sweep_log_path, "a") as f:
+                for workload in workloads:
+                    f.write(f"==> SWEEP: {ck} {workload['app']} <==\n")
+                    f.write(f"{wl_res[workload['app']][1]}\n\n")
+
+        for i, cp in enumerate(cache_params):
+            agg_hr = [] # aggregate hit rate across all workloads
+            per_app_hr = {}
+            for workload in workloads:
+                app = workload["app"]
+                stats = wl_res[app][0][i]
+                app_thr_hr = 0
+                if "thr" in workload:
+                    app_thr_hr = workload["thr"][f"thr_{ck}_hr"]
+                hits = stats["hits"]["reads"] + stats["hits"]["writes"]
+                references = stats["references"]
+                if references == 0:
+                    raise RuntimeError(f"No cache references logged for {app}")
+                hr = round(hits/references*100, 2)
+                if hr < app_thr_hr:
+                    agg_hr = []
+                    break
+                agg_hr.append(hr)
+                per_app_hr[get_test_name(app)] = hr
+
+            if len(agg_hr) == 0:
+                continue
+            hr = round(sum(agg_hr)/len(agg_hr), 2)
+            cpolicy, cset, cway = cp[5], int(cp[1]), int(cp[3])
+            if cpolicy not in sr:
+                sr[cpolicy] = {}
+            if cset not in sr[cpolicy]:
+                sr[cpolicy][cset] = {}
+            sr[cpolicy][cset][cway] = {
+                "hr": hr, "size": stats["size"]["data"],
+                "per_app_hr": per_app_hr}
+            if running_single:
+                sr[cpolicy][cset][cway]["ct_core"] = stats["ct_core"]
+                sr[cpolicy][cset][cway]["ct_mem"] = stats["ct_mem"]
 
         if args.track and not running_single_best:
             tt_now, tt_taken = tt()
@@ -437,9 +451,9 @@ def run_cache_sweep(
             sr[cpolicy] = dict(sorted(sr[cpolicy].items(), key=lambda x: x[0]))
 
         if running_single:
-            sr['_profiled_inst'] = prof_info[0]
+            sr['_profiled_inst'] = prof_inst
             if ck == "dcache":
-                sr['_profiled_inst_mem'] = prof_info[1]
+                sr['_profiled_inst_mem'] = references
 
     sweep_results_path = sweep_log_path.replace(".log", "_best.json")
     if args.load_stats:
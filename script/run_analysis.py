@@ -17,6 +17,7 @@ from matplotlib.ticker import (AutoMinorLocator, EngFormatter, FixedLocator,
                                LogFormatterSciNotation, MaxNLocator,
                                MultipleLocator)
 from matplotlib.widgets import RangeSlider
+from trace_stream import TRACE_CT_COLS, read_trace, trace_range
 from utils import (FMT_AXIS, get_test_title, is_notebook, print_file_saved,
                    reformat_json, smarter_eng_formatter)
 
@@ -1907,48 +1908,37 @@ def load_inst_prof(log, allow_internal=False) -> pd.DataFrame:
     return df
 
 def load_bin_trace(bin_log, args) -> pd.DataFrame:
-    dtype = np.dtype([
-        ('smp', np.uint64),
-        ('inst', np.uint32),
-        ('pc', np.uint32),
-        ('next_pc', np.uint32),
-        ('dmem', np.uint32),
-        ('sp', np.uint32),
-        ('b_taken', np.uint8),
-        ('isz', np.uint8),
-        ('dsz', np.uint8),
-        ('ic', np.uint8),
-        ('dc', np.uint8),
-        ('bp', np.uint8),
-    ])
+    # trace columns as named here, C++ trace_entry names are in trace_stream
+    names = {
+        'sample_cnt': 'smp', 'taken': 'b_taken', 'inst_size': 'isz',
+        'dmem_size': 'dsz', 'ic_hm': 'ic', 'dc_hm': 'dc', 'bp_hm': 'bp',
+    }
+    mem_stats = TRACE_CT_COLS
 
-    if args.clk:
-        dtype = np.dtype(dtype.descr + [
-            ('ct_imem_core', np.uint8),
-            ('ct_imem_mem', np.uint8),
-            ('ct_dmem_core_r', np.uint8),
-            ('ct_dmem_core_w', np.uint8),
-            ('ct_dmem_mem_r', np.uint8),
-            ('ct_dmem_mem_w', np.uint8),
-        ])
-        mem_stats = dtype.names[-6:]
-
-    # recreate padding as done in the C++ trace entry struct
-    el_max = np.max([dtype[item].itemsize for item in dtype.names])
-    dsize = dtype.itemsize
-    padding = ((((dsize + el_max) // el_max) * el_max) - dsize) % el_max
-    pad_str = "pad_byte_"
-    for p in range(padding):
-        dtype = np.dtype(dtype.descr + [(pad_str+str(p), 'u1')])
-
-    # load trace
-    data = np.fromfile(bin_log, dtype=dtype)
-    df = pd.DataFrame(data)
-    if len(df.index) == 0:
+    # smp is an absolute counter, not always profiling start
+    # range is resolved from the trace index, only chunks covering it load
+    smp_range = trace_range(bin_log)
+    if smp_range is None:
         raise ValueError("Empty ISA sim trace")
-    df = df.drop(columns=[c for c in df.columns if pad_str in c])
+    norm_off = (smp_range[0] - 1) if args.trace_norm else 0 # smp from 1
+    smp_lo, smp_hi = (s - norm_off for s in smp_range)
+    smp_off = smp_lo if args.sample_rel else 0
+    df_start = smp_off + int(args.sample_begin) if args.sample_begin else smp_lo
+    df_end = smp_off + int(args.sample_end) if args.sample_end else smp_hi
+    range_err = ValueError(
+        f"No trace samples in requested range [{df_start}, {df_end}]; "
+        f"trace covers smp [{smp_lo}, {smp_hi}]. "
+        f"--sample_begin/_end are absolute smp values; "
+        f"pass --sample_rel to treat them as relative to the trace start."
+    )
+    if (df_start > smp_hi) or (df_end < smp_lo):
+        raise range_err
+
+    # load trace, one sample before the range for the cpi of the first one
+    data = read_trace(bin_log, df_start + norm_off - 1, df_end + norm_off)
+    df = pd.DataFrame(data).rename(columns=names)
     if args.trace_norm:
-        df.smp = df.smp - df.smp.head(1).values[0] + 1 # normalize smp to 1
+        df.smp = df.smp - norm_off
 
     # enum class dmem_size_t {
     #     lb, lh, lw, ld,
@@ -1987,20 +1977,9 @@ def load_bin_trace(bin_log, args) -> pd.DataFrame:
     df.inst = df.inst.replace(0, np.nan) # replace NOP/bubbles with NaN
     df.pc = df.pc.replace(0, np.nan) # same as for inst
 
-    # smp is an absolute counter, not always profiling start
-    smp_lo, smp_hi = int(df.smp.min()), int(df.smp.max())
-    smp_off = smp_lo if args.sample_rel else 0
-    df_start = smp_off + int(args.sample_begin) if args.sample_begin else smp_lo
-    df_end = smp_off + int(args.sample_end) if args.sample_end else smp_hi
     df = df.loc[df['smp'].between(df_start, df_end)]
-
     if df.empty:
-        raise ValueError(
-            f"No trace samples in requested range [{df_start}, {df_end}]; "
-            f"trace covers smp [{smp_lo}, {smp_hi}]. "
-            f"--sample_begin/_end are absolute smp values; "
-            f"pass --sample_rel to treat them as relative to the trace start."
-        )
+        raise range_err
 
     return df
 
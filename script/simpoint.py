@@ -0,0 +1,331 @@
+#!/usr/bin/env python3
+
+# SimPoint flow on top of the ISA sim
+# 'cluster': basic block vectors (--bbv_interval) -> representative intervals
+#   random projection, k-means over a range of k, smallest k within the BIC
+#   threshold, interval closest to each centroid, weighted by cluster size
+# 'run': detailed simulation of the chosen intervals only
+#   checkpoint at (interval start - warmup) with --fast_forward, restore,
+#   warm up HW models, profile one interval (--prof_inst_start), then
+#   combine cache/bp/perf event stats with the interval weights
+
+import argparse
+import glob
+import json
+import os
+import sys
+
+import numpy as np
+from elftools.elf.elffile import ELFFile
+from hw_model_sweep import get_test_name
+from sim_run_utils import (default_isa_sim, output_tail, parse_inst_counts,
+                           run_cmd, run_died, run_status, write_json)
+from utils import INDENT, print_file_saved
+
+BIC_THRESHOLD = 0.9 # same as SimPoint 3.0
+
+def parse_args() -> argparse.Namespace:
+    p = argparse.ArgumentParser(description="SimPoint clustering of basic block vectors and weighted detailed simulation of the chosen intervals")
+    sp = p.add_subparsers(dest="cmd", required=True)
+
+    c = sp.add_parser("cluster", help="Pick representative intervals from 'bbv.bb'")
+    c.add_argument("bbv", help="Sim output dir with 'bbv.bb' and 'bbv_blocks.json', or path to 'bbv.bb'")
+    c.add_argument("-k", "--max_k", type=int, default=30, help="Max number of clusters")
+    c.add_argument("--dim", type=int, default=15, help="Random projection dimensions")
+    c.add_argument("--seed", type=int, default=493575226, help="Seed for projection and k-means init")
+    c.add_argument("--init", type=int, default=5, help="k-means runs with different seeds per k, best one kept")
+    c.add_argument("-o", "--out", default=None, help="Output JSON, defaults to 'simpoints.json' next to 'bbv.bb'. SimPoint-style 'simpoints' and 'weights' files are saved next to it")
+
+    r = sp.add_parser("run", help="Simulate the intervals from 'simpoints.json' and estimate whole-program stats")
+    r.add_argument("elf", help="Workload ELF, same as used for BBV collection")
+    r.add_argument("-s", "--simpoints", required=True, help="Output of 'cluster'")
+    r.add_argument("--isa_sim", default=default_isa_sim(), help="Path to the ISA sim binary, needs PROFILERS=1 HW_MODELS=1 (defaults to the build/ one)")
+    r.add_argument("-w", "--warmup", type=int, default=0, help="Instructions before each interval that only warm up the HW models")
+    r.add_argument("--sim_args", default="", help="Extra sim args for the detailed runs, e.g. cache/bp configuration or '-e bp_miss,l1d_miss'. Must not change the run (no run_insts/prof_pc_*)")
+    r.add_argument("--work_dir", default=os.getcwd(), help="Directory to run in and store checkpoints and sim outputs")
+    r.add_argument("--timeout", type=float, default=None, help="Per-run timeout in seconds")
+    r.add_argument("--json", dest="json_out", default=None, help="Write estimates JSON to this path, defaults to 'simpoint_est.json' in work_dir")
+    return p.parse_args()
+
+# cluster
+def read_bbv(path):
+    # 'T:<id>:<cnt> :<id>:<cnt> ...' per interval, ids are 1-based
+    rows = []
+    with open(path) as f:
+        for line in f:
+            line = line.strip()
+            if not line.startswith("T"):
+                continue
+            row = {}
+            for tok in line[1:].split():
+                _, bid, cnt = tok.split(":")
+                row[int(bid)] = row.get(int(bid), 0) + int(cnt)
+            rows.append(row)
+    if not rows:
+        raise ValueError(f"No intervals in '{path}'")
+    return rows
+
+def project(rows, dim, rng):
+    # normalized frequency vectors through a random [-1, 1) projection
+    n_blocks = max(max(r) for r in rows if r)
+    proj = rng.uniform(-1.0, 1.0, size=(n_blocks + 1, dim))
+    x = np.zeros((len(rows), dim))
+    insts = np.zeros(len(rows), dtype=np.int64)
+    for i, r in enumerate(rows):
+        ids = np.fromiter(r.keys(), dtype=np.int64)
+        cnt = np.fromiter(r.values(), dtype=np.float64)
+        insts[i] = int(cnt.sum())
+        x[i] = (cnt / cnt.sum()) @ proj[ids]
+    return x, insts
+
+def kmeans(x, k, rng, iters=100):
+    # k-means++ seeding, then Lloyd's
+    n = x.shape[0]
+    cent = [x[rng.integers(n)]]
+    for _ in range(1, k):
+        d2 = np.min(((x[:, None, :] - np.array(cent)[None]) ** 2).sum(-1), 1)
+        if d2.sum() == 0:
+            cent.append(x[rng.integers(n)])
+        else:
+            cent.append(x[rng.choice(n, p=d2 / d2.sum())])
+    cent = np.array(cent)
+    labels = np.zeros(n, dtype=np.int64)
+    for i in range(iters):
+        d2 = ((x[:, None, :] - cent[None]) ** 2).sum(-1)
+        new_labels = d2.argmin(1)
+        if (i > 0) and np.array_equal(new_labels, labels):
+            break
+        labels = new_labels
+        for c in range(k):
+            members = x[labels == c]
+            if len(members):
+                cent[c] = members.mean(0)
+    sse = ((x - cent[labels]) ** 2).sum()
+    return labels, cent, sse
+
+def bic(x, labels, k, sse):
+    # x-means BIC (Pelleg & Moore), spherical gaussians with shared variance
+    r, d = x.shape
+    if r <= k:
+        return -np.inf
+    var = max(sse / (r - k), 1e-300)
+    ll = 0.0
+    for c in range(k):
+        rc = np.count_nonzero(labels == c)
+        if rc == 0:
+            continue
+        ll += (rc * np.log(rc) - rc * np.log(r) -
+               rc * 0.5 * np.log(2 * np.pi) - rc * d * 0.5 * np.log(var) -
+               (rc - k) * 0.5)
+    params = (k - 1) + (k * d) + 1
+    return ll - params * 0.5 * np.log(r)
+
+def cluster(args):
+    bb_path = args.bbv
+    if os.path.isdir(bb_path):
+        bb_path = os.path.join(bb_path, "bbv.bb")
+    blocks_path = os.path.join(os.path.dirname(bb_path), "bbv_blocks.json")
+    with open(blocks_path) as f:
+        blocks = json.load(f)
+    rows = read_bbv(bb_path)
+    rng = np.random.default_rng(args.seed)
+    x, insts = project(rows, args.dim, rng)
+    n = len(rows)
+
+    # keep the best of a few seeds per k, then the smallest k close to max BIC
+    runs = {}
+    for k in range(1, min(args.max_k, n) + 1):
+        best = None
+        for _ in range(args.init):
+            labels, cent, sse = kmeans(x, k, rng)
+            if (best is None) or (sse < best[2]):
+                best = (labels, cent, sse)
+        runs[k] = best + (bic(x, best[0], k, best[2]),)
+    scores = np.array([runs[k][3] for k in runs])
+    finite = scores[np.isfinite(scores)]
+    lo, hi = finite.min(), finite.max()
+    k_sel = next(k for k in runs
+                 if runs[k][3] >= (lo + BIC_THRESHOLD * (hi - lo)))
+    labels, cent, _, _ = runs[k_sel]
+
+    # closest interval to each centroid, weights by instructions in the cluster
+    points = []
+    for c in range(k_sel):
+        members = np.flatnonzero(labels == c)
+        if len(members) == 0:
+            continue
+        d2 = ((x[members] - cent[c]) ** 2).sum(1)
+        rep = int(members[d2.argmin()])
+        points.append({
+            "interval": rep,
+            "cluster": c,
+            "weight": float(insts[members].sum() / insts.sum()),
+            "size": len(members),
+        })
+    points.sort(key=lambda p: p["interval"])
+
+    out = args.out or os.path.join(os.path.dirname(bb_path), "simpoints.json")
+    res = {
+        "interval": blocks["interval"],
+        "inst_start": blocks["inst_start"],
+        "intervals": n,
+        "insts": int(insts.sum()),
+        "k": k_sel,
+        "bic": {str(k): float(runs[k][3]) for k in runs},
+        "points": points,
+    }
+    write_json(out, res)
+    out_dir = os.path.dirname(os.path.abspath(out))
+    with open(os.path.join(out_dir, "simpoints"), "w") as f:
+        for i, p in enumerate(points):
+            f.write(f"{p['interval']} {i}\n")
+    with open(os.path.join(out_dir, "weights"), "w") as f:
+        for i, p in enumerate(points):
+            f.write(f"{p['weight']:.6f} {i}\n")
+
+    print(f"{n} intervals of {blocks['interval']} instructions, "
+          f"{k_sel} clusters (max k {min(args.max_k, n)})")
+    for p in points:
+        print(f"{INDENT}interval {p['interval']:>6}: weight "
+              f"{p['weight']:.4f} ({p['size']} intervals)")
+    print_file_saved("simpoints", out)
+
+# run
+def elf_entry(elf):
+    with open(elf, "rb") as f:
+        return ELFFile(f).header["e_entry"]
+
+def sim_out_dir(work_dir, elf, tag):
+    # same as gen_out_dir in the sim
+    return os.path.join(work_dir, f"{get_test_name(elf)}_out_{tag}")
+
+def run_sim(cmd, work_dir, timeout, what):
+    r = run_cmd(cmd, work_dir, timeout)
+    status = run_status(r)
+    if run_died(status):
+        print(f"{INDENT}[{status}] {what}: {r['error_msg']}")
+        tail = output_tail(r)
+        if tail:
+            print(tail)
+        return None
+    return r
+
+def perf_event_totals(out_dir):
+    # per event total over all callstacks
+    totals = {}
+    for path in glob.glob(os.path.join(out_dir, "callstack_folded_*.txt")):
+        ev = os.path.basename(path)[len("callstack_folded_"):-len(".txt")]
+        total = 0
+        with open(path) as f:
+            for line in f:
+                parts = line.rsplit(None, 1)
+                if len(parts) == 2 and parts[1].isdigit():
+                    total += int(parts[1])
+        totals[ev] = total
+    return totals
+
+def interval_stats(out_dir):
+    with open(os.path.join(out_dir, "hw_stats.json")) as f:
+        hw = json.load(f)
+    st = {"insts": hw["profiled_inst"]}
+    for c in ("icache", "dcache"):
+        if c in hw:
+            st[f"{c}_references"] = hw[c]["references"]
+            st[f"{c}_misses"] = sum(hw[c]["misses"].values())
+            st[f"{c}_writebacks"] = hw[c]["writebacks"]
+    if "bpred" in hw:
+        st["bp_branches"] = hw["bpred"]["branches"]
+        st["bp_mispredicted"] = hw["bpred"]["mispredicted"]
+    for ev, total in perf_event_totals(out_dir).items():
+        st[f"event_{ev}"] = total
+    return st
+
+def estimate(points, stats, total_insts):
+    # weighted per-instruction rates, scaled to the whole program
+    w = np.array([p["weight"] for p in points])
+    keys = sorted(set().union(*[s.keys() for s in stats]) - {"insts"})
+    insts = np.array([s["insts"] for s in stats], dtype=np.float64)
+    w_insts = (w * insts).sum()
+    est = {}
+    for key in keys:
+        v = np.array([s.get(key, 0) for s in stats], dtype=np.float64)
+        est[key] = (w * v).sum() / w_insts * total_insts
+    derived = {}
+    for c in ("icache", "dcache"):
+        if f"{c}_references" in est:
+            ref, miss = est[f"{c}_references"], est[f"{c}_misses"]
+            derived[f"{c}_hr"] = 100 * (1 - miss / ref) if ref else 0.0
+            derived[f"{c}_mpki"] = 1000 * miss / total_insts
+    if "bp_branches" in est:
+        br, mp = est["bp_branches"], est["bp_mispredicted"]
+        derived["bp_accuracy"] = 100 * (1 - mp / br) if br else 0.0
+        derived["bp_mpki"] = 1000 * mp / total_insts
+    for key in keys:
+        if key.startswith("event_"):
+            derived[f"{key}_pki"] = 1000 * est[key] / total_insts
+    return est, derived
+
+def run(args):
+    with open(args.simpoints) as f:
+        sp = json.load(f)
+    elf = os.path.abspath(args.elf)
+    sim = os.path.abspath(args.isa_sim)
+    work_dir = os.path.abspath(args.work_dir)
+    os.makedirs(work_dir, exist_ok=True)
+    extra = args.sim_args.split()
+    interval = sp["interval"]
+
+    stats = []
+    for i, p in enumerate(sp["points"]):
+        start = sp["inst_start"] + (p["interval"] * interval)
+        ckpt_at = max(0, start - args.warmup)
+        tag = f"sp{i}"
+        cmd = [sim, elf, "--out_dir_tag", tag,
+               "--run_insts", str(start + interval)] + extra
+        if ckpt_at > 0:
+            ckpt = os.path.join(work_dir, f"{tag}.ckpt")
+            ckpt_cmd = [sim, elf, "--out_dir_tag", f"{tag}_ckpt",
+                        "--fast_forward", "--run_insts", str(ckpt_at),
+                        "--ckpt_save", ckpt]
+            if run_sim(ckpt_cmd, work_dir, args.timeout, f"{tag} ckpt") is None:
+                sys.exit(1)
+            cmd += ["--ckpt_restore", ckpt]
+        if start > 0:
+            cmd += ["--prof_inst_start", str(start)]
+        else:
+            cmd += ["--prof_pc_start", f"{elf_entry(elf):x}"]
+        r = run_sim(cmd, work_dir, args.timeout, tag)
+        if r is None:
+            sys.exit(1)
+        _, profiled = parse_inst_counts(r["stdout"])
+        st = interval_stats(sim_out_dir(work_dir, elf, tag))
+        stats.append(st)
+        print(f"{INDENT}[{tag}] interval {p['interval']}, weight "
+              f"{p['weight']:.4f}, profiled {profiled} "
+              f"({r['elapsed_s']:.2f}s)")
+
+    est, derived = estimate(sp["points"], stats, sp["insts"])
+    print(f"Estimates for {sp['insts']} instructions from "
+          f"{len(stats)} intervals of {interval}:")
+    for k, v in derived.items():
+        print(f"{INDENT}{k}: {v:.2f}")
+    out = args.json_out or os.path.join(work_dir, "simpoint_est.json")
+    write_json(out, {
+        "elf": elf,
+        "warmup": args.warmup,
+        "sim_args": extra,
+        "points": [dict(p, stats=s) for p, s in zip(sp["points"], stats)],
+        "totals": est,
+        "metrics": derived,
+    })
+    print_file_saved("estimates", out)
+
+def main():
+    args = parse_args()
+    if args.cmd == "cluster":
+        cluster(args)
+    else:
+        run(args)
+
+if __name__ == "__main__":
+    main()
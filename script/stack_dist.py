@@ -0,0 +1,83 @@
+#!/usr/bin/env python3
+
+# Miss rate curves from the LRU stack distance profile (--stack_dist)
+# 'stack_dist.json' has misses per set count and ways, for I$ and D$
+
+import argparse
+import json
+import os
+
+import matplotlib.pyplot as plt
+from utils import INDENT, get_test_title, print_file_saved
+
+parser = argparse.ArgumentParser(description="Plot cache miss rate curves from the LRU stack distance profile")
+parser.add_argument('prof', help="Input 'stack_dist.json'")
+parser.add_argument('--cache', choices=['icache', 'dcache'], default=None, help="Plot only this cache, both by default")
+parser.add_argument('--ways', default="1,2,4,8,16", help="Comma-separated associativities, one curve each")
+parser.add_argument('--max_size', type=int, default=65536, help="Largest cache size in bytes to plot")
+parser.add_argument('--save_png', action='store_true', help="Save charts as PNG")
+parser.add_argument('--save_csv', action='store_true', help="Save curves formatted as CSV")
+parser.add_argument('--print', action='store_true', help="Print miss rates to stdout")
+parser.add_argument('-s', '--silent', action='store_true', help="Don't display chart(s)")
+
+args = parser.parse_args()
+
+with open(args.prof) as f:
+    prof = json.load(f)
+
+line_size = prof["line_size"]
+ways_list = [int(w) for w in args.ways.split(",")]
+caches = [args.cache] if args.cache else ["icache", "dcache"]
+title = get_test_title(args.prof)
+out_base = os.path.splitext(args.prof)[0]
+
+def curves(sd):
+    # size -> miss rate, per ways
+    refs = sd["references"]
+    out = {}
+    for w in ways_list:
+        pts = []
+        for sets, misses in sd["misses"].items():
+            size = int(sets) * w * line_size
+            if (w > len(misses)) or (size > args.max_size):
+                continue
+            pts.append((size, (100 * misses[w - 1] / refs) if refs else 0.0))
+        out[w] = sorted(pts)
+    return out
+
+fig, axs = plt.subplots(1, len(caches), figsize=(6 * len(caches), 4.5), squeeze=False)
+csv = ["cache,ways,size,miss_rate"]
+for ax, ck in zip(axs[0], caches):
+    sd = prof[ck]
+    if args.print:
+        print(f"{ck}: {sd['references']} references, {sd['cold']} cold misses")
+    for w, pts in curves(sd).items():
+        if not pts:
+            continue
+        x, y = zip(*pts)
+        ax.plot(x, y, marker="o", markersize=3, label=f"{w}-way")
+        for size, mr in pts:
+            csv.append(f"{ck},{w},{size},{mr:.4f}")
+            if args.print:
+                print(f"{INDENT}{w:>3}-way {size:>8} B: {mr:.2f}%")
+    ax.set_xscale("log", base=2)
+    ax.set_xlabel("Size [B]")
+    ax.set_ylabel("Miss rate [%]")
+    ax.set_title(f"{ck}, LRU, {line_size} B lines")
+    ax.grid(True, which="both", alpha=0.3)
+    ax.legend()
+
+fig.suptitle(title)
+fig.tight_layout()
+
+if args.save_csv:
+    with open(f"{out_base}.csv", "w") as f:
+        f.write("\n".join(csv) + "\n")
+    print_file_saved("miss rate curves", f"{out_base}.csv")
+
+if args.save_png:
+    fig.savefig(f"{out_base}.png", dpi=200)
+    print_file_saved("chart", f"{out_base}.png")
+
+if not args.silent:
+    plt.show()
@@ -0,0 +1,226 @@
+#!/usr/bin/env python3
+
+# Reader for the chunked trace format of 'trace.bin', 'rf_trace.bin' and
+# 'exec.bin'
+# Layout is documented in src/profilers/trace_stream.h
+# Chunks are located through the index, so a sample range only decodes the
+# chunks that overlap it
+
+import argparse
+import os
+import struct
+import zlib
+
+import numpy as np
+
+MAGIC = 0x53525441 # "ATRS"
+INDEX_MAGIC = 0x58525441 # "ATRX"
+VERSION = 1
+FLAG_DEFLATE = 1 << 0
+HDR = struct.Struct("<6I")
+CHUNK_HDR = struct.Struct("<3I")
+INDEX_ENTRY = struct.Struct("<3QI")
+TRAILER = struct.Struct("<QII")
+KINDS = ["trace", "rf_trace", "exec_log"]
+# column holding the key deltas, rf_trace keys are entry numbers
+KEY_COL = {"trace": 0, "exec_log": 1}
+
+# column order, as in te_col_t and rf_trace_entry
+TRACE_COLS = [
+    "sample_cnt", "inst", "pc", "next_pc", "dmem", "sp",
+    "taken", "inst_size", "dmem_size", "ic_hm", "dc_hm", "bp_hm",
+]
+TRACE_CT_COLS = [
+    "ct_imem_core", "ct_imem_mem", "ct_dmem_core_r", "ct_dmem_core_w",
+    "ct_dmem_mem_r", "ct_dmem_mem_w",
+]
+RF_TRACE_COLS = [
+    "opc_g_val", "opc_b_val", "rd", "rs1", "rs2", "rd_val_zero",
+    "rdp_val_zero",
+]
+
+class trace_file:
+    def __init__(self, path):
+        self.path = path
+        self.f = open(path, "rb")
+        hdr = HDR.unpack(self.f.read(HDR.size))
+        magic, ver, kind, self.n_cols, self.chunk_entries, self.flags = hdr
+        if magic != MAGIC:
+            raise ValueError(f"'{path}' is not a chunked trace file")
+        if ver != VERSION:
+            raise ValueError(f"'{path}': unsupported trace version {ver}")
+        self.kind = KINDS[kind]
+        self.index = self._read_index()
+
+    def _read_index(self):
+        """List of (first_key, last_key, offset, entries) per chunk"""
+        size = os.fstat(self.f.fileno()).st_size
+        if size >= HDR.size + TRAILER.size:
+            self.f.seek(size - TRAILER.size)
+            idx_off, n, magic = TRAILER.unpack(self.f.read(TRAILER.size))
+            if magic == INDEX_MAGIC:
+                self.f.seek(idx_off)
+                raw = self.f.read(n * INDEX_ENTRY.size)
+                return list(INDEX_ENTRY.iter_unpack(raw))
+        # no index, sim didn't finish, walk the chunks written so far
+        index = []
+        off = HDR.size
+        key = 0
+        while off + CHUNK_HDR.size <= size:
+            self.f.seek(off)
+            entries, _, stored = CHUNK_HDR.unpack(self.f.read(CHUNK_HDR.size))
+            if off + CHUNK_HDR.size + stored > size:
+                break
+            first, last = key, key + entries - 1
+            if self.kind in KEY_COL: # keys are delta coded, decode them
+                _, cols = self.read_chunk((0, 0, off, entries))
+                keys = np.cumsum(varints(cols[KEY_COL[self.kind]], entries),
+                                 dtype=np.uint64)
+                first, last = int(keys[0]), int(keys[-1])
+            index.append((first, last, off, entries))
+            key += entries
+            off += CHUNK_HDR.size + stored
+        return index
+
+    @property
+    def entries(self):
+        return sum(c[3] for c in self.index)
+
+    @property
+    def key_range(self):
+        if not self.index:
+            return (0, 0)
+        return (self.index[0][0], self.index[-1][1])
+
+    def chunks(self, key_begin=None, key_end=None):
+        """Chunks overlapping [key_begin, key_end], all without a range"""
+        return [c for c in self.index
+                if (key_begin is None or c[1] >= key_begin) and
+                   (key_end is None or c[0] <= key_end)]
+
+    def read_chunk(self, chunk):
+        """Raw column bytes of one chunk"""
+        _, _, off, _ = chunk
+        self.f.seek(off)
+        entries, raw_size, stored = CHUNK_HDR.unpack(self.f.read(CHUNK_HDR.size))
+        payload = self.f.read(stored)
+        if stored < raw_size:
+            payload = zlib.decompress(payload)
+        sizes = np.frombuffer(payload, dtype="<u4", count=self.n_cols)
+        cols = []
+        pos = 4 * self.n_cols
+        for s in sizes:
+            cols.append(np.frombuffer(payload, dtype=np.uint8, count=s,
+                                      offset=pos))
+            pos += int(s)
+        return entries, cols
+
+    def close(self):
+        self.f.close()
+
+def varints(b, n):
+    """Decode n LEB128 values from a uint8 array"""
+    ends = np.flatnonzero(b < 0x80)
+    if len(ends) != n:
+        raise ValueError(f"expected {n} varints, found {len(ends)}")
+    starts = np.empty_like(ends)
+    starts[0:1] = 0
+    starts[1:] = ends[:-1] + 1
+    lens = ends - starts + 1
+    out = np.zeros(n, dtype=np.uint64)
+    for k in range(int(lens.max()) if n else 0):
+        m = lens > k
+        v = (b[starts[m] + k] & 0x7f).astype(np.uint64)
+        out[m] |= v << np.uint64(7 * k)
+    return out
+
+def unzigzag(z):
+    z = z.astype(np.uint32)
+    return (z >> np.uint32(1)) ^ (np.uint32(0) - (z & np.uint32(1)))
+
+def decode_trace_chunk(entries, cols):
+    """Columns of one trace.bin chunk, by C++ field name"""
+    names = TRACE_COLS + (TRACE_CT_COLS if len(cols) > len(TRACE_COLS) else [])
+    c = dict(zip(names, cols))
+    out = {}
+    out["sample_cnt"] = np.cumsum(varints(c["sample_cnt"], entries),
+                                  dtype=np.uint64)
+    out["inst"] = np.frombuffer(c["inst"].tobytes(), dtype="<u4")
+    d_pc = unzigzag(varints(c["pc"], entries))
+    d_next = unzigzag(varints(c["next_pc"], entries))
+    # pc is the previous next_pc plus its delta
+    out["next_pc"] = np.cumsum(d_pc + d_next, dtype=np.uint32)
+    out["pc"] = out["next_pc"] - d_next
+    dm = varints(c["dmem"], entries)
+    acc = dm != 0
+    dmem = np.zeros(entries, dtype=np.uint32)
+    dmem[acc] = np.cumsum(unzigzag(dm[acc] - np.uint64(1)), dtype=np.uint32)
+    out["dmem"] = dmem
+    out["sp"] = np.cumsum(unzigzag(varints(c["sp"], entries)),
+                          dtype=np.uint32)
+    for n in names[6:]:
+        out[n] = c[n]
+    return {n: out[n] for n in names}
+
+def open_trace(path, kind):
+    tf = trace_file(path)
+    if tf.kind != kind:
+        raise ValueError(f"'{path}' is a {tf.kind} file, expected {kind}")
+    return tf
+
+def trace_range(path):
+    """First and last sample of a trace.bin from the index, None if empty"""
+    tf = open_trace(path, "trace")
+    tf.close()
+    return tf.key_range if tf.index else None
+
+def read_trace(path, smp_begin=None, smp_end=None):
+    """
+    trace.bin columns by C++ field name, whole chunks overlapping
+    [smp_begin, smp_end], so samples around the range are included
+    """
+    tf = open_trace(path, "trace")
+    parts = [decode_trace_chunk(*tf.read_chunk(ch))
+             for ch in tf.chunks(smp_begin, smp_end)]
+    tf.close()
+    return concat(parts, TRACE_COLS)
+
+def read_rf_trace(path, begin=None, end=None):
+    """rf_trace.bin columns by C++ field name, entries [begin, end]"""
+    tf = open_trace(path, "rf_trace")
+    chunks = tf.chunks(begin, end)
+    parts = [dict(zip(RF_TRACE_COLS, tf.read_chunk(ch)[1])) for ch in chunks]
+    tf.close()
+    out = concat(parts, RF_TRACE_COLS)
+    if not chunks:
+        return out
+    lo = (begin - chunks[0][0]) if begin is not None else 0
+    hi = (end - chunks[0][0] + 1) if end is not None else None
+    return {n: v[max(lo, 0):hi] for n, v in out.items()}
+
+def concat(parts, names):
+    if not parts:
+        return {n: np.zeros(0, dtype=np.uint8) for n in names}
+    return {n: np.concatenate([p[n] for p in parts]) for n in parts[0]}
+
+def main():
+    parser = argparse.ArgumentParser(description="Show the chunk index of a 'trace.bin', 'rf_trace.bin' or 'exec.bin'")
+    parser.add_argument('trace', help="Input 'trace.bin', 'rf_trace.bin' or 'exec.bin'")
+    parser.add_argument('--chunks', action='store_true', help="List all chunks")
+    args = parser.parse_args()
+
+    tf = trace_file(args.trace)
+    size = os.path.getsize(args.trace)
+    lo, hi = tf.key_range
+    key = {"trace": "sample", "exec_log": "inst"}.get(tf.kind, "entry")
+    print(f"{tf.kind}: {tf.entries} entries in {len(tf.index)} chunks, "
+          f"{key} [{lo}, {hi}], {size} B "
+          f"({size / max(tf.entries, 1):.2f} B/entry)"
+          f"{', deflated' if tf.flags & FLAG_DEFLATE else ''}")
+    if args.chunks:
+        for first, last, off, entries in tf.index:
+            print(f"    {key} [{first}, {last}], {entries} entries at {off}")
+    tf.close()
+
+if __name__ == "__main__":
+    main()
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstdint>
 #include <iostream>
 #include <set>
 #include <sstream>
@@ -78,3 +79,38 @@ std::vector<T> resolve_arg_list(
     }
     return {seen.begin(), seen.end()};
 }
+
+// fields of a compound arg, e.g. 64:2:lru
+inline std::vector<std::string> split_arg(const std::string& arg, char delim) {
+    std::vector<std::string> fields;
+    std::istringstream iss(arg);
+    std::string field;
+    while (std::getline(iss, field, delim)) fields.push_back(field);
+    return fields;
+}
+
+// size in bytes with an optional K, M or G suffix, e.g. 64M
+inline uint64_t resolve_size_arg(
+    const std::string& name, const std::string& arg)
+{
+    size_t pos = 0;
+    uint64_t val = 0;
+    try {
+        val = std::stoull(arg, &pos, 10);
+    } catch (const std::exception&) {
+        pos = 0;
+    }
+    std::string sfx = arg.substr(pos);
+    uint32_t shift = 0;
+    if (sfx == "K" || sfx == "k") shift = 10;
+    else if (sfx == "M" || sfx == "m") shift = 20;
+    else if (sfx == "G" || sfx == "g") shift = 30;
+    else if (!sfx.empty()) pos = 0;
+    if (pos == 0) {
+        std::cout << "Invalid value for " << name << ": " << arg
+                  << ". Expected bytes, optionally with K, M or G suffix"
+                  << std::endl;
+        throw std::invalid_argument("");
+    }
+    return (val << shift);
+}
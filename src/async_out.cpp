@@ -0,0 +1,136 @@
+#include <algorithm>
+
+#include "async_out.h"
+
+bool async_out_buf::open(const std::string& path, std::ios::openmode mode) {
+    if (en) close();
+    ofs.open(path, mode);
+    if (!ofs.is_open()) return false;
+    head.store(0);
+    tail.store(0);
+    failed = false;
+    en = true;
+    next_block();
+    async_io::get().add(this);
+    return true;
+}
+
+void async_out_buf::hand_off(bool flush) {
+    uint64_t h = head.load(std::memory_order_relaxed);
+    used[h % async_out_cfg::blocks] = TO_U64(pptr() - pbase());
+    flush_req[h % async_out_cfg::blocks] = flush;
+    head.store(h + 1, std::memory_order_release);
+    async_io::get().notify();
+}
+
+void async_out_buf::next_block() {
+    uint64_t h = head.load(std::memory_order_relaxed);
+    auto free = [&] {
+        return ((h - tail.load(std::memory_order_acquire)) <
+                async_out_cfg::blocks);
+    };
+    if (!free()) {
+        // I/O thread is a full ring behind
+        std::unique_lock<std::mutex> lk(mtx);
+        cv.wait(lk, free);
+    }
+    auto& b = blocks[h % async_out_cfg::blocks];
+    if (b.empty()) b.resize(async_out_cfg::block_size);
+    setp(b.data(), b.data() + b.size());
+}
+
+async_out_buf::int_type async_out_buf::overflow(int_type c) {
+    if (!en) return traits_type::eof();
+    hand_off(false);
+    next_block();
+    if (!traits_type::eq_int_type(c, traits_type::eof())) {
+        *pptr() = traits_type::to_char_type(c);
+        pbump(1);
+    }
+    return traits_type::not_eof(c);
+}
+
+int async_out_buf::sync() {
+    if (!en) return 0;
+    if (pptr() != pbase()) {
+        hand_off(true);
+        next_block();
+    }
+    return failed ? -1 : 0;
+}
+
+bool async_out_buf::close() {
+    if (!en) return true;
+    if (pptr() != pbase()) hand_off(true);
+    {
+        std::unique_lock<std::mutex> lk(mtx);
+        cv.wait(lk, [&] {
+            return (tail.load(std::memory_order_acquire) ==
+                    head.load(std::memory_order_relaxed));
+        });
+    }
+    async_io::get().remove(this);
+    setp(nullptr, nullptr);
+    en = false;
+    ofs.close();
+    return !(failed || ofs.fail());
+}
+
+void async_out_buf::drain() {
+    uint64_t t = tail.load(std::memory_order_relaxed);
+    while (t < head.load(std::memory_order_acquire)) {
+        uint32_t i = TO_U32(t % async_out_cfg::blocks);
+        ofs.write(blocks[i].data(), TO_I64(used[i]));
+        if (flush_req[i]) ofs.flush();
+        if (!ofs) failed = true;
+        t++;
+        {
+            std::lock_guard<std::mutex> lk(mtx);
+            tail.store(t, std::memory_order_release);
+        }
+        cv.notify_all();
+    }
+}
+
+async_io::~async_io() {
+    {
+        std::lock_guard<std::mutex> lk(mtx);
+        stop = true;
+    }
+    cv.notify_one();
+    if (th.joinable()) th.join();
+}
+
+void async_io::add(async_out_buf* f) {
+    std::lock_guard<std::mutex> lk(reg_mtx);
+    files.push_back(f);
+    if (!th.joinable()) th = std::thread(&async_io::run, this);
+}
+
+void async_io::remove(async_out_buf* f) {
+    std::lock_guard<std::mutex> lk(reg_mtx);
+    files.erase(std::find(files.begin(), files.end(), f));
+}
+
+void async_io::notify() {
+    {
+        std::lock_guard<std::mutex> lk(mtx);
+        pending = true;
+    }
+    cv.notify_one();
+}
+
+void async_io::run() {
+    std::unique_lock<std::mutex> lk(mtx);
+    while (true) {
+        cv.wait(lk, [&] { return (pending || stop); });
+        if (!pending) return; // stop, everything written
+        pending = false;
+        lk.unlock();
+        {
+            std::lock_guard<std::mutex> rl(reg_mtx);
+            for (auto f : files) f->drain();
+        }
+        lk.lock();
+    }
+}
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include "defines.h"
+
+namespace async_out_cfg {
+    constexpr size_t block_size = (1u << 20);
+    constexpr uint32_t blocks = 4; // per file, bounds memory
+}
+
+/*
+Output file written by a background I/O thread
+- sim thread fills fixed size blocks, a full block (or a flush) is handed off
+  through a single producer, single consumer ring and the next free block is
+  taken, records never touch the file on the sim thread
+- sim thread only waits when all blocks of a file are still being written,
+  memory stays bounded to the blocks no matter the run length
+- one I/O thread serves all files, started with the first one opened
+*/
+class async_out_buf : public std::streambuf {
+    private:
+        std::ofstream ofs;
+        std::array<std::vector<char>, async_out_cfg::blocks> blocks;
+        std::array<size_t, async_out_cfg::blocks> used = {};
+        std::array<bool, async_out_cfg::blocks> flush_req = {};
+        // blocks handed off and written, each only advanced by one thread
+        std::atomic<uint64_t> head{0};
+        std::atomic<uint64_t> tail{0};
+        std::atomic<bool> failed{false};
+        std::mutex mtx;
+        std::condition_variable cv; // sim thread waits for a free block
+        bool en = false;
+
+    private:
+        void hand_off(bool flush);
+        void next_block();
+
+    public:
+        async_out_buf() = default;
+        ~async_out_buf() { close(); }
+        bool open(const std::string& path, std::ios::openmode mode);
+        bool is_open() const { return en; }
+        // waits for all blocks to be written, false if anything failed
+        bool close();
+        // I/O thread only
+        void drain();
+
+    protected:
+        int_type overflow(int_type c) override;
+        int sync() override;
+};
+
+// drop-in for std::ofstream on the sim thread
+class async_ofstream : public std::ostream {
+    private:
+        async_out_buf buf;
+
+    public:
+        async_ofstream() : std::ostream(nullptr) { rdbuf(&buf); }
+        void open(const std::string& path,
+                  std::ios::openmode mode = std::ios::out) {
+            if (!buf.open(path, mode)) setstate(std::ios::failbit);
+        }
+        bool is_open() const { return buf.is_open(); }
+        void close() { if (!buf.close()) setstate(std::ios::failbit); }
+};
+
+class async_io {
+    private:
+        std::thread th;
+        std::mutex mtx; // wake up
+        std::condition_variable cv;
+        std::mutex reg_mtx; // held while draining
+        std::vector<async_out_buf*> files;
+        bool pending = false;
+        bool stop = false;
+
+    private:
+        async_io() = default;
+        void run();
+
+    public:
+        ~async_io();
+        static async_io& get() {
+            static async_io io;
+            return io;
+        }
+        void add(async_out_buf* f);
+        void remove(async_out_buf* f);
+        void notify();
+};
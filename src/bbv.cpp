@@ -0,0 +1,82 @@
+#include "bbv.h"
+
+void bbv_collector::init(
+    uint64_t interval, std::string out_dir, uint64_t inst_cnt) {
+    this->interval = interval;
+    this->out_dir = out_dir;
+    inst_start = inst_cnt;
+    interval_end = (inst_cnt + interval);
+    ofs.open(out_dir + "bbv.bb");
+    if (!ofs.is_open()) {
+        std::cerr << "ERROR: Failed to open " << out_dir << "bbv.bb"
+                  << std::endl;
+        throw std::runtime_error("Failed to open BBV file.");
+    }
+}
+
+void bbv_collector::end_block(uint64_t inst_cnt) {
+    if (!blk_id) return;
+    // current block may run past one or more interval boundaries
+    while (inst_cnt >= interval_end) {
+        add(interval_end - blk_start);
+        blk_start = interval_end;
+        write_interval();
+    }
+    add(inst_cnt - blk_start);
+    blk_start = inst_cnt;
+}
+
+void bbv_collector::start_block(uint32_t pc, uint64_t inst_cnt) {
+    end_block(inst_cnt);
+    auto it = ids.find(pc);
+    if (it == ids.end()) {
+        blk_pcs.push_back(pc);
+        blk_cnt.push_back(0);
+        it = ids.emplace(pc, TO_U32(blk_pcs.size())).first;
+    }
+    blk_id = it->second;
+    blk_start = inst_cnt;
+}
+
+void bbv_collector::add(uint64_t cnt) {
+    if (cnt == 0) return;
+    uint64_t& c = blk_cnt[blk_id - 1];
+    if (c == 0) touched.push_back(blk_id);
+    c += cnt;
+}
+
+void bbv_collector::write_interval() {
+    std::sort(touched.begin(), touched.end());
+    ofs << "T";
+    for (const auto id : touched) {
+        ofs << ":" << id << ":" << blk_cnt[id - 1] << " ";
+        blk_cnt[id - 1] = 0;
+    }
+    ofs << "\n";
+    touched.clear();
+    intervals++;
+    interval_end += interval;
+}
+
+void bbv_collector::finish(uint64_t inst_cnt) {
+    if (!interval) return;
+    // last block and partial interval, as long as anything ran in it
+    end_block(inst_cnt);
+    if (!touched.empty()) write_interval();
+    ofs.close();
+
+    std::ofstream ofs_blk(out_dir + "bbv_blocks.json");
+    ofs_blk << "{\n\"interval\": " << interval
+            << ",\n\"intervals\": " << intervals
+            << ",\n\"inst_start\": " << inst_start
+            << ",\n\"insts\": " << (inst_cnt - inst_start)
+            << ",\n\"blocks\": [";
+    for (size_t i = 0; i < blk_pcs.size(); i++) {
+        ofs_blk << (i ? ", " : "") << "\"0x" << std::hex << blk_pcs[i]
+                << std::dec << "\"";
+    }
+    ofs_blk << "]\n}\n";
+    std::cout << "BBV: " << intervals << " intervals of " << interval
+              << " instructions, " << blk_pcs.size() << " blocks, saved as '"
+              << out_dir << "bbv.bb'\n";
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include "defines.h"
+
+/*
+SimPoint basic block vectors
+- a block starts at the target of any control flow change, trap or interrupt
+  included, and runs until the next one, so a not taken branch doesn't end it
+- blocks are identified by their start pc, ids in the .bb file are 1-based in
+  order of first execution, start pcs are listed in bbv_blocks.json
+- one 'T:<id>:<count> :<id>:<count> ...' line per interval, count is the number
+  of instructions executed in the block during the interval
+- a block crossing an interval boundary is split between the two intervals
+*/
+class bbv_collector {
+    private:
+        uint64_t interval = 0; // instructions, 0 if not collecting
+        uint64_t inst_start = 0; // inst count at the start of the first one
+        uint64_t interval_end = 0;
+        uint64_t intervals = 0; // written so far
+        uint32_t seq_pc = 0x1; // pc that continues the current block
+        uint32_t blk_id = 0; // current block, 0 before the first one
+        uint64_t blk_start = 0; // inst count at the start of the current block
+        std::unordered_map<uint32_t, uint32_t> ids; // start pc -> id
+        std::vector<uint32_t> blk_pcs; // id - 1 -> start pc
+        std::vector<uint64_t> blk_cnt; // id - 1 -> count in this interval
+        std::vector<uint32_t> touched; // ids with nonzero count
+        std::ofstream ofs;
+        std::string out_dir;
+
+    public:
+        bbv_collector() = default;
+        // intervals start at inst_cnt, e.g. after a checkpoint restore
+        void init(uint64_t interval, std::string out_dir, uint64_t inst_cnt);
+        // called for every retired instruction, inst_cnt doesn't include it
+        void retire(uint32_t pc, uint32_t next_pc, uint64_t inst_cnt) {
+            if (pc != seq_pc) start_block(pc, inst_cnt);
+            // any jump over more than one instruction ends the block
+            seq_pc = ((next_pc - pc) <= 4) ? next_pc : 0x1;
+        }
+        bool is_en() const { return (interval != 0); }
+        void finish(uint64_t inst_cnt);
+
+    private:
+        void end_block(uint64_t inst_cnt);
+        void start_block(uint32_t pc, uint64_t inst_cnt);
+        void add(uint64_t cnt);
+        void write_interval();
+};
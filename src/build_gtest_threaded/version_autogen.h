@@ -0,0 +1,16 @@
+// Auto-generated. Do not edit.
+#pragma once
+namespace build_info {
+    inline constexpr const char* version         = "v0.0.0-0-g0000000";
+    inline constexpr const char* commit_sha      = "110fa753e09dc0c7bbda21f2799de67dee422e50";
+    inline constexpr const char* commit_short    = "110fa753e09d";
+    inline constexpr const char* branch          = "master";
+    inline constexpr const char* tag             = "v0.0.0";
+    inline constexpr const char* dirty           = "dirty";
+    inline constexpr const char* repo_url        = "unknown";
+    inline constexpr const char* commit_date_utc = "2026-10-18T06:36:54+00:00";
+    inline constexpr const char* build_date_utc  = "2026-10-18T06:46:28Z";
+    inline constexpr const char* compiler        = "g++ (Debian 12.2.0-14+deb12u1) 12.2.0";
+    inline constexpr const char* cxx_flags       = "-Wall -Wextra -Wcast-qual -Wold-style-cast -Wunreachable-code -Wnull-dereference -Wnon-virtual-dtor -Woverloaded-virtual -Werror=conversion -Werror -pedantic -std=gnu++17 -pthread  -Wno-error=null-dereference  -O3 -flto=auto  -march=native -mtune=native";
+    inline constexpr const char* ld_flags        = "";
+} // namespace build_info
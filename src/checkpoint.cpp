@@ -0,0 +1,134 @@
+#include "checkpoint.h"
+
+ckpt_out::ckpt_out(std::string path) :
+    ofs(path, std::ios::binary | std::ios::trunc),
+    path(path)
+{
+    if (!ofs.is_open()) {
+        std::cerr << "ERROR: Failed to open checkpoint file for writing: "
+                  << path << std::endl;
+        throw std::runtime_error("Failed to open checkpoint file.");
+    }
+    put(ckpt_cfg::magic);
+    put(ckpt_cfg::version);
+    put(ckpt_cfg::features);
+}
+
+void ckpt_out::put_bytes(const void* data, size_t len) {
+    ofs.write(static_cast<const char*>(data), TO_I64(len));
+}
+
+void ckpt_out::put_str(const std::string& s) {
+    put(TO_U32(s.size()));
+    put_bytes(s.data(), s.size());
+}
+
+void ckpt_out::begin(const std::string& tag) {
+    put_str(tag);
+    sec_start = ofs.tellp();
+    put(TO_U64(0)); // patched at the end of the section
+}
+
+void ckpt_out::end() {
+    std::streampos pos = ofs.tellp();
+    uint64_t size = TO_U64(pos - sec_start) - sizeof(uint64_t);
+    ofs.seekp(sec_start);
+    put(size);
+    ofs.seekp(pos);
+    sec_start = -1;
+}
+
+void ckpt_out::close() {
+    ofs.close();
+    if (ofs.fail()) {
+        std::cerr << "ERROR: Failed to write checkpoint file: " << path
+                  << std::endl;
+        throw std::runtime_error("Failed to write checkpoint file.");
+    }
+}
+
+ckpt_in::ckpt_in(std::string path) :
+    ifs(path, std::ios::binary),
+    path(path)
+{
+    if (!ifs.is_open()) {
+        std::cerr << "ERROR: Failed to open checkpoint file: " << path
+                  << std::endl;
+        throw std::runtime_error("Failed to open checkpoint file.");
+    }
+    if (get<uint32_t>() != ckpt_cfg::magic) error("not a checkpoint file");
+    uint32_t version = get<uint32_t>();
+    if (version != ckpt_cfg::version) {
+        error("unsupported version " + std::to_string(version));
+    }
+    uint32_t features = get<uint32_t>();
+    if (features != ckpt_cfg::features) {
+        std::cerr << "ERROR: Checkpoint features 0x" << std::hex << features
+                  << " don't match the simulator build 0x"
+                  << ckpt_cfg::features << std::dec
+                  << " (UART, UART_IN)" << std::endl;
+        error("saved by a different build");
+    }
+}
+
+void ckpt_in::get_bytes(void* data, size_t len) {
+    ifs.read(static_cast<char*>(data), TO_I64(len));
+    if (!ifs) error("unexpected end of file");
+}
+
+std::string ckpt_in::get_str() {
+    uint32_t len = get<uint32_t>();
+    if (len > 4096) error("corrupt string"); // only tags and signatures
+    std::string s(len, '\0');
+    get_bytes(s.data(), len);
+    return s;
+}
+
+void ckpt_in::enter(const std::string& tag) {
+    if (!enter_opt(tag)) error("missing section '" + tag + "'");
+}
+
+// false and nothing consumed if the next section is not the requested one
+bool ckpt_in::enter_opt(const std::string& tag) {
+    if (ifs.peek() == EOF) {
+        ifs.clear();
+        return false;
+    }
+    std::streampos start = ifs.tellg();
+    std::string next_tag = get_str();
+    uint64_t size = get<uint64_t>();
+    if (next_tag != tag) {
+        ifs.seekg(start);
+        return false;
+    }
+    sec_tag = tag;
+    sec_end = ifs.tellg() + static_cast<std::streamoff>(size);
+    return true;
+}
+
+void ckpt_in::leave() {
+    if (ifs.tellg() != sec_end) error("size mismatch in '" + sec_tag + "'");
+    sec_end = -1;
+}
+
+void ckpt_in::skip() {
+    ifs.seekg(sec_end);
+    sec_end = -1;
+}
+
+// optional section, false if missing or rejected by fn (i.e. left unchanged)
+bool ckpt_in::restore_opt(const std::string& tag, std::function<bool()> fn) {
+    if (!enter_opt(tag)) return false;
+    if (!fn()) {
+        skip();
+        return false;
+    }
+    leave();
+    return true;
+}
+
+void ckpt_in::error(const std::string& msg) {
+    std::cerr << "ERROR: Invalid checkpoint " << path << ": " << msg
+              << std::endl;
+    throw std::runtime_error("Invalid checkpoint file.");
+}
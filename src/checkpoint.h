@@ -0,0 +1,89 @@
+#pragma once
+
+#include "defines.h"
+#include <functional>
+#include <type_traits>
+
+namespace ckpt_cfg {
+    constexpr uint32_t magic = 0x54504b41; // "AKPT"
+    constexpr uint32_t version = 2;
+    // build options that change the architectural state, must match on restore
+    constexpr uint32_t f_uart = (1u << 0);
+    constexpr uint32_t f_uart_in = (1u << 1);
+    constexpr uint32_t features = (
+        #ifdef UART_EN
+        f_uart |
+        #endif
+        #if !defined(DPI) && defined(UART_INPUT_EN)
+        f_uart_in |
+        #endif
+        0u
+    );
+}
+
+/*
+Simulator checkpoint file
+- header (magic, version, features) followed by tagged sections
+- each section stores its size, so optional ones (hw models) can be skipped
+- values are stored as in host memory, checkpoints are not portable across
+  hosts with different endianness
+*/
+class ckpt_out {
+    private:
+        std::ofstream ofs;
+        std::string path;
+        std::streampos sec_start = -1; // position of the open section's size
+
+    public:
+        ckpt_out() = delete;
+        ckpt_out(std::string path);
+        template <typename T>
+        void put(const T& v) {
+            static_assert (std::is_trivially_copyable_v<T>);
+            put_bytes(&v, sizeof(T));
+        }
+        template <typename T>
+        void put_vec(const std::vector<T>& v) {
+            put(TO_U64(v.size()));
+            put_bytes(v.data(), v.size() * sizeof(T));
+        }
+        void put_str(const std::string& s);
+        void put_bytes(const void* data, size_t len);
+        void begin(const std::string& tag);
+        void end();
+        void close();
+};
+
+class ckpt_in {
+    private:
+        std::ifstream ifs;
+        std::string path;
+        std::string sec_tag;
+        std::streampos sec_end = -1;
+
+    public:
+        ckpt_in() = delete;
+        ckpt_in(std::string path);
+        template <typename T>
+        T get() {
+            static_assert (std::is_trivially_copyable_v<T>);
+            T v;
+            get_bytes(&v, sizeof(T));
+            return v;
+        }
+        // size must match the destination, checkpoint is corrupt otherwise
+        template <typename T>
+        void get_vec(std::vector<T>& v) {
+            uint64_t n = get<uint64_t>();
+            if (n != v.size()) error("size mismatch");
+            get_bytes(v.data(), v.size() * sizeof(T));
+        }
+        std::string get_str();
+        void get_bytes(void* data, size_t len);
+        void enter(const std::string& tag);
+        bool enter_opt(const std::string& tag);
+        void leave();
+        void skip();
+        bool restore_opt(const std::string& tag, std::function<bool()> fn);
+        [[noreturn]] void error(const std::string& msg);
+};
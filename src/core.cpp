@@ -5,16 +5,25 @@ core::core(memory *mem, cfg_t cfg, [[maybe_unused]] hw_cfg_t hw_cfg) :
     pc(mem_map::base_addr),
     tu(this, &core::trap_state_update_cb, pc, inst),
     out_dir(cfg.out_dir)
+    #ifdef DECODE_CACHE_EN
+    , dc(mem)
+    #endif
+    #ifdef JIT_EN
+    , jit(jit_helpers())
+    #endif
     #ifdef PROFILERS_EN
     , prof_pc(cfg.prof_pc)
-    , prof(cfg.out_dir, PROF_SRC)
-    , prof_perf(cfg.out_dir, mem->get_symbol_map(), cfg.perf_events, PROF_SRC)
+    , prof(cfg.out_dir, PROF_SRC, cfg.mem_size)
+    , prof_perf(
+        cfg.out_dir, mem->get_symbol_map(), mem->get_symbol_pc_lut(),
+        cfg.perf_events, PROF_SRC)
     #endif
     #ifdef HW_MODELS_EN
     , bp_name("bpred")
     , bp(bp_name, hw_cfg)
     , div(hw_cfg.div_cache_entries)
     , no_bp(hw_cfg.bp_active == bp_t::none)
+    , hw_trace(hw_cfg.hw_trace_save, cfg.mem_size)
     #endif
 {
     rf[0] = 0;
@@ -28,8 +37,10 @@ core::core(memory *mem, cfg_t cfg, [[maybe_unused]] hw_cfg_t hw_cfg) :
     #ifdef PROFILERS_EN
     prof.set_trace_en(cfg.prof_trace);
     if (cfg.no_callstack) prof_perf.set_callstack_en(false);
+    prof_perf.set_sample_period(cfg.perf_sample);
     prof_trace = cfg.prof_trace;
-    prof_rf.set_trace_en(cfg.prof_trace);
+    prof_inst_start = cfg.prof_inst_start;
+    prof_rf.set_trace_en(cfg.prof_trace, cfg.out_dir);
     prof_rf.set_rf_usage_en(cfg.rf_usage);
 
     #ifdef DPI
@@ -46,22 +57,32 @@ core::core(memory *mem, cfg_t cfg, [[maybe_unused]] hw_cfg_t hw_cfg) :
     #endif // DPI
     #endif // PROFILERS_EN
 
-    #ifdef DASM_EN
-    #ifdef HW_MODELS_EN
-    mem->set_hwmi(&hwmi);
+    #ifdef EXEC_LOG_EN
+    logf = {(cfg.log || cfg.log_bin), cfg.log_always, cfg.log_always,
+            cfg.log_state, cfg.log, cfg.log_bin};
+    logf.activate(false);
     #endif
+    #ifdef DASM_EN
     tu.set_dasm(&dasm);
-    logf = {cfg.log, cfg.log_always, cfg.log_always, cfg.log_state};
-    logf.activate(false);
-    if (logf.en) log_ofstream.open(cfg.out_dir + "exec.log");
-    #ifdef PROFILERS_EN
-    if (logf.act && prof_perf.is_callstack_en()) LOG_SYMBOL_TO_FILE;
+    if (logf.txt) log_ofstream.open(cfg.out_dir + "exec.log");
+    dasm_activate();
+    #endif
+    #ifdef EXEC_LOG_BIN_EN
+    if (logf.bin) {
+        tu.set_dasm(&dasm); // trap messages
+        exec_log.open(cfg.out_dir + "exec.bin", exec_log_meta());
+    }
     #endif
+    #if defined(PROFILERS_EN) && defined(EXEC_LOG_EN)
+    if (logf.act && prof_perf.is_callstack_en()) log_callstack();
     #endif
 
     #ifdef HW_MODELS_EN
     last_inst_branch = false;
+    inst_resolved = 0;
+    next_ic_hm = hw_status_t::none;
     mem->set_cache_hws(&hwrs.ic_hm, &hwrs.dc_hm);
+    if (hw_trace.is_en()) mem->set_hw_trace(&hw_trace);
     #ifndef PROFILERS_EN
     prof_state(true); // start profiling from boot, no profilers
     #else
@@ -83,6 +104,17 @@ core::core(memory *mem, cfg_t cfg, [[maybe_unused]] hw_cfg_t hw_cfg) :
         csr_names_w = std::max(csr_names_w, TO_U8(strlen(c.name)));
     }
     mem->set_mip(&csr.at(csr_map::addr::mip).value);
+
+    #ifdef THREADED_DISPATCH_EN
+    run_fast(0); // registers handlers with the decode cache
+    #endif
+
+    #if defined(DECODE_CACHE_EN) && defined(PROFILERS_EN)
+    fast_path = cfg.fast_forward;
+    #ifdef HW_MODELS_EN
+    mem->set_cache_bypass(fast_path);
+    #endif
+    #endif
 }
 
 uint64_t core::run() {
@@ -99,9 +131,46 @@ uint64_t core::run() {
     if (cfg.uart_show) std::cout << "=== UART START ===" << "\n";
     #endif
 
+    #ifndef DPI
+    if (!cfg.ckpt_restore.empty()) restore_ckpt(cfg.ckpt_restore);
+    #ifdef EXEC_LOG_BIN_EN
+    if (logf.bin) exec_log.resume(rf);
+    #endif
+    if (cfg.bbv_interval) bbv.init(cfg.bbv_interval, cfg.out_dir, sim_cnt.inst);
+    #endif
+    #if defined(PROFILERS_EN) && defined(HW_MODELS_EN)
+    if (cfg.smarts_period) smarts_init();
+    #endif
+
     // start the core
     running = true;
-    while (running) single_step();
+    while (running) {
+        #ifdef DECODE_CACHE_EN
+        if (fast_path) {
+            uint64_t steps = event_horizon();
+            if (steps > 0) {
+                #ifdef JIT_EN
+                if (jit.is_en() && !bbv.is_en()) run_jit(steps);
+                else
+                #endif
+                run_fast(steps);
+                if (!running) break;
+            }
+        }
+        #endif
+        #ifndef DPI
+        if (wfi.active) wfi_fast_forward();
+        #endif
+        single_step();
+    }
+
+    #ifndef DPI
+    bbv.finish(sim_cnt.inst);
+    if (!cfg.ckpt_save.empty()) save_ckpt(cfg.ckpt_save);
+    #endif
+    #if defined(PROFILERS_EN) && defined(HW_MODELS_EN)
+    smarts.finish();
+    #endif
 
     // wrap up
     csr_cnt_update(0u); // so all instructions since last CSR access are counted
@@ -109,15 +178,163 @@ uint64_t core::run() {
     return sim_cnt.inst;
 }
 
+#if defined(HW_MODELS_EN) && !defined(DPI)
+// hw models driven by a trace recorded with hw_trace_save, nothing executes
+uint64_t core::replay(std::string path) {
+    std::cout << std::dec << "HW TRACE REPLAY STARTED\n";
+    hw_trace_in in(path, cfg.mem_size);
+    // same starting state as the recording run, where the models match
+    if (!cfg.ckpt_restore.empty()) restore_ckpt(cfg.ckpt_restore);
+    hw_trace_rec_t r;
+    while (in.next(r)) {
+        norm_address_t addr{r.a};
+        switch (r.ev) {
+            case hw_trace_ev_t::fetch: mem->replay_inst(addr); break;
+            case hw_trace_ev_t::rd: mem->replay_rd(addr, r.aux); break;
+            case hw_trace_ev_t::wr: mem->replay_wr(addr, r.aux); break;
+            case hw_trace_ev_t::scp:
+                mem->replay_scp(addr, static_cast<scp_mode_t>(r.aux));
+                break;
+            case hw_trace_ev_t::branch: {
+                // as in d_branch, with this run's predictor
+                uint32_t b_pc = to_full(addr);
+                uint32_t b_next_pc = to_full(norm_address_t{r.c});
+                bp.ideal(b_next_pc);
+                uint32_t spec_pc = bp.predict(b_pc, TO_I32(r.b), r.aux);
+                if (!no_bp) mem->replay_inst(to_norm(spec_pc));
+                bp.update(b_pc, b_next_pc);
+                if (spec_pc != b_next_pc) mem->replay_inst(to_norm(b_next_pc));
+                break;
+            }
+            case hw_trace_ev_t::div: div.eval(r.a, r.b, r.aux); break;
+            case hw_trace_ev_t::prof: hw_prof_state(r.aux); break;
+            case hw_trace_ev_t::bypass: mem->set_cache_bypass(r.aux); break;
+            default: break;
+        }
+    }
+    std::cout << "HW TRACE REPLAY FINISHED\n\n"
+              << "Events: " << in.get_events() << ", profiled instructions: "
+              << in.get_profiled_insts() << "\n";
+    finish_hw(in.get_profiled_insts());
+    return in.get_profiled_insts();
+}
+#endif
+
+#ifndef DPI
+// architectural state and devices, then hw models if simulated
+// profilers are not saved and start from scratch on restore
+void core::save_ckpt(std::string path) {
+    if (csr.at(csr_map::addr::tohost).value & 0x1) {
+        std::cout << "Program exited, checkpoint not saved\n";
+        return;
+    }
+    ckpt_out out(path);
+    out.begin("core");
+    out.put(pc);
+    out.put(next_pc);
+    out.put(inst);
+    out.put(rf);
+    out.put(wfi.active);
+    out.put(wfi.pend);
+    out.put(sim_cnt);
+    out.put(csr_cnt);
+    out.put(TO_U32(csr.size()));
+    for (const auto& c : csr) {
+        out.put(c.first);
+        out.put(c.second.value);
+    }
+    out.end();
+    mem->save(out);
+
+    #ifdef HW_MODELS_EN
+    mem->save_caches(out);
+    out.begin("bpred");
+    bp.save(out);
+    out.end();
+    out.begin("div");
+    div.save(out);
+    out.end();
+    // target of the last branch, already fetched and referenced in the I$
+    out.begin("fetch");
+    out.put(last_inst_branch);
+    out.put(inst_resolved);
+    out.put(next_ic_hm);
+    out.end();
+    #endif
+
+    out.close();
+    std::cout << "Checkpoint saved to " << path << " at instruction "
+              << sim_cnt.inst << "\n";
+}
+
+void core::restore_ckpt(std::string path) {
+    ckpt_in in(path);
+    in.enter("core");
+    pc = in.get<uint32_t>();
+    next_pc = in.get<uint32_t>();
+    inst = in.get<uint32_t>();
+    rf = in.get<decltype(rf)>();
+    wfi.active = in.get<bool>();
+    wfi.pend = in.get<bool>();
+    sim_cnt = in.get<sim_cnt_t>();
+    csr_cnt = in.get<sim_cnt_t>();
+    if (in.get<uint32_t>() != csr.size()) in.error("CSR count mismatch");
+    for (size_t i = 0; i < csr.size(); i++) {
+        auto it = csr.find(in.get<uint16_t>());
+        if (it == csr.end()) in.error("unsupported CSR");
+        it->second.value = in.get<uint32_t>();
+    }
+    in.leave();
+    mem->restore(in);
+
+    #ifdef HW_MODELS_EN
+    mem->restore_caches(in);
+    if (!in.restore_opt("bpred", [&]() { return bp.restore(in); })) {
+        SIM_WARNING << "Checkpoint has no matching branch predictor state, "
+                    << "starting cold\n";
+    }
+    if (!in.restore_opt("div", [&]() { return div.restore(in); })) {
+        SIM_WARNING << "Checkpoint has no matching divider state, "
+                    << "starting cold\n";
+    }
+    // without it, the next instruction is fetched (and referenced) again
+    last_inst_branch = false;
+    in.restore_opt("fetch", [&]() {
+        last_inst_branch = in.get<bool>();
+        inst_resolved = in.get<uint32_t>();
+        next_ic_hm = in.get<hw_status_t>();
+        return true;
+    });
+    #endif
+
+    #ifdef DECODE_CACHE_EN
+    dc.flush(); // code may differ from what was predecoded at boot
+    #endif
+
+    // counters are absolute, limits that already passed would never match
+    if ((cfg.run_insts && (cfg.run_insts <= sim_cnt.inst)) ||
+        (cfg.run_steps && (cfg.run_steps <= sim_cnt.step))) {
+        std::cerr << "ERROR: Checkpoint is at instruction " << sim_cnt.inst
+                  << ", step " << sim_cnt.step << ", run_insts and "
+                  << "run_steps have to be past it" << std::endl;
+        throw std::runtime_error("Run limits before checkpoint.");
+    }
+    std::cout << "Checkpoint restored from " << path << " at instruction "
+              << sim_cnt.inst << "\n";
+}
+#endif
+
 void core::single_step() {
     tu.clear_trap();
 
     // clear everything from previous instruction
     #ifdef DASM_EN
-    dasm.clear_str();
-    #ifdef HW_MODELS_EN
-    hwmi.clear_str();
-    #endif
+    if (dasm.en) {
+        dasm.clear_str();
+        #ifdef HW_MODELS_EN
+        hwmi.clear_str();
+        #endif
+    }
     #endif
 
     #ifdef HW_MODELS_EN
@@ -125,9 +342,20 @@ void core::single_step() {
     #endif
 
     #ifdef PROFILERS_EN
-    if (prof_pc.should_start(pc)) {
+    #ifdef HW_MODELS_EN
+    if (smarts.is_en() && smarts.should_toggle(sim_cnt.inst)) smarts_toggle();
+    #endif
+    if (prof_inst_start && (sim_cnt.inst >= prof_inst_start)) {
+        prof_inst_start = 0;
         prof_state(true);
+    }
+    if (prof_pc.should_start(pc)) {
+        #ifdef DECODE_CACHE_EN
+        if (fast_path) end_fast_forward();
+        #endif
+        if (!prof_inst_start) prof_state(true);
     } else if (prof_pc.should_stop(pc)) {
+        prof_inst_start = 0;
         prof_state(false);
         if (prof_pc.should_exit(pc)) {
             running = false;
@@ -147,12 +375,20 @@ void core::single_step() {
     // clear wfi on interrupt (either trapped or not)
     wfi.active &= (!(tu.is_trapped() || no_trap_interrupt));
     if (!tu.is_trapped() && (!wfi.active || no_trap_interrupt)) {
-        fetch();
-        #ifdef PROFILERS_EN
-        prof.new_inst(inst);
-        branch_taken = false;
+        #ifdef DECODE_CACHE_EN
+        if (fast_path) {
+            exec_pd();
+        } else
         #endif
-        exec();
+        {
+            fetch();
+            #ifdef PROFILERS_EN
+            prof.new_inst(inst);
+            prof_perf.new_inst(pc);
+            branch_taken = false;
+            #endif
+            exec();
+        }
     }
 
     sim_cnt.step++;
@@ -167,20 +403,28 @@ void core::single_step() {
 
     [[maybe_unused]] bool log_symbol = false;
     #ifdef PROFILERS_EN
-    if (!tu.is_trapped()){
+    if (!tu.is_trapped() && detailed()){
         log_symbol = prof_perf.finish_inst(next_pc);
         if (prof_active) prof_pc.inst_cnt++;
     }
     #endif
 
     #ifdef DASM_EN
-    // dasm string always available, logged to the file conditionally
-    DASM_ALIGN;
-    dasm.finish_inst();
-    if (logf.act) log_inst(tu.is_trapped(), log_symbol);
+    // dasm string available while active, logged to the file conditionally
+    if (detailed() && dasm.en) {
+        DASM_ALIGN;
+        dasm.finish_inst();
+        if (logf.act && logf.txt) log_inst(tu.is_trapped());
+    }
+    #endif
+    #ifdef EXEC_LOG_BIN_EN
+    if (detailed() && logf.act && logf.bin) log_bin_inst(tu.is_trapped());
     #endif
 
     if (tu.is_trapped()) {
+        #ifdef EXEC_LOG_EN
+        if (!dasm.en) dasm.asm_ss.str(""); // next trap message starts clean
+        #endif
         if (cfg.exit_on_trap) {
             std::cout << "Core trapped with exit_on_trap set. Exiting.\n";
             running = false;
@@ -190,16 +434,21 @@ void core::single_step() {
 
     #ifdef PROFILERS_EN
     // rf changes only on retired instructions, no need to oversample from dpi
-    prof.track_sp(rf[2]);
-    #ifndef DPI // dpi calls its own save_trace_entry on every cycle
-    save_trace_entry();
-    #endif
+    if (detailed()) {
+        prof.track_sp(rf[2]);
+        #ifndef DPI // dpi calls its own save_trace_entry on every cycle
+        save_trace_entry();
+        #endif
+    }
     #endif
 
-    #if defined(PROFILERS_EN) && defined(DASM_EN)
-    if (log_symbol && logf.act) LOG_SYMBOL_TO_FILE;
+    #if defined(PROFILERS_EN) && defined(EXEC_LOG_EN)
+    if (log_symbol && logf.act) log_callstack();
     #endif
 
+    #ifndef DPI
+    if (bbv.is_en()) bbv.retire(pc, next_pc, sim_cnt.inst);
+    #endif
     pc = next_pc;
     sim_cnt.inst++;
 
@@ -271,6 +520,315 @@ bool core::check_interrupts(bool defer_trap) {
     );
 }
 
+#ifndef DPI
+// idle wfi steps only advance mtime and the uart rx clock
+// skip them, up to the step before the earliest possible wakeup
+void core::wfi_fast_forward() {
+    #ifdef PROFILERS_EN
+    // profiling start/stop pc is checked on every step, idle ones included
+    if ((pc == prof_pc.start) || (pc == prof_pc.stop)) return;
+    #endif
+    uint64_t steps = UINT64_MAX;
+    uint32_t mie_val = csr.at(csr_map::addr::mie).value;
+    if (mie_val & csr_map::mie::mtie) steps = mem->steps_to_mtip();
+    #ifdef UART_INPUT_EN
+    // rx may drain a byte, wakeup or not, so it's an event either way
+    uint64_t next_rx = mem->get_next_rx_time();
+    if (next_rx <= sim_cnt.step) return;
+    steps = std::min(steps, (next_rx - sim_cnt.step + 1));
+    #endif
+    if (cfg.run_steps) {
+        if (cfg.run_steps <= sim_cnt.step) return;
+        steps = std::min(steps, (cfg.run_steps - sim_cnt.step));
+    }
+    if (steps == UINT64_MAX) return; // nothing to wake up for, keep stepping
+    steps--; // the event step itself goes through single_step
+    mem->update_mtime(steps);
+    sim_cnt.step += steps;
+}
+#endif
+
+#ifdef DECODE_CACHE_EN
+#ifdef PROFILERS_EN
+// fast-forward reached the profiling start, detailed models take over from pc
+// models run cold, optionally for a warmup window before profiling starts
+void core::end_fast_forward() {
+    fast_path = false;
+    #ifdef HW_MODELS_EN
+    mem->set_cache_bypass(false);
+    #endif
+    prof_perf.resync_callstack(pc, TO_U32(rf[1]));
+    if (cfg.ff_warmup) prof_inst_start = (sim_cnt.inst + cfg.ff_warmup);
+    std::cout << "Fast-forward ended at instruction " << sim_cnt.inst << "\n";
+}
+#endif
+
+// steps that can run without per-step housekeeping, 0 if the next one needs it
+// nothing can change interrupt state before then: mtime holds its value,
+// uart rx doesn't drain, and csr writes, wfi and mret are fallback insts
+uint64_t core::event_horizon() {
+    if (wfi.active || wfi.pend) return 0;
+
+    // mtimecmp may have been written since the last check
+    mem->update_mtime(0u);
+    uint32_t pending = (
+        csr.at(csr_map::addr::mie).value & csr.at(csr_map::addr::mip).value
+    );
+    bool mstatus_MIE = (
+        csr.at(csr_map::addr::mstatus).value & csr_map::mstatus::mie
+    );
+    if (mstatus_MIE && (pending & (csr_map::mip::mtip | csr_map::mip::meip))) {
+        return 0;
+    }
+
+    // last step before mtime ticks goes through single_step
+    uint64_t steps = (mem->steps_to_mtime_inc() - 1);
+    #ifdef UART_INPUT_EN
+    uint64_t next_rx = mem->get_next_rx_time();
+    steps = std::min(
+        steps, (next_rx > sim_cnt.step) ? (next_rx - sim_cnt.step) : 0);
+    #endif
+    // limits are hit in single_step
+    if (cfg.run_steps) {
+        steps = std::min(
+            steps, (cfg.run_steps > (sim_cnt.step + 1)) ?
+                   (cfg.run_steps - sim_cnt.step - 1) : 0);
+    }
+    if (cfg.run_insts) {
+        steps = std::min(
+            steps, (cfg.run_insts > (sim_cnt.inst + 1)) ?
+                   (cfg.run_insts - sim_cnt.inst - 1) : 0);
+    }
+    return steps;
+}
+
+// same as single_step for predecoded non-fallback insts within the horizon
+// stops early on fallback, trap, or mmio write (e.g. mtimecmp)
+#ifndef THREADED_DISPATCH_EN
+void core::run_fast(uint64_t steps) {
+    tu.clear_trap();
+    uint64_t mmio_wr_cnt = mem->get_mmio_wr_cnt();
+    uint64_t done = 0;
+    while (done < steps) {
+        #ifdef PROFILERS_EN
+        // profiling start and stop are handled in single_step
+        if ((pc == prof_pc.start) || (pc == prof_pc.stop)) break;
+        #endif
+        const pd_inst_t* d = dc.get(pc);
+        if (d == nullptr) break;
+        if (d->op == pd_op_t::fallback) {
+            dc.unget(pc);
+            break;
+        }
+        exec_pd(d);
+        done++;
+        if (tu.is_trapped()) {
+            if (cfg.exit_on_trap) {
+                std::cout << "Core trapped with exit_on_trap set. Exiting.\n";
+                running = false;
+            }
+            break;
+        }
+        if (bbv.is_en()) bbv.retire(pc, next_pc, sim_cnt.inst);
+        pc = next_pc;
+        sim_cnt.inst++;
+        if (mem->get_mmio_wr_cnt() != mmio_wr_cnt) break;
+    }
+    sim_cnt.step += done;
+    mem->update_mtime(done);
+}
+
+#else // THREADED_DISPATCH_EN
+// labels as values are a gnu extension
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpedantic"
+
+// each handler ends with its own copy of the dispatch, jumping straight to
+// the handler of the next instruction without returning to the loop
+#ifdef PROFILERS_EN
+#define PD_PROF_PC_CHECK \
+    if ((pc == prof_pc.start) || (pc == prof_pc.stop)) goto pd_exit;
+#else
+#define PD_PROF_PC_CHECK
+#endif
+
+#define PD_DISPATCH \
+    if (done == steps) goto pd_exit; \
+    PD_PROF_PC_CHECK \
+    d = dc.get(pc); \
+    if (d == nullptr) goto pd_exit; \
+    inst = d->inst; \
+    goto *d->handler;
+
+#define PD_RETIRE \
+    done++; \
+    if (bbv.is_en()) bbv.retire(pc, next_pc, sim_cnt.inst); \
+    pc = next_pc; \
+    sim_cnt.inst++;
+
+#define PD_OP(o) o:
+#define PD_NEXT PD_RETIRE PD_DISPATCH
+#define PD_NEXT_ST \
+    PD_RETIRE \
+    if (mem->get_mmio_wr_cnt() != mmio_wr_cnt) goto pd_exit; \
+    PD_DISPATCH
+#define PD_TRAPPED goto pd_trapped;
+
+// steps == 0 only registers the handlers with the decode cache
+void core::run_fast(uint64_t steps) {
+    // same order as pd_op_t
+    static const void* const handlers[] = {
+        &&op_add, &&op_sub, &&op_sll, &&op_srl, &&op_sra, &&op_slt, &&op_sltu,
+        &&op_xor, &&op_or, &&op_and,
+        &&op_addi, &&op_slli, &&op_srli, &&op_srai, &&op_slti, &&op_sltiu,
+        &&op_xori, &&op_ori, &&op_andi,
+        &&op_lb, &&op_lh, &&op_lw, &&op_lbu, &&op_lhu,
+        &&op_sb, &&op_sh, &&op_sw,
+        &&op_beq, &&op_bne, &&op_blt, &&op_bge, &&op_bltu, &&op_bgeu,
+        &&op_jal, &&op_jalr,
+        &&op_lui, &&op_auipc,
+        &&op_mul, &&op_mulh, &&op_mulhsu, &&op_mulhu,
+        &&op_div, &&op_divu, &&op_rem, &&op_remu,
+        &&op_max, &&op_maxu, &&op_min, &&op_minu,
+        &&fallback
+    };
+    static_assert(
+        (sizeof(handlers) / sizeof(handlers[0])) == TO_U8(pd_op_t::_count));
+    if (steps == 0) {
+        dc.set_handlers(handlers);
+        return;
+    }
+
+    tu.clear_trap();
+    uint64_t mmio_wr_cnt = mem->get_mmio_wr_cnt();
+    uint64_t done = 0;
+    const pd_inst_t* d;
+    PD_DISPATCH
+    PD_HANDLERS
+    fallback:
+        dc.unget(pc);
+        goto pd_exit;
+    pd_trapped:
+        done++;
+        if (cfg.exit_on_trap) {
+            std::cout << "Core trapped with exit_on_trap set. Exiting.\n";
+            running = false;
+        }
+    pd_exit:
+    sim_cnt.step += done;
+    mem->update_mtime(done);
+}
+
+#undef PD_PROF_PC_CHECK
+#undef PD_DISPATCH
+#undef PD_RETIRE
+#undef PD_OP
+#undef PD_NEXT
+#undef PD_NEXT_ST
+#undef PD_TRAPPED
+#pragma GCC diagnostic pop
+#endif // THREADED_DISPATCH_EN
+
+#ifdef JIT_EN
+// same as run_fast, translated blocks that fit in the horizon run as host code
+// anything else goes through run_fast one instruction at a time
+void core::run_jit(uint64_t steps) {
+    tu.clear_trap();
+    uint64_t mmio_wr_cnt = mem->get_mmio_wr_cnt();
+    uint64_t done = 0; // by translated blocks, run_fast counts its own
+    jit_exit_t ex;
+    while (steps > 0) {
+        pd_block_t* b = dc.full_block(pc);
+        if ((b == nullptr) || (b->len > steps)) {
+            // not decoded yet or too long for what's left of the horizon
+            uint64_t step = sim_cnt.step;
+            run_fast(1);
+            if ((sim_cnt.step == step) || tu.is_trapped() || !running ||
+                (mem->get_mmio_wr_cnt() != mmio_wr_cnt)) break;
+            steps--;
+            continue;
+        }
+        if (b->jit == nullptr) {
+            b->jit = jit.compile(*b);
+            if (b->jit == nullptr) { // out of space, translate again
+                jit.reset();
+                dc.flush();
+                continue;
+            }
+        }
+        reinterpret_cast<jit_block_fn>(b->jit)(&ex, rf.data(), this);
+        done += ex.retired;
+        steps -= ex.retired;
+        sim_cnt.inst += ex.retired;
+        if (ex.status == jit_status_t::trapped) { // pc is at the handler
+            done++;
+            if (cfg.exit_on_trap) {
+                std::cout << "Core trapped with exit_on_trap set. Exiting.\n";
+                running = false;
+            }
+            break;
+        }
+        pc = ex.pc;
+        if (ex.status == jit_status_t::leave) break;
+    }
+    sim_cnt.step += done;
+    mem->update_mtime(done);
+}
+
+jit_helpers_t core::jit_helpers() {
+    jit_helpers_t h;
+    h.load = {
+        &jit_load<&core::load_lb>, &jit_load<&core::load_lh>,
+        &jit_load<&core::load_lw>, &jit_load<&core::load_lbu>,
+        &jit_load<&core::load_lhu>
+    };
+    h.store = {
+        &jit_store<&core::store_sb>, &jit_store<&core::store_sh>,
+        &jit_store<&core::store_sw>
+    };
+    h.div = {
+        &jit_alu<&core::alu_div>, &jit_alu<&core::alu_divu>,
+        &jit_alu<&core::alu_rem>, &jit_alu<&core::alu_remu>
+    };
+    return h;
+}
+
+// pc and inst as the trap unit expects them, if the access traps
+template <uint32_t (core::*ld)(uint32_t)>
+uint64_t core::jit_load(core* c, uint32_t addr, uint32_t pc, uint32_t inst) {
+    c->pc = pc;
+    c->inst = inst;
+    uint32_t loaded = (c->*ld)(addr);
+    return ((TO_U64(c->tu.is_trapped()) << 32) | loaded);
+}
+
+// the block can't go on after an mmio write, e.g. to mtimecmp, or after
+// a store into decoded code, which drops the block
+template <void (core::*st)(uint32_t, uint32_t)>
+uint32_t core::jit_store(
+    core* c, uint32_t addr, uint32_t data, uint32_t pc, uint32_t inst) {
+    c->pc = pc;
+    c->inst = inst;
+    uint64_t mmio_wr_cnt = c->mem->get_mmio_wr_cnt();
+    uint64_t flush_cnt = c->dc.get_flush_cnt();
+    (c->*st)(addr, data);
+    jit_status_t status = jit_status_t::next;
+    if (c->tu.is_trapped()) {
+        status = jit_status_t::trapped;
+    } else if ((c->mem->get_mmio_wr_cnt() != mmio_wr_cnt) ||
+               (c->dc.get_flush_cnt() != flush_cnt)) {
+        status = jit_status_t::leave;
+    }
+    return TO_U32(status);
+}
+
+template <uint32_t (core::*op)(uint32_t, uint32_t)>
+uint32_t core::jit_alu(core* c, uint32_t a, uint32_t b) {
+    return (c->*op)(a, b);
+}
+#endif // JIT_EN
+#endif
+
 void core::fetch() {
     #ifdef HW_MODELS_EN
     // if previous inst was branch, use that instead of fetching
@@ -330,19 +888,61 @@ void core::exec() {
     #endif
 }
 
+#ifdef DECODE_CACHE_EN
+// same semantics as fetch + exec, on predecoded instructions
+void core::exec_pd() {
+    const pd_inst_t* d = dc.get(pc);
+    if (d == nullptr) { // can't be predecoded, let the reference path trap
+        fetch();
+        exec();
+        return;
+    }
+    exec_pd(d);
+}
+
+#define PD_OP(o) case pd_op_t::o:
+#define PD_NEXT break;
+#define PD_NEXT_ST break;
+#define PD_TRAPPED return;
+
+// one instruction, the switch is also the reference for threaded dispatch
+void core::exec_pd(const pd_inst_t* d) {
+    inst = d->inst;
+    switch (d->op) {
+        PD_HANDLERS
+        PD_OP(fallback)
+            ip.set(inst);
+            exec();
+            PD_NEXT
+        default: tu.e_unsupported_inst("predecoded op unreachable");
+    }
+}
+
+#undef PD_OP
+#undef PD_NEXT
+#undef PD_NEXT_ST
+#undef PD_TRAPPED
+#endif
+
 #ifdef DASM_EN
-void core::log_inst(bool trapped, [[maybe_unused]] bool log_symbol) {
+void core::dasm_activate() {
+    #ifdef DPI
+    dasm.en = true; // get_inst_asm() can be called after any instruction
+    #else
+    dasm.en = (logf.act && logf.txt);
+    #endif
+    #ifdef HW_MODELS_EN
+    mem->set_hwmi((dasm.en && cfg.log_hw_models) ? &hwmi : nullptr);
+    #endif
+}
+
+void core::log_inst(bool trapped) {
     if (trapped) {
-        // log changed callstack and return
         log_ofstream << dasm.asm_str << "\n";
         #ifdef DEBUG
         log_ofstream << std::flush;
         #endif
 
-        #ifdef PROFILERS_EN
-        if (log_symbol) LOG_SYMBOL_TO_FILE;
-        #endif
-
         if (cfg.exit_on_trap) running = false;
         return;
     }
@@ -375,6 +975,82 @@ void core::log_inst(bool trapped, [[maybe_unused]] bool log_symbol) {
 }
 #endif
 
+#ifdef EXEC_LOG_BIN_EN
+void core::log_bin_inst(bool trapped) {
+    if (trapped) {
+        #ifdef DASM_EN
+        if (dasm.en) {
+            exec_log.text(sim_cnt.inst, dasm.asm_str);
+            return;
+        }
+        #endif
+        // as DASM_ALIGN
+        std::string msg = dasm.asm_ss.str();
+        uint32_t iw = ((inst & 0x3) == 0x3) ? 8 : 4;
+        int32_t w = dasm_align_w(iw, TO_I32(msg.size()));
+        msg.append(TO_U32(std::max(w, 2)), ' ');
+        exec_log.text(sim_cnt.inst, msg);
+        return;
+    }
+
+    #ifdef PROFILERS_EN
+    bool cnt_en = prof_active;
+    #else
+    bool cnt_en = true;
+    #endif
+
+    #ifdef HW_MODELS_EN
+    uint8_t hm = TO_U8(TO_U32(hwrs.ic_hm) | (TO_U32(hwrs.dc_hm) << 2) |
+                       (TO_U32(hwrs.bp_hm) << 4));
+    #else
+    constexpr uint32_t none = TO_U32(hw_status_t::none);
+    uint8_t hm = TO_U8(none | (none << 2) | (none << 4));
+    #endif
+
+    // csr instructions log the csr value after the access
+    bool aux_en = (((inst & 0x7f) == 0x73) && ((inst >> 12) & 0x7));
+    uint32_t aux = 0;
+    if (aux_en) aux = csr.at(TO_U16(inst >> 20)).value;
+
+    exec_log.inst(sim_cnt.inst, cnt_en, pc, inst, rf, hm, aux_en, aux);
+}
+
+// what the renderer can't get from the instructions
+std::string core::exec_log_meta() {
+    std::ostringstream ss;
+    ss << "{\"csrs\": {";
+    bool first = true;
+    for (const auto &c : csr_def::supported_csrs) {
+        ss << (first ? "" : ", ") << "\"" << c.addr << "\": \"" << c.name
+           << "\"";
+        first = false;
+    }
+    ss << "}, \"rf_names\": \""
+       << ((cfg.rf_names == rf_names_t::mode_abi) ? "abi" : "x") << "\""
+       << ", \"uart_tx\": " << mem_map::uart0_tx_data_addr
+       << ", \"uart_rx\": " << mem_map::uart0_rx_data_addr
+       << ", \"hw_models\": "
+       #ifdef HW_MODELS_EN
+       << "true"
+       #else
+       << "false"
+       #endif
+       << "}";
+    return ss.str();
+}
+#endif
+
+#if defined(PROFILERS_EN) && defined(EXEC_LOG_EN)
+void core::log_callstack() {
+    #ifdef DASM_EN
+    if (logf.txt) LOG_SYMBOL_TO_FILE;
+    #endif
+    #ifdef EXEC_LOG_BIN_EN
+    if (logf.bin) exec_log.text(sim_cnt.inst, prof_perf.get_callstack_str());
+    #endif
+}
+#endif
+
 void core::finish(bool dump_regs) {
     if (dump_regs) dump();
     if ((cfg.mem_dump_start > 0) && (cfg.mem_dump_size > 0)) {
@@ -388,19 +1064,20 @@ void core::finish(bool dump_regs) {
     #endif
     #ifdef HW_MODELS_EN
     #ifdef PROFILERS_EN
-    bp.finish(cfg.out_dir, prof_pc.inst_cnt, cfg.prof_show);
-    mem->cache_finish(cfg.prof_show, prof_pc.inst_cnt);
-    div.finish(cfg.prof_show);
+    finish_hw(prof_pc.inst_cnt); // profiled inst, depending on triggers
     #else
-    bp.finish(cfg.out_dir, sim_cnt.inst, cfg.prof_show);
-    mem->cache_finish(cfg.prof_show, sim_cnt.inst);
-    div.finish(cfg.prof_show);
+    finish_hw(sim_cnt.inst); // app profiled from boot
     #endif
-    log_hw_stats();
     #endif
     #ifdef DASM_EN
     log_ofstream << std::endl; // flush
     #endif
+    #ifdef EXEC_LOG_BIN_EN
+    if (logf.bin) {
+        exec_log.text(sim_cnt.inst, ""); // as the text log's last line
+        exec_log.finish();
+    }
+    #endif
 }
 
 // profiler-related
@@ -416,20 +1093,84 @@ void core::prof_state([[maybe_unused]] bool enable) {
     #endif
     #endif
 
-    #ifdef DASM_EN
+    #ifdef EXEC_LOG_EN
     logf.activate(enable);
+    #ifdef DASM_EN
+    dasm_activate();
+    #endif
+    #ifdef EXEC_LOG_BIN_EN
+    if (logf.act && logf.bin) exec_log.resume(rf); // rf changed meanwhile
+    #endif
     #ifdef PROFILERS_EN
-    if (logf.act && prof_perf.is_callstack_en()) LOG_SYMBOL_TO_FILE;
+    if (logf.act && prof_perf.is_callstack_en()) log_callstack();
     #endif
     #endif
 
     #ifdef HW_MODELS_EN
+    hw_prof_state(enable);
+    #endif
+}
+
+#ifdef HW_MODELS_EN
+void core::hw_prof_state(bool enable) {
+    if (hw_trace.is_en()) hw_trace.state(hw_trace_ev_t::prof, enable);
     bp.profiling(enable);
     div.profiling(enable);
     mem->cache_profiling(enable);
     hwrs.rst();
-    #endif
 }
+#endif
+
+#if defined(PROFILERS_EN) && defined(HW_MODELS_EN)
+void core::smarts_init() {
+    smarts.init(cfg.smarts_period, cfg.smarts_unit, cfg.out_dir, sim_cnt.inst);
+    // counters in the same order as in smarts_counters
+    size_t insts = smarts.add_counter("insts");
+    const std::array<std::string, 3> hw = {"icache", "dcache", "bp"};
+    for (const auto& h : hw) {
+        size_t ref = smarts.add_counter(h + "_ref");
+        size_t miss = smarts.add_counter(h + "_miss");
+        smarts.add_metric(h + "_miss_rate", miss, ref, 100.0);
+        smarts.add_metric(h + "_mpki", miss, insts, 1000.0);
+    }
+    // perf events are collected along with the callstack
+    if (!prof_perf.is_callstack_en()) return;
+    for (const auto& e : cfg.perf_events) {
+        if (e == perf_event_t::ret_inst) continue; // 1 per inst
+        const std::string& name = perf_event_names[TO_U32(e)];
+        size_t ev = smarts.add_counter(name);
+        smarts.add_metric(name + "_pki", ev, insts, 1000.0);
+    }
+}
+
+std::vector<uint64_t> core::smarts_counters() {
+    cache_cnt_t ic = mem->icache_cnt();
+    cache_cnt_t dc = mem->dcache_cnt();
+    std::vector<uint64_t> cnt = {
+        sim_cnt.inst,
+        ic.references, ic.misses,
+        dc.references, dc.misses,
+        bp.get_branches(), bp.get_mispredicted()
+    };
+    if (!prof_perf.is_callstack_en()) return cnt;
+    for (const auto& e : cfg.perf_events) {
+        if (e == perf_event_t::ret_inst) continue;
+        cnt.push_back(prof_perf.get_event_total(e));
+    }
+    return cnt;
+}
+
+void core::smarts_toggle() {
+    // warming keeps HW models updated, only stats and profilers are off
+    if (smarts.unit_active()) {
+        smarts.end_unit(smarts_counters());
+        prof_state(false);
+    } else {
+        prof_state(true);
+        smarts.begin_unit(smarts_counters());
+    }
+}
+#endif
 
 #if defined(PROFILERS_EN) && !defined(DPI)
 void core::save_trace_entry() {
@@ -512,8 +1253,10 @@ void core::d_alu_reg() {
     }
     next_pc = pc + 4;
     #ifdef DASM_EN
-    DASM_OP_RD << "," << DASM_OP_RS1 << "," << DASM_OP_RS2;
-    DASM_RD_UPDATE;
+    if (dasm.en) {
+        DASM_OP_RD << "," << DASM_OP_RS1 << "," << DASM_OP_RS2;
+        DASM_RD_UPDATE;
+    }
     #endif
 }
 
@@ -536,13 +1279,15 @@ void core::d_alu_imm() {
     }
     next_pc = pc + 4;
     #ifdef DASM_EN
-    DASM_OP_RD << "," << DASM_OP_RS1 << ",";
-    if (is_shift) dasm.asm_ss << FHEXN(ip.imm_i_shamt(), 2);
-    else dasm.asm_ss << TO_I32(ip.imm_i());
-    DASM_RD_UPDATE;
-    if (inst == inst::nop) {
-        dasm.clear_str();
-        dasm.asm_ss << "nop";
+    if (dasm.en) {
+        DASM_OP_RD << "," << DASM_OP_RS1 << ",";
+        if (is_shift) dasm.asm_ss << FHEXN(ip.imm_i_shamt(), 2);
+        else dasm.asm_ss << TO_I32(ip.imm_i());
+        DASM_RD_UPDATE;
+        if (inst == inst::nop) {
+            dasm.clear_str();
+            dasm.asm_ss << "nop";
+        }
     }
     #endif
 }
@@ -568,11 +1313,13 @@ void core::d_load() {
     PROF_SET_PERF_EVENT_MEM_LOAD
     #endif
     #ifdef DASM_EN
-    DASM_OP_RD << "," << TO_I32(ip.imm_i()) << "(" << DASM_OP_RS1 << ")";
-    DASM_RD_UPDATE;
-    if (ip.rd()) {
-        dasm.asm_ss << " <- mem["
-                    << MEM_ADDR_FORMAT(TO_I32(ip.imm_i()) + rs1) << "]";
+    if (dasm.en) {
+        DASM_OP_RD << "," << TO_I32(ip.imm_i()) << "(" << DASM_OP_RS1 << ")";
+        DASM_RD_UPDATE;
+        if (ip.rd()) {
+            dasm.asm_ss << " <- mem["
+                        << MEM_ADDR_FORMAT(TO_I32(ip.imm_i()) + rs1) << "]";
+        }
     }
     #endif
 }
@@ -591,9 +1338,11 @@ void core::d_store() {
     #endif
     next_pc = pc + 4;
     #ifdef DASM_EN
-    dasm.asm_ss << dasm.op << " " << DASM_OP_RS2 << "," << TO_I32(ip.imm_s())
-                << "(" << DASM_OP_RS1 << ")";
-    DASM_MEM_UPDATE;
+    if (dasm.en) {
+        dasm.asm_ss << dasm.op << " " << DASM_OP_RS2 << ","
+                    << TO_I32(ip.imm_s()) << "(" << DASM_OP_RS1 << ")";
+        DASM_MEM_UPDATE;
+    }
     #endif
 }
 
@@ -627,8 +1376,10 @@ void core::d_branch() {
     #endif
 
     #ifdef DASM_EN
-    dasm.asm_ss << dasm.op << " " << DASM_OP_RS1 << "," << DASM_OP_RS2 << ","
-                << std::hex << pc + TO_I32(ip.imm_b()) << std::dec;
+    if (dasm.en) {
+        dasm.asm_ss << dasm.op << " " << DASM_OP_RS1 << "," << DASM_OP_RS2
+                    << "," << std::hex << pc + TO_I32(ip.imm_b()) << std::dec;
+    }
     #endif
 
     #ifdef HW_MODELS_EN
@@ -638,6 +1389,12 @@ void core::d_branch() {
     bp.ideal(next_pc);
 
     uint32_t speculative_next_pc = bp.predict(pc, ip.imm_b(), ip.funct3());
+    if (hw_trace.is_en()) {
+        // fetches below depend on the predictor, redone on replay
+        hw_trace.branch(
+            to_norm(pc), TO_I32(ip.imm_b()), ip.funct3(), to_norm(next_pc));
+        hw_trace.hold(true);
+    }
     if (!no_bp) { // not going to icache in case there is no bp, stall instead
         //mem->speculative_exec(speculative_t::enter);
         inst_speculative = mem->rd_inst(speculative_next_pc);
@@ -665,11 +1422,14 @@ void core::d_branch() {
         inst_resolved = inst_speculative;
     }
 
+    hw_trace.hold(false);
     hwrs.bp_hm = static_cast<hw_status_t>(correct);
     hwrs.ic_hm = save_ic_hm;
 
     #ifdef DASM_EN
-    hwmi.log_bp({bp_name, b_dir_t::forward, correct, taken});
+    if (dasm.en && cfg.log_hw_models) {
+        hwmi.log_bp({bp_name, b_dir_t::forward, correct, taken});
+    }
     #endif
 
     #endif // HW_MODELS_EN
@@ -696,9 +1456,11 @@ void core::d_jalr() {
     #endif
 
     #ifdef DASM_EN
-    DASM_OP_RD << "," << TO_I32(ip.imm_i()) << "(" << DASM_OP_RS1 << ")";
-    if (ret_inst) dasm.asm_ss << " # ret";
-    DASM_RD_UPDATE;
+    if (dasm.en) {
+        DASM_OP_RD << "," << TO_I32(ip.imm_i()) << "(" << DASM_OP_RS1 << ")";
+        if (ret_inst) dasm.asm_ss << " # ret";
+        DASM_RD_UPDATE;
+    }
     #endif
 }
 
@@ -717,8 +1479,10 @@ void core::d_jal() {
     #endif
 
     #ifdef DASM_EN
-    DASM_OP_RD << "," << std::hex <<( pc + TO_I32(ip.imm_j())) << std::dec;
-    DASM_RD_UPDATE;
+    if (dasm.en) {
+        DASM_OP_RD << "," << std::hex <<( pc + TO_I32(ip.imm_j())) << std::dec;
+        DASM_RD_UPDATE;
+    }
     #endif
 }
 
@@ -729,8 +1493,10 @@ void core::d_lui() {
     PROF_G(lui)
     PROF_RD
     #ifdef DASM_EN
-    DASM_OP_RD << ", " << FHEXN((ip.imm_u() >> 12), 5);
-    DASM_RD_UPDATE;
+    if (dasm.en) {
+        DASM_OP_RD << ", " << FHEXN((ip.imm_u() >> 12), 5);
+        DASM_RD_UPDATE;
+    }
     #endif
 }
 
@@ -741,8 +1507,10 @@ void core::d_auipc() {
     PROF_G(auipc)
     PROF_RD
     #ifdef DASM_EN
-    DASM_OP_RD << ", " << FHEXN((ip.imm_u() >> 12), 5);
-    DASM_RD_UPDATE;
+    if (dasm.en) {
+        DASM_OP_RD << ", " << FHEXN((ip.imm_u() >> 12), 5);
+        DASM_RD_UPDATE;
+    }
     #endif
 }
 
@@ -776,14 +1544,17 @@ void core::d_system() {
             default: tu.e_unsupported_inst("system");
         }
         #ifdef DASM_EN
-        dasm.asm_ss << dasm.op;
+        if (dasm.en) dasm.asm_ss << dasm.op;
         #endif
     }
 }
 
 void core::d_misc_mem() {
     if (inst == inst::fence_i) {
-        // nop
+        // nop, other than dropping predecoded instructions
+        #ifdef DECODE_CACHE_EN
+        dc.flush();
+        #endif
         next_pc = pc + 4;
         DASM_OP(fence.i)
         PROF_G(fence_i)
@@ -796,7 +1567,7 @@ void core::d_misc_mem() {
         tu.e_unsupported_inst("misc_mem");
     }
     #ifdef DASM_EN
-    dasm.asm_ss << dasm.op;
+    if (dasm.en) dasm.asm_ss << dasm.op;
     #endif
 }
 
@@ -989,57 +1760,59 @@ void core::d_custom_ext() {
     }
 
     #ifdef DASM_EN
-    switch(funct7) {
-        case TO_U8(custom_op_t::type_alu):
-        case TO_U8(custom_op_t::type_qalu):
-        case TO_U8(custom_op_t::type_mul):
-        case TO_U8(custom_op_t::type_dot):
-        case TO_U8(custom_op_t::type_min_max):
-        case TO_U8(custom_op_t::type_data_fmt_narrow):
-        case TO_U8(custom_op_t::type_data_fmt_qnarrow):
-            DASM_OP_RD << "," << DASM_OP_RS1 << "," << DASM_OP_RS2;
-            DASM_RD_UPDATE;
-            break;
-        case TO_U8(custom_op_t::type_shift):
-            DASM_OP_RD << "," << DASM_OP_RS1 << "," FHEXN(ip.rs2(), 2);
-            DASM_RD_UPDATE;
-            break;
-        case TO_U8(custom_op_t::type_wmul):
-        case TO_U8(custom_op_t::type_data_fmt_txp):
-            DASM_OP_RD << "," << DASM_OP_RS1 << "," << DASM_OP_RS2;
-            DASM_RD_UPDATE;
-            DASM_RD_UPDATE_PAIR;
-            break;
-        case TO_U8(custom_op_t::type_data_fmt_widen):
-            DASM_OP_RD << "," << DASM_OP_RS1 << "," FHEXN(ip.rs2(), 2);
-            DASM_RD_UPDATE;
-            DASM_RD_UPDATE_PAIR;
-            break;
-        case TO_U8(custom_op_t::type_sv_dup_vins):
-            DASM_OP_RD << "," << DASM_OP_RS1;
-            if (funct3 & 0x1) {
-                // lsb set, vins (fn3 1,3,5,7 -> 1,2,3,4 bit mask)
-                static const uint32_t vins_lane_mask[] = {
-                    0x1u, 0x3u, 0x7u, 0xfu };
-                uint32_t imm = (ip.rs2() & vins_lane_mask[funct3 >> 1]);
-                dasm.asm_ss << "," << FHEXN(imm, 1);
-            }
-            DASM_RD_UPDATE;
-            break;
-        case TO_U8(custom_op_t::type_sv_vext):
-            {
-                // vext: fn3 0,1->16-bit; 2,3->8-bit; 4,5->4-bit; 6,7->2-bit
-                static const uint32_t vext_lane_mask[] = {
-                    0x1u, 0x3u, 0x7u, 0xfu };
-                uint32_t imm = (ip.rs2() & vext_lane_mask[funct3 >> 1]);
-                DASM_OP_RD << "," << DASM_OP_RS1 << "," << FHEXN(imm, 1);
+    if (dasm.en) {
+        switch(funct7) {
+            case TO_U8(custom_op_t::type_alu):
+            case TO_U8(custom_op_t::type_qalu):
+            case TO_U8(custom_op_t::type_mul):
+            case TO_U8(custom_op_t::type_dot):
+            case TO_U8(custom_op_t::type_min_max):
+            case TO_U8(custom_op_t::type_data_fmt_narrow):
+            case TO_U8(custom_op_t::type_data_fmt_qnarrow):
+                DASM_OP_RD << "," << DASM_OP_RS1 << "," << DASM_OP_RS2;
                 DASM_RD_UPDATE;
-            }
-            break;
-        case TO_U8(custom_op_t::type_hints):
-            DASM_OP_RD << "," << DASM_OP_RS1;
-            DASM_RD_UPDATE;
-            break;
+                break;
+            case TO_U8(custom_op_t::type_shift):
+                DASM_OP_RD << "," << DASM_OP_RS1 << "," FHEXN(ip.rs2(), 2);
+                DASM_RD_UPDATE;
+                break;
+            case TO_U8(custom_op_t::type_wmul):
+            case TO_U8(custom_op_t::type_data_fmt_txp):
+                DASM_OP_RD << "," << DASM_OP_RS1 << "," << DASM_OP_RS2;
+                DASM_RD_UPDATE;
+                DASM_RD_UPDATE_PAIR;
+                break;
+            case TO_U8(custom_op_t::type_data_fmt_widen):
+                DASM_OP_RD << "," << DASM_OP_RS1 << "," FHEXN(ip.rs2(), 2);
+                DASM_RD_UPDATE;
+                DASM_RD_UPDATE_PAIR;
+                break;
+            case TO_U8(custom_op_t::type_sv_dup_vins):
+                DASM_OP_RD << "," << DASM_OP_RS1;
+                if (funct3 & 0x1) {
+                    // lsb set, vins (fn3 1,3,5,7 -> 1,2,3,4 bit mask)
+                    static const uint32_t vins_lane_mask[] = {
+                        0x1u, 0x3u, 0x7u, 0xfu };
+                    uint32_t imm = (ip.rs2() & vins_lane_mask[funct3 >> 1]);
+                    dasm.asm_ss << "," << FHEXN(imm, 1);
+                }
+                DASM_RD_UPDATE;
+                break;
+            case TO_U8(custom_op_t::type_sv_vext):
+                {
+                    // vext: fn3 0,1->16-bit; 2,3->8-bit; 4,5->4-bit; 6,7->2-bit
+                    static const uint32_t vext_lane_mask[] = {
+                        0x1u, 0x3u, 0x7u, 0xfu };
+                    uint32_t imm = (ip.rs2() & vext_lane_mask[funct3 >> 1]);
+                    DASM_OP_RD << "," << DASM_OP_RS1 << "," << FHEXN(imm, 1);
+                    DASM_RD_UPDATE;
+                }
+                break;
+            case TO_U8(custom_op_t::type_hints):
+                DASM_OP_RD << "," << DASM_OP_RS1;
+                DASM_RD_UPDATE;
+                break;
+        }
     }
     #endif
     next_pc = pc + 4;
@@ -1082,12 +1855,14 @@ void core::d_csr_access() {
     }
 
     #ifdef DASM_EN
-    bool imm_type = (ip.funct3() & 0x4);
-    DASM_RD_UPDATE;
-    if (ip.rs1() || imm_type) {
-        if (ip.rd()) dasm.asm_ss << "; ";
-        DASM_ALIGN;
-        dasm.asm_ss << CSRF(it);
+    if (dasm.en) {
+        bool imm_type = (ip.funct3() & 0x4);
+        DASM_RD_UPDATE;
+        if (ip.rs1() || imm_type) {
+            if (ip.rd()) dasm.asm_ss << "; ";
+            DASM_ALIGN;
+            dasm.asm_ss << CSRF(it);
+        }
     }
     if (logf.state) dasm_update_csr = true;
     #endif
@@ -1173,25 +1948,24 @@ void core::d_compressed_2() {
 
 // HW stats
 #ifdef HW_MODELS_EN
-void core::log_hw_stats() {
+void core::finish_hw(uint64_t profiled_insts) {
+    if (hw_trace.is_en()) hw_trace.finish(profiled_insts);
+    bp.finish(cfg.out_dir, profiled_insts, cfg.prof_show);
+    mem->cache_finish(cfg.prof_show, profiled_insts);
+    div.finish(cfg.prof_show);
+    log_hw_stats(profiled_insts);
+}
+
+void core::log_hw_stats(uint64_t profiled_insts) {
     std::ofstream ofs;
     ofs.open(cfg.out_dir + "hw_stats.json");
     ofs << "{\n";
-    #ifdef PROFILERS_EN
-    mem->log_cache_stats(ofs, prof_pc.inst_cnt);
-    #else
-    mem->log_cache_stats(ofs, sim_cnt.inst);
-    #endif
+    mem->log_cache_stats(ofs, profiled_insts);
     bp.log_stats(ofs);
     div.log_stats("divider", ofs);
-    ofs << "\n\"profiled_inst\": "
-    #ifdef PROFILERS_EN
-    << prof_pc.inst_cnt // profiled inst, depending on settings/triggers
-    #else
-    << sim_cnt.inst // app profiled from boot
-    #endif
-    << "\n}\n";
+    ofs << "\n\"profiled_inst\": " << profiled_insts << "\n}\n";
     ofs.close();
+    mem->log_stack_dist(cfg.out_dir);
 }
 #endif
 
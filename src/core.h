@@ -6,6 +6,8 @@
 #include "memory.h"
 #include "inst_parser.h"
 #include "trap.h"
+#include "checkpoint.h"
+#include "async_out.h"
 
 #ifdef PROFILERS_EN
 #include "profiler.h"
@@ -17,23 +19,72 @@
 #ifdef HW_MODELS_EN
 #include "bp_if.h"
 #include "divider.h"
+#include "hw_trace.h"
 #endif
 
 #ifdef DPI
 #include "cosim.h"
 #endif
 
+#ifdef DECODE_CACHE_EN
+#include "decode_cache.h"
+#endif
+
+#ifdef JIT_EN
+#include "jit.h"
+#endif
+
+#ifndef DPI
+#include "bbv.h"
+#endif
+
+#ifdef EXEC_LOG_BIN_EN
+#include "exec_log.h"
+#endif
+
+#if defined(PROFILERS_EN) && defined(HW_MODELS_EN)
+#include "smarts.h"
+#endif
+
 class core {
     public:
         core() = delete;
         core(memory* mem, cfg_t cfg, hw_cfg_t hw_cfg);
         uint64_t run();
+        #if defined(HW_MODELS_EN) && !defined(DPI)
+        uint64_t replay(std::string path);
+        #endif
         void single_step();
         bool check_interrupts(bool defer_trap);
+        #ifndef DPI
+        void wfi_fast_forward();
+        void save_ckpt(std::string path);
+        void restore_ckpt(std::string path);
+        #endif
         void fetch();
         void exec();
+        #ifdef DECODE_CACHE_EN
+        #ifdef PROFILERS_EN
+        void end_fast_forward();
+        #endif
+        uint64_t event_horizon();
+        void run_fast(uint64_t steps);
+        #ifdef JIT_EN
+        void run_jit(uint64_t steps);
+        #endif
+        void exec_pd();
+        void exec_pd(const pd_inst_t* d);
+        #endif
         #ifdef DASM_EN
-        void log_inst(bool trapped, bool log_symbol);
+        void dasm_activate();
+        void log_inst(bool trapped);
+        #endif
+        #ifdef EXEC_LOG_BIN_EN
+        void log_bin_inst(bool trapped);
+        std::string exec_log_meta();
+        #endif
+        #if defined(PROFILERS_EN) && defined(EXEC_LOG_EN)
+        void log_callstack();
         #endif
         void dump();
         std::string print_state(bool dump_csr);
@@ -139,6 +190,11 @@ class core {
         }
 
         void prof_state(bool enable);
+        #if defined(PROFILERS_EN) && defined(HW_MODELS_EN)
+        void smarts_init();
+        void smarts_toggle();
+        std::vector<uint64_t> smarts_counters();
+        #endif
 
         #ifndef DPI
         void save_trace_entry();
@@ -238,6 +294,19 @@ class core {
         static void trap_state_update_cb( // callback for trap handler
             void* ctx, uint32_t cause, uint32_t tval);
 
+        #ifdef JIT_EN
+        // called from translated blocks, see jit.h
+        static jit_helpers_t jit_helpers();
+        template <uint32_t (core::*ld)(uint32_t)>
+        static uint64_t jit_load(
+            core* c, uint32_t addr, uint32_t pc, uint32_t inst);
+        template <void (core::*st)(uint32_t, uint32_t)>
+        static uint32_t jit_store(
+            core* c, uint32_t addr, uint32_t data, uint32_t pc, uint32_t inst);
+        template <uint32_t (core::*op)(uint32_t, uint32_t)>
+        static uint32_t jit_alu(core* c, uint32_t a, uint32_t b);
+        #endif
+
         #ifdef SIMD_EN
         // custom extension - arithmetic add & sub
         uint32_t alu_c_add16(uint32_t a, uint32_t b);
@@ -410,7 +479,9 @@ class core {
         #endif // SIMD_EN
 
         #ifdef HW_MODELS_EN
-        void log_hw_stats();
+        void hw_prof_state(bool enable);
+        void finish_hw(uint64_t profiled_insts);
+        void log_hw_stats(uint64_t profiled_insts);
         #endif
 
     private:
@@ -436,6 +507,28 @@ class core {
         uint8_t rf_names_w;
         uint8_t csr_names_w;
         std::string out_dir;
+        #ifdef DECODE_CACHE_EN
+        decode_cache dc;
+        #ifdef JIT_EN
+        jit_x64 jit;
+        #endif
+        #if defined(PROFILERS_EN) || defined(HW_MODELS_EN) || defined(DASM_EN)
+        bool fast_path = false; // only while fast-forwarding to prof start
+        #else
+        static constexpr bool fast_path = true;
+        #endif
+        #endif
+        #ifndef DPI
+        bbv_collector bbv;
+        #endif
+        // profilers, dasm and logs follow execution, i.e. not fast-forwarding
+        bool detailed() const {
+            #ifdef DECODE_CACHE_EN
+            return !fast_path;
+            #else
+            return true;
+            #endif
+        }
 
         #ifdef PROFILERS_EN
         prof_pc_t prof_pc;
@@ -446,6 +539,10 @@ class core {
         profiler_fusion prof_fusion;
         profiler_rf prof_rf;
         bool branch_taken;
+        uint64_t prof_inst_start; // profiling starts at this inst count, if set
+        #ifdef HW_MODELS_EN
+        smarts_sampler smarts;
+        #endif
         #ifdef DPI
         clock_source_t clk_src;
         #endif
@@ -505,15 +602,21 @@ class core {
         bool no_bp;
         hw_status_t next_ic_hm;
         hw_running_stats_t hwrs;
+        hw_trace_out hw_trace;
         #endif
 
         #ifdef DASM_EN
-        std::ofstream log_ofstream;
+        async_ofstream log_ofstream;
         bool dasm_update_csr = false;
-        dasm_str dasm;
         hwmi_str hwmi;
+        #endif
+        #ifdef EXEC_LOG_EN
+        dasm_str dasm; // trap messages only, without DASM_EN
         logging_flags_t logf;
         #endif
+        #ifdef EXEC_LOG_BIN_EN
+        exec_log_out exec_log;
+        #endif
 
         static constexpr std::array<std::array<std::string_view, 2>, 32>
         rf_names = {{
@@ -14,8 +14,10 @@ void core::c_addi() {
     PROF_C_RS1_RD
     PROF_RD_ZERO(res)
     #ifdef DASM_EN
-    DASM_OP_RD << "," << TO_I32(ip.c_imm_arith());
-    DASM_RD_UPDATE;
+    if (dasm.en) {
+        DASM_OP_RD << "," << TO_I32(ip.c_imm_arith());
+        DASM_RD_UPDATE;
+    }
     #endif
     next_pc = pc + 2;
 }
@@ -29,8 +31,10 @@ void core::c_li() {
     PROF_RD
     PROF_RD_ZERO(res)
     #ifdef DASM_EN
-    DASM_OP_RD << "," << TO_I32(ip.c_imm_arith());
-    DASM_RD_UPDATE;
+    if (dasm.en) {
+        DASM_OP_RD << "," << TO_I32(ip.c_imm_arith());
+        DASM_RD_UPDATE;
+    }
     #endif
     next_pc = pc + 2;
 }
@@ -43,8 +47,10 @@ void core::c_lui() {
     PROF_G(c_lui)
     PROF_RD
     #ifdef DASM_EN
-    DASM_OP_RD << "," << FHEXN((ip.c_imm_lui() >> 12), 5);
-    DASM_RD_UPDATE;
+    if (dasm.en) {
+        DASM_OP_RD << "," << FHEXN((ip.c_imm_lui() >> 12), 5);
+        DASM_RD_UPDATE;
+    }
     #endif
     next_pc = pc + 2;
 }
@@ -54,7 +60,7 @@ void core::c_nop() {
     DASM_OP(c.nop)
     PROF_G(c_nop)
     #ifdef DASM_EN
-    dasm.asm_ss << dasm.op;
+    if (dasm.en) dasm.asm_ss << dasm.op;
     #endif
     next_pc = pc + 2;
 }
@@ -70,8 +76,10 @@ void core::c_addi16sp() {
     PROF_C_RS1_LIT(2)
     PROF_RD_ZERO(res)
     #ifdef DASM_EN
-    DASM_OP_RD << "," << TO_I32(ip.c_imm_16sp());
-    DASM_RD_UPDATE_P(2);
+    if (dasm.en) {
+        DASM_OP_RD << "," << TO_I32(ip.c_imm_16sp());
+        DASM_RD_UPDATE_P(2);
+    }
     #endif
     next_pc = pc + 2;
 }
@@ -86,8 +94,10 @@ void core::c_srli() {
     PROF_C_RS1_REGH
     PROF_RD_ZERO(res)
     #ifdef DASM_EN
-    DASM_OP_CREGH << "," << TO_I32(ip.c_imm_arith());
-    DASM_RD_UPDATE_P(ip.c_regh());
+    if (dasm.en) {
+        DASM_OP_CREGH << "," << TO_I32(ip.c_imm_arith());
+        DASM_RD_UPDATE_P(ip.c_regh());
+    }
     #endif
     next_pc = pc + 2;
 }
@@ -102,8 +112,10 @@ void core::c_srai() {
     PROF_C_RS1_REGH
     PROF_RD_ZERO(res)
     #ifdef DASM_EN
-    DASM_OP_CREGH << "," << TO_I32(ip.c_imm_arith());
-    DASM_RD_UPDATE_P(ip.c_regh());
+    if (dasm.en) {
+        DASM_OP_CREGH << "," << TO_I32(ip.c_imm_arith());
+        DASM_RD_UPDATE_P(ip.c_regh());
+    }
     #endif
     next_pc = pc + 2;
 }
@@ -118,8 +130,10 @@ void core::c_andi() {
     PROF_C_RS1_REGH
     PROF_RD_ZERO(res)
     #ifdef DASM_EN
-    DASM_OP_CREGH << "," << TO_I32(ip.c_imm_arith());
-    DASM_RD_UPDATE_P(ip.c_regh());
+    if (dasm.en) {
+        DASM_OP_CREGH << "," << TO_I32(ip.c_imm_arith());
+        DASM_RD_UPDATE_P(ip.c_regh());
+    }
     #endif
     next_pc = pc + 2;
 }
@@ -135,8 +149,10 @@ void core::c_and() {
     PROF_C_RS2_REGL
     PROF_RD_ZERO(res)
     #ifdef DASM_EN
-    DASM_OP_CREGH << "," << DASM_CREGL;
-    DASM_RD_UPDATE_P(ip.c_regh());
+    if (dasm.en) {
+        DASM_OP_CREGH << "," << DASM_CREGL;
+        DASM_RD_UPDATE_P(ip.c_regh());
+    }
     #endif
     next_pc = pc + 2;
 }
@@ -152,8 +168,10 @@ void core::c_or() {
     PROF_C_RS2_REGL
     PROF_RD_ZERO(res)
     #ifdef DASM_EN
-    DASM_OP_CREGH << "," << DASM_CREGL;
-    DASM_RD_UPDATE_P(ip.c_regh());
+    if (dasm.en) {
+        DASM_OP_CREGH << "," << DASM_CREGL;
+        DASM_RD_UPDATE_P(ip.c_regh());
+    }
     #endif
     next_pc = pc + 2;
 }
@@ -169,8 +187,10 @@ void core::c_xor() {
     PROF_C_RS2_REGL
     PROF_RD_ZERO(res)
     #ifdef DASM_EN
-    DASM_OP_CREGH << "," << DASM_CREGL;
-    DASM_RD_UPDATE_P(ip.c_regh());
+    if (dasm.en) {
+        DASM_OP_CREGH << "," << DASM_CREGL;
+        DASM_RD_UPDATE_P(ip.c_regh());
+    }
     #endif
     next_pc = pc + 2;
 }
@@ -186,8 +206,10 @@ void core::c_sub() {
     PROF_C_RS2_REGL
     PROF_RD_ZERO(res)
     #ifdef DASM_EN
-    DASM_OP_CREGH << "," << DASM_CREGL;
-    DASM_RD_UPDATE_P(ip.c_regh());
+    if (dasm.en) {
+        DASM_OP_CREGH << "," << DASM_CREGL;
+        DASM_RD_UPDATE_P(ip.c_regh());
+    }
     #endif
     next_pc = pc + 2;
 }
@@ -204,9 +226,11 @@ void core::c_addi4spn() {
     PROF_C_RS1_LIT(2)
     PROF_RD_ZERO(res)
     #ifdef DASM_EN
-    dasm.asm_ss << dasm.op << " " << DASM_CREGL << ",x2,"
-                << TO_I32(ip.c_imm_4spn());
-    DASM_RD_UPDATE_P(ip.c_regl());
+    if (dasm.en) {
+        dasm.asm_ss << dasm.op << " " << DASM_CREGL << ",x2,"
+                    << TO_I32(ip.c_imm_4spn());
+        DASM_RD_UPDATE_P(ip.c_regl());
+    }
     #endif
     next_pc = pc + 2;
 }
@@ -224,8 +248,10 @@ void core::c_slli() {
     prof_fusion.attack({trigger::slli_lea, inst, mem->just_inst(pc + 2), true});
     #endif
     #ifdef DASM_EN
-    DASM_OP_RD << "," << FHEXN(TO_I32(ip.c_imm_slli()), 2);
-    DASM_RD_UPDATE;
+    if (dasm.en) {
+        DASM_OP_RD << "," << FHEXN(TO_I32(ip.c_imm_slli()), 2);
+        DASM_RD_UPDATE;
+    }
     #endif
     next_pc = pc + 2;
 }
@@ -240,8 +266,10 @@ void core::c_mv() {
     PROF_C_RS2_RS2
     PROF_RD_ZERO(res)
     #ifdef DASM_EN
-    DASM_OP_RD << "," << rf_names[ip.c_rs2()][rf_names_idx];
-    DASM_RD_UPDATE;
+    if (dasm.en) {
+        DASM_OP_RD << "," << rf_names[ip.c_rs2()][rf_names_idx];
+        DASM_RD_UPDATE;
+    }
     #endif
     next_pc = pc + 2;
 }
@@ -257,8 +285,10 @@ void core::c_add() {
     PROF_C_RS2_RS2
     PROF_RD_ZERO(res)
     #ifdef DASM_EN
-    DASM_OP_RD << "," << rf_names[ip.c_rs2()][rf_names_idx];
-    DASM_RD_UPDATE;
+    if (dasm.en) {
+        DASM_OP_RD << "," << rf_names[ip.c_rs2()][rf_names_idx];
+        DASM_RD_UPDATE;
+    }
     #endif
     next_pc = pc + 2;
 }
@@ -277,23 +307,28 @@ void core::c_lw() {
     PROF_RD_ZERO(loaded)
     #ifdef PROFILERS_EN
     prof.log_stack_access_load((rs1 + ip.c_imm_mem()) > TO_U32(rf[2]));
+    prof_perf.set_dmem(rs1 + ip.c_imm_mem());
     PROF_SET_PERF_EVENT_MEM
     PROF_SET_PERF_EVENT_MEM_LOAD
     #endif
     #ifdef DASM_EN
-    dasm.asm_ss << dasm.op << " " << DASM_CREGL << "," << TO_I32(ip.c_imm_mem())
-                << "(" << rf_names[ip.c_regh()][rf_names_idx] << ")";
-    DASM_RD_UPDATE_P(ip.c_regl());
-    if (ip.rd()) {
-        dasm.asm_ss << " <- mem["
-                    << MEM_ADDR_FORMAT(TO_I32(ip.c_imm_mem()) + rs1) << "]";
+    if (dasm.en) {
+        dasm.asm_ss << dasm.op << " " << DASM_CREGL << ","
+                    << TO_I32(ip.c_imm_mem())
+                    << "(" << rf_names[ip.c_regh()][rf_names_idx] << ")";
+        DASM_RD_UPDATE_P(ip.c_regl());
+        if (ip.rd()) {
+            dasm.asm_ss << " <- mem["
+                        << MEM_ADDR_FORMAT(TO_I32(ip.c_imm_mem()) + rs1) << "]";
+        }
     }
     #endif
     next_pc = pc + 2;
 }
 
 void core::c_lwsp() {
-    uint32_t loaded = mem->rd(rf[2] + ip.c_imm_lwsp(), 4u);
+    uint32_t addr = (rf[2] + ip.c_imm_lwsp());
+    uint32_t loaded = mem->rd(addr, 4u);
     if (tu.is_trapped()) return;
     PROF_SPARSITY(loaded, 1u, mem_l)
     write_rf(ip.rd(), loaded);
@@ -304,16 +339,20 @@ void core::c_lwsp() {
     PROF_RD_ZERO(loaded)
     #ifdef PROFILERS_EN
     prof.log_stack_access_load((rf[2] + ip.c_imm_lwsp()) > TO_U32(rf[2]));
+    prof_perf.set_dmem(addr); // sp might be the destination
     PROF_SET_PERF_EVENT_MEM
     PROF_SET_PERF_EVENT_MEM_LOAD
     #endif
     #ifdef DASM_EN
-    DASM_OP_RD << "," << TO_I32(ip.c_imm_lwsp())
-               << "(" << rf_names[2][rf_names_idx] << ")";
-    DASM_RD_UPDATE;
-    if (ip.rd()) {
-        dasm.asm_ss << " <- mem["
-                    << MEM_ADDR_FORMAT(TO_I32(ip.c_imm_lwsp()) + rf[2]) << "]";
+    if (dasm.en) {
+        DASM_OP_RD << "," << TO_I32(ip.c_imm_lwsp())
+                   << "(" << rf_names[2][rf_names_idx] << ")";
+        DASM_RD_UPDATE;
+        if (ip.rd()) {
+            dasm.asm_ss << " <- mem["
+                        << MEM_ADDR_FORMAT(TO_I32(ip.c_imm_lwsp()) + rf[2])
+                        << "]";
+        }
     }
     #endif
     next_pc = pc + 2;
@@ -323,6 +362,7 @@ void core::c_sw() {
     PROF_SPARSITY(rf[ip.c_regl()], 1u, mem_s)
     uint32_t addr = (rf[ip.c_regh()] + ip.c_imm_mem());
     mem->wr(addr, rf[ip.c_regl()], 4u);
+    DC_STORE(addr, 4u)
     if (tu.is_trapped()) return;
     DASM_OP(c.sw)
     PROF_G(c_sw)
@@ -331,12 +371,17 @@ void core::c_sw() {
     #ifdef PROFILERS_EN
     prof.log_stack_access_store(
         (rf[ip.c_regh()] + ip.c_imm_mem()) > TO_U32(rf[2]));
+    prof_perf.set_dmem(addr);
     PROF_SET_PERF_EVENT_MEM
     #endif
     #ifdef DASM_EN
-    dasm.asm_ss << dasm.op << " " << DASM_CREGL << "," << TO_I32(ip.c_imm_mem())
-                << "(" << rf_names[ip.c_regh()][rf_names_idx] << ")";
-    DASM_MEM_UPDATE_P(TO_I32(ip.c_imm_mem()) + rf[ip.c_regh()], ip.c_regl());
+    if (dasm.en) {
+        dasm.asm_ss << dasm.op << " " << DASM_CREGL << ","
+                    << TO_I32(ip.c_imm_mem())
+                    << "(" << rf_names[ip.c_regh()][rf_names_idx] << ")";
+        DASM_MEM_UPDATE_P(
+            TO_I32(ip.c_imm_mem()) + rf[ip.c_regh()], ip.c_regl());
+    }
     #endif
     next_pc = pc + 2;
 }
@@ -345,6 +390,7 @@ void core::c_swsp() {
     PROF_SPARSITY(rf[ip.c_rs2()], 1u, mem_s)
     uint32_t addr = (rf[2] + ip.c_imm_swsp());
     mem->wr(addr, rf[ip.c_rs2()], 4u);
+    DC_STORE(addr, 4u)
     if (tu.is_trapped()) return;
     DASM_OP(c.swsp)
     PROF_G(c_swsp)
@@ -352,13 +398,16 @@ void core::c_swsp() {
     PROF_C_RS2_RS2
     #ifdef PROFILERS_EN
     prof.log_stack_access_store((rf[2] + ip.c_imm_swsp()) > TO_U32(rf[2]));
+    prof_perf.set_dmem(addr);
     PROF_SET_PERF_EVENT_MEM
     #endif
     #ifdef DASM_EN
-    dasm.asm_ss << dasm.op << " " << rf_names[ip.c_rs2()][rf_names_idx] << ","
-                << TO_I32(ip.c_imm_swsp())
-                << "(" << rf_names[2][rf_names_idx] << ")";
-    DASM_MEM_UPDATE_P(TO_I32(ip.c_imm_swsp()) + rf[2], ip.c_rs2());
+    if (dasm.en) {
+        dasm.asm_ss << dasm.op << " " << rf_names[ip.c_rs2()][rf_names_idx]
+                    << "," << TO_I32(ip.c_imm_swsp())
+                    << "(" << rf_names[2][rf_names_idx] << ")";
+        DASM_MEM_UPDATE_P(TO_I32(ip.c_imm_swsp()) + rf[2], ip.c_rs2());
+    }
     #endif
     next_pc = pc + 2;
 }
@@ -382,7 +431,10 @@ void core::c_beqz() {
     #endif
     DASM_OP(c.beqz)
     #ifdef DASM_EN
-    DASM_OP_CREGH << "," << std::hex << pc + TO_I32(ip.c_imm_b()) << std::dec;
+    if (dasm.en) {
+        DASM_OP_CREGH << "," << std::hex << pc + TO_I32(ip.c_imm_b())
+                      << std::dec;
+    }
     #endif
 }
 
@@ -404,7 +456,10 @@ void core::c_bnez() {
     #endif
     DASM_OP(c.bnez)
     #ifdef DASM_EN
-    DASM_OP_CREGH << "," << std::hex << pc + TO_I32(ip.c_imm_b()) << std::dec;
+    if (dasm.en) {
+        DASM_OP_CREGH << "," << std::hex << pc + TO_I32(ip.c_imm_b())
+                      << std::dec;
+    }
     #endif
 }
 
@@ -418,8 +473,10 @@ void core::c_j() {
     branch_taken = true;
     #endif
     #ifdef DASM_EN
-    dasm.asm_ss << dasm.op << " " << std::hex << pc + TO_I32(ip.c_imm_j())
-                << std::dec;
+    if (dasm.en) {
+        dasm.asm_ss << dasm.op << " " << std::hex << pc + TO_I32(ip.c_imm_j())
+                    << std::dec;
+    }
     #endif
 }
 
@@ -435,9 +492,11 @@ void core::c_jal() {
     branch_taken = true;
     #endif
     #ifdef DASM_EN
-    dasm.asm_ss << dasm.op << " " << std::hex << pc + TO_I32(ip.c_imm_j())
-                << std::dec;
-    DASM_RD_UPDATE_P(1);
+    if (dasm.en) {
+        dasm.asm_ss << dasm.op << " " << std::hex << pc + TO_I32(ip.c_imm_j())
+                    << std::dec;
+        DASM_RD_UPDATE_P(1);
+    }
     #endif
 }
 
@@ -461,8 +520,10 @@ void core::c_jr() {
     #endif
 
     #ifdef DASM_EN
-    DASM_OP_RD;
-    if (ret_inst) dasm.asm_ss << " # ret";
+    if (dasm.en) {
+        DASM_OP_RD;
+        if (ret_inst) dasm.asm_ss << " # ret";
+    }
     #endif
 }
 
@@ -484,8 +545,10 @@ void core::c_jalr() {
     #endif
 
     #ifdef DASM_EN
-    DASM_OP_RD;
-    DASM_RD_UPDATE_P(1);
+    if (dasm.en) {
+        DASM_OP_RD;
+        DASM_RD_UPDATE_P(1);
+    }
     #endif
 }
 
@@ -495,7 +558,7 @@ void core::c_ebreak() {
     DASM_OP(c.ebreak)
     PROF_G(c_ebreak)
     #ifdef DASM_EN
-    dasm.asm_ss << dasm.op;
+    if (dasm.en) dasm.asm_ss << dasm.op;
     #endif
 }
 
@@ -12,7 +12,7 @@ uint32_t core::alu_c_add_sub_op(uint32_t a, uint32_t b) {
     uint32_t res_packed = 0;
 
     #ifdef DASM_EN
-    simd_ss_init_cab();
+    if (dasm.en) simd_ss_init_cab();
     #endif
 
     for (size_t i = 0; i < e; i++) {
@@ -35,7 +35,7 @@ uint32_t core::alu_c_add_sub_op(uint32_t a, uint32_t b) {
         }
 
         #ifdef DASM_EN
-        simd_ss_append_cab(TO_I32(final_val), val_a, val_b);
+        if (dasm.en) simd_ss_append_cab(TO_I32(final_val), val_a, val_b);
         #endif
 
         res_packed |= (TO_U32(final_val) & mask) << (i * vbits);
@@ -46,7 +46,7 @@ uint32_t core::alu_c_add_sub_op(uint32_t a, uint32_t b) {
     }
 
     #ifdef DASM_EN
-    simd_ss_finish_cab();
+    if (dasm.en) simd_ss_finish_cab();
     #endif
 
     return res_packed;
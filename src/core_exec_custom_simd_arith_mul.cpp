@@ -12,7 +12,7 @@ uint32_t core::alu_c_mul_op(uint32_t a, uint32_t b) {
     uint32_t result = 0;
 
     #ifdef DASM_EN
-    simd_ss_init_cab();
+    if (dasm.en) simd_ss_init_cab();
     #endif
 
     for (size_t i = 0; i < e; i++) {
@@ -32,8 +32,10 @@ uint32_t core::alu_c_mul_op(uint32_t a, uint32_t b) {
         result |= (lane_result << (i * vbits));
 
         #ifdef DASM_EN
-        simd_ss_append_ab(val_a, val_b);
-        dasm.simd_c << TO_I32(lane_result) << " ";
+        if (dasm.en) {
+            simd_ss_append_ab(val_a, val_b);
+            dasm.simd_c << TO_I32(lane_result) << " ";
+        }
         #endif
 
         a >>= vbits;
@@ -41,7 +43,7 @@ uint32_t core::alu_c_mul_op(uint32_t a, uint32_t b) {
     }
 
     #ifdef DASM_EN
-    simd_ss_finish_cab();
+    if (dasm.en) simd_ss_finish_cab();
     #endif
 
     return result;
@@ -11,7 +11,7 @@ uint32_t core::alu_c_shift_op(uint32_t a, uint32_t shamt) {
     shamt &= (vbits - 1);
 
     #ifdef DASM_EN
-    simd_ss_init_ca();
+    if (dasm.en) simd_ss_init_ca();
     #endif
 
     for (size_t i = 0; i < e; i++) {
@@ -21,7 +21,7 @@ uint32_t core::alu_c_shift_op(uint32_t a, uint32_t shamt) {
         else res = (val_a >> shamt);
 
         #ifdef DASM_EN
-        simd_ss_append_imm((res & mask), val_a, (vbits >> 2));
+        if (dasm.en) simd_ss_append_imm((res & mask), val_a, (vbits >> 2));
         #endif
 
         res_packed |= (TO_U32(res) & mask) << (i * vbits);
@@ -31,7 +31,7 @@ uint32_t core::alu_c_shift_op(uint32_t a, uint32_t shamt) {
     }
 
     #ifdef DASM_EN
-    simd_ss_finish_cas(shamt);
+    if (dasm.en) simd_ss_finish_cas(shamt);
     #endif
 
     return res_packed;
@@ -13,7 +13,7 @@ reg_pair core::alu_c_wmul_op(uint32_t a, uint32_t b) {
 
     #ifdef DASM_EN
     constexpr size_t half_e = (e / 2);
-    simd_ss_init_cab();
+    if (dasm.en) simd_ss_init_cab();
     #endif
 
     // extract inputs and multiply
@@ -25,7 +25,7 @@ reg_pair core::alu_c_wmul_op(uint32_t a, uint32_t b) {
         results[i] = (val_a * val_b);
 
         #ifdef DASM_EN
-        simd_ss_append_ab(val_a, val_b);
+        if (dasm.en) simd_ss_append_ab(val_a, val_b);
         #endif
 
         a >>= vbits;
@@ -33,15 +33,17 @@ reg_pair core::alu_c_wmul_op(uint32_t a, uint32_t b) {
     }
 
     #ifdef DASM_EN
-    // format the result string: [ r0 r1 ], [ r2 r3 ]
+    if (dasm.en) {
+        // format the result string: [ r0 r1 ], [ r2 r3 ]
 
-    for (size_t i = 0; i < e; i++) {
-        dasm.simd_c << results[i];
-        // add separators at the split point (between reg words) and end
-        if (i == half_e - 1) dasm.simd_c << " ], [ ";
-        else dasm.simd_c << " ";
+        for (size_t i = 0; i < e; i++) {
+            dasm.simd_c << results[i];
+            // add separators at the split point (between reg words) and end
+            if (i == half_e - 1) dasm.simd_c << " ], [ ";
+            else dasm.simd_c << " ";
+        }
+        simd_ss_finish_cab();
     }
-    simd_ss_finish_cab();
     #endif
 
     return pack_wide<out_bits>(results);
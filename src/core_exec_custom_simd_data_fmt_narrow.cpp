@@ -38,12 +38,14 @@ uint32_t core::data_fmt_c_narrow_t(uint32_t a, uint32_t b) {
             }
 
             #ifdef DASM_EN
-            int32_t m_val = (raw & out_mask);
-            if constexpr (vsigned && vsat) {
-                constexpr int32_t s = (32 - out_bits);
-                out_vals[offset + i] = ((m_val << s) >> s);
-            } else {
-                out_vals[offset + i] = m_val;
+            if (dasm.en) {
+                int32_t m_val = (raw & out_mask);
+                if constexpr (vsigned && vsat) {
+                    constexpr int32_t s = (32 - out_bits);
+                    out_vals[offset + i] = ((m_val << s) >> s);
+                } else {
+                    out_vals[offset + i] = m_val;
+                }
             }
             #endif
 
@@ -56,29 +58,31 @@ uint32_t core::data_fmt_c_narrow_t(uint32_t a, uint32_t b) {
     };
 
     #ifdef DASM_EN
-    simd_ss_init_cab();
+    if (dasm.en) simd_ss_init_cab();
     #endif
 
     process_reg(a, 0);
     process_reg(b, e);
 
     #ifdef DASM_EN
-    for (size_t i = 0; i < e; i++) {
-        if constexpr (vsigned) {
-            simd_ss_append_ab(
-                extract_val<vbits, vsigned>(a >> (i * vbits)),
-                extract_val<vbits, vsigned>(b >> (i * vbits))
-            );
-        } else {
-            simd_ss_append_ab_u(
-                TO_U32((extract_val<vbits, vsigned>(a >> (i * vbits)))),
-                TO_U32((extract_val<vbits, vsigned>(b >> (i * vbits))))
-            );
+    if (dasm.en) {
+        for (size_t i = 0; i < e; i++) {
+            if constexpr (vsigned) {
+                simd_ss_append_ab(
+                    extract_val<vbits, vsigned>(a >> (i * vbits)),
+                    extract_val<vbits, vsigned>(b >> (i * vbits))
+                );
+            } else {
+                simd_ss_append_ab_u(
+                    TO_U32((extract_val<vbits, vsigned>(a >> (i * vbits)))),
+                    TO_U32((extract_val<vbits, vsigned>(b >> (i * vbits))))
+                );
+            }
         }
-    }
 
-    for (size_t i = 0; i < out_e; i++) dasm.simd_c << out_vals[i] << " ";
-    simd_ss_finish_cab();
+        for (size_t i = 0; i < out_e; i++) dasm.simd_c << out_vals[i] << " ";
+        simd_ss_finish_cab();
+    }
     #endif
 
     return res;
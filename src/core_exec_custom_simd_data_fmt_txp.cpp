@@ -16,7 +16,7 @@ reg_pair core::data_fmt_c_txp_t(uint32_t a, uint32_t b) {
     uint32_t rdp_val = 0;
 
     #ifdef DASM_EN
-    simd_ss_init_cab();
+    if (dasm.en) simd_ss_init_cab();
     #endif
 
     // one iteration per (even, odd) lane pair:
@@ -37,27 +37,31 @@ reg_pair core::data_fmt_c_txp_t(uint32_t a, uint32_t b) {
         rdp_val |= ((a_odd << (i_even * vbits)) | (b_odd << (i_odd * vbits)));
 
         #ifdef DASM_EN
-        simd_ss_append_ab(TO_I32(a_even), TO_I32(b_even));
-        simd_ss_append_ab(TO_I32(a_odd), TO_I32(b_odd));
+        if (dasm.en) {
+            simd_ss_append_ab(TO_I32(a_even), TO_I32(b_even));
+            simd_ss_append_ab(TO_I32(a_odd), TO_I32(b_odd));
+        }
         #endif
     }
 
     #ifdef DASM_EN
-    // simd_c: rd then rdp "[ rd_elems ], [ rdp_elems ]"
-    for (size_t j = 0; j < half_e; j++) {
-        uint32_t a_even = ((a >> (2 * j * vbits)) & mask);
-        uint32_t b_even = ((b >> (2 * j * vbits)) & mask);
-        dasm.simd_c << TO_I32(a_even) << " " << TO_I32(b_even) << " ";
-    }
+    if (dasm.en) {
+        // simd_c: rd then rdp "[ rd_elems ], [ rdp_elems ]"
+        for (size_t j = 0; j < half_e; j++) {
+            uint32_t a_even = ((a >> (2 * j * vbits)) & mask);
+            uint32_t b_even = ((b >> (2 * j * vbits)) & mask);
+            dasm.simd_c << TO_I32(a_even) << " " << TO_I32(b_even) << " ";
+        }
 
-    dasm.simd_c << "], [ ";
-    for (size_t j = 0; j < half_e; j++) {
-        uint32_t a_odd = ((a >> ((2 * j + 1) * vbits)) & mask);
-        uint32_t b_odd = ((b >> ((2 * j + 1) * vbits)) & mask);
-        dasm.simd_c << TO_I32(a_odd) << " " << TO_I32(b_odd) << " ";
-    }
+        dasm.simd_c << "], [ ";
+        for (size_t j = 0; j < half_e; j++) {
+            uint32_t a_odd = ((a >> ((2 * j + 1) * vbits)) & mask);
+            uint32_t b_odd = ((b >> ((2 * j + 1) * vbits)) & mask);
+            dasm.simd_c << TO_I32(a_odd) << " " << TO_I32(b_odd) << " ";
+        }
 
-    simd_ss_finish_cab();
+        simd_ss_finish_cab();
+    }
     #endif
 
     return {rd_val, rdp_val};
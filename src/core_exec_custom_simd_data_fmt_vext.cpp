@@ -11,12 +11,15 @@ uint32_t core::data_fmt_c_vext_t(uint32_t rs1, uint8_t idx) {
     int32_t res = extract_val<vbits, vsigned>(lane_val);
 
     #ifdef DASM_EN
-    // RD = scalar result, RS1 = source vector (all elements), RS2 = lane index
-    simd_ss_init_a();
-    for (size_t i = 0; i < lanes; i++) {
-        simd_ss_append_a(extract_val<vbits, true>(rs1 >> (i * vbits)));
+    if (dasm.en) {
+        // RD = scalar result, RS1 = source vector (all elements),
+        // RS2 = lane index
+        simd_ss_init_a();
+        for (size_t i = 0; i < lanes; i++) {
+            simd_ss_append_a(extract_val<vbits, true>(rs1 >> (i * vbits)));
+        }
+        simd_ss_finish_vext(res, static_cast<int32_t>(idx));
     }
-    simd_ss_finish_vext(res, static_cast<int32_t>(idx));
     #endif
 
     return TO_U32(res);
@@ -13,13 +13,15 @@ uint32_t core::data_fmt_c_vins_t(uint32_t rs3, uint32_t rs1, uint8_t idx) {
     uint32_t res = ((rs3 & clear_lane) | insert);
 
     #ifdef DASM_EN
-    // RD = result vector; RS1 = scalar (inserted value); RS2 = lane index
-    simd_ss_init_c();
-    for (size_t i = 0; i < lanes; i++) {
-        simd_ss_append_c(extract_val<vbits, true>(res >> (i * vbits)));
+    if (dasm.en) {
+        // RD = result vector; RS1 = scalar (inserted value); RS2 = lane index
+        simd_ss_init_c();
+        for (size_t i = 0; i < lanes; i++) {
+            simd_ss_append_c(extract_val<vbits, true>(res >> (i * vbits)));
+        }
+        simd_ss_finish_vins(
+            extract_val<vbits, true>(rs1), static_cast<int32_t>(idx));
     }
-    simd_ss_finish_vins(
-        extract_val<vbits, true>(rs1), static_cast<int32_t>(idx));
     #endif
 
     return res;
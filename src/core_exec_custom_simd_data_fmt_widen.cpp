@@ -12,25 +12,28 @@ reg_pair core::data_fmt_c_widen_t(uint32_t a, uint32_t shamt) {
     int32_t vals[e];
     #ifdef DASM_EN
     constexpr size_t half_e = (e / 2);
-    simd_ss_init_ca();
+    if (dasm.en) simd_ss_init_ca();
     #endif
 
     for (size_t i = 0; i < e; i++) {
         vals[i] = extract_val<vbits, vsigned>(a);
         #ifdef DASM_EN
-        simd_ss_append_a(vals[i]);
+        if (dasm.en) simd_ss_append_a(vals[i]);
         #endif
         vals[i] <<= shamt;
         a >>= vbits;
     }
 
     #ifdef DASM_EN
-    for (size_t i = 0; i < e; i++) {
-        dasm.simd_c << vals[i];
-        if (i == (half_e - 1)) dasm.simd_c << " ], [ "; // separator at rd/rdp
-        else dasm.simd_c << " ";
+    if (dasm.en) {
+        for (size_t i = 0; i < e; i++) {
+            dasm.simd_c << vals[i];
+            // separator at rd/rdp
+            if (i == (half_e - 1)) dasm.simd_c << " ], [ ";
+            else dasm.simd_c << " ";
+        }
+        simd_ss_finish_cas(shamt);
     }
-    simd_ss_finish_cas(shamt);
     #endif
 
     return pack_wide<out_bits>(vals);
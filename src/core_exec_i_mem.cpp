@@ -27,12 +27,15 @@ uint32_t core::load_lhu(uint32_t addr) {
 void core::store_sb(uint32_t addr, uint32_t data) {
     PROF_DMEM(dmem_size_t::sb)
     mem->wr(addr, data, 1u);
+    DC_STORE(addr, 1u)
 }
 void core::store_sh(uint32_t addr, uint32_t data) {
     PROF_DMEM(dmem_size_t::sh)
     mem->wr(addr, data, 2u);
+    DC_STORE(addr, 2u)
 }
 void core::store_sw(uint32_t addr, uint32_t data) {
     PROF_DMEM(dmem_size_t::sw)
     mem->wr(addr, data, 4u);
+    DC_STORE(addr, 4u)
 }
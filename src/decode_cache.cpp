@@ -0,0 +1,347 @@
+#include "decode_cache.h"
+
+decode_cache::decode_cache(memory* mem) :
+    mem(mem),
+    blocks(decode_cache_cfg::blocks)
+{
+    flush();
+}
+
+void decode_cache::flush() {
+    for (auto& b : blocks) {
+        b.len = 0;
+        b.succ = {nullptr, nullptr};
+        #ifdef JIT_EN
+        b.jit = nullptr;
+        #endif
+    }
+    #ifdef JIT_EN
+    flush_cnt++;
+    #endif
+    blk = nullptr;
+    idx = 0;
+    seq_pc = 0;
+    code_lo = UINT32_MAX;
+    code_hi = 0;
+}
+
+void decode_cache::chain(uint32_t pc) {
+    pd_block_t* prev = blk;
+    if (prev != nullptr) {
+        for (pd_block_t* s : prev->succ) {
+            if ((s != nullptr) && (s->pc == pc) && (s->len != 0)) {
+                blk = s;
+                idx = 0;
+                return;
+            }
+        }
+    }
+    enter(pc);
+    if (prev == nullptr) return;
+    // keep the most recent successor in the first slot
+    prev->succ[1] = prev->succ[0];
+    prev->succ[0] = blk;
+}
+
+void decode_cache::enter(uint32_t pc) {
+    blk = &blocks[(pc >> 1) & (decode_cache_cfg::blocks - 1)];
+    if ((blk->pc != pc) || (blk->len == 0)) {
+        blk->pc = pc;
+        blk->len = 0;
+        blk->closed = false;
+        blk->succ = {nullptr, nullptr};
+        #ifdef JIT_EN
+        blk->jit = nullptr;
+        #endif
+    }
+    idx = 0;
+}
+
+void decode_cache::extend(uint32_t pc) {
+    pd_inst_t& d = blk->insts[blk->len++];
+    decode(pc, d);
+    #ifdef THREADED_DISPATCH_EN
+    d.handler = handlers[TO_U8(d.op)];
+    #endif
+    code_lo = std::min(code_lo, pc);
+    code_hi = std::max(code_hi, pc + d.isz);
+    switch (d.op) {
+        case pd_op_t::op_beq:
+        case pd_op_t::op_bne:
+        case pd_op_t::op_blt:
+        case pd_op_t::op_bge:
+        case pd_op_t::op_bltu:
+        case pd_op_t::op_bgeu:
+        case pd_op_t::op_jal:
+        case pd_op_t::op_jalr:
+        case pd_op_t::fallback:
+            blk->closed = true;
+            break;
+        default: break;
+    }
+}
+
+// mirrors the selection in core::exec and the d_* decoders
+// encodings they reject are left as fallback so the trap is raised there
+void decode_cache::decode(uint32_t pc, pd_inst_t& d) {
+    uint32_t inst = mem->rd_inst(pc);
+    ip.set(inst);
+    d.op = pd_op_t::fallback;
+    d.rd = d.rs1 = d.rs2 = 0;
+    d.imm = 0;
+    d.inst = inst;
+    d.isz = 4;
+
+    if (ip.copcode() != 0x3) {
+        #ifdef RV32C_EN
+        d.inst = ip.to_rvc(inst);
+        d.isz = 2;
+        decode_rvc(d);
+        #endif
+        return;
+    }
+
+    d.rd = TO_U8(ip.rd());
+    d.rs1 = TO_U8(ip.rs1());
+    d.rs2 = TO_U8(ip.rs2());
+    uint32_t funct3 = ip.funct3();
+    switch (ip.opcode()) {
+        case TO_U8(opcode::d_alu_reg):
+            switch (ip.funct7()) {
+                case 0x00:
+                case 0x20:
+                    switch ((ip.funct7_b5() << 3) | funct3) {
+                        CASE_PD_DECODE(alu_r_op_t, add)
+                        CASE_PD_DECODE(alu_r_op_t, sub)
+                        CASE_PD_DECODE(alu_r_op_t, sll)
+                        CASE_PD_DECODE(alu_r_op_t, srl)
+                        CASE_PD_DECODE(alu_r_op_t, sra)
+                        CASE_PD_DECODE(alu_r_op_t, slt)
+                        CASE_PD_DECODE(alu_r_op_t, sltu)
+                        CASE_PD_DECODE(alu_r_op_t, xor)
+                        CASE_PD_DECODE(alu_r_op_t, or)
+                        CASE_PD_DECODE(alu_r_op_t, and)
+                        default: break;
+                    }
+                    break;
+                case 0x01:
+                    switch (funct3) {
+                        CASE_PD_DECODE(alu_r_mul_op_t, mul)
+                        CASE_PD_DECODE(alu_r_mul_op_t, mulh)
+                        CASE_PD_DECODE(alu_r_mul_op_t, mulhsu)
+                        CASE_PD_DECODE(alu_r_mul_op_t, mulhu)
+                        CASE_PD_DECODE(alu_r_mul_op_t, div)
+                        CASE_PD_DECODE(alu_r_mul_op_t, divu)
+                        CASE_PD_DECODE(alu_r_mul_op_t, rem)
+                        CASE_PD_DECODE(alu_r_mul_op_t, remu)
+                        default: break;
+                    }
+                    break;
+                case 0x05:
+                    switch (funct3) {
+                        CASE_PD_DECODE(alu_r_zbb_op_t, max)
+                        CASE_PD_DECODE(alu_r_zbb_op_t, maxu)
+                        CASE_PD_DECODE(alu_r_zbb_op_t, min)
+                        CASE_PD_DECODE(alu_r_zbb_op_t, minu)
+                        default: break;
+                    }
+                    break;
+                default: break;
+            }
+            break;
+        case TO_U8(opcode::d_alu_imm): {
+            bool is_shift = ((funct3 & 0x3) == 1);
+            d.imm = ip.imm_i();
+            switch (is_shift ? ((ip.funct7_b5() << 3) | funct3) : funct3) {
+                CASE_PD_DECODE(alu_i_op_t, addi)
+                CASE_PD_DECODE(alu_i_op_t, slli)
+                CASE_PD_DECODE(alu_i_op_t, srli)
+                CASE_PD_DECODE(alu_i_op_t, srai)
+                CASE_PD_DECODE(alu_i_op_t, slti)
+                CASE_PD_DECODE(alu_i_op_t, sltiu)
+                CASE_PD_DECODE(alu_i_op_t, xori)
+                CASE_PD_DECODE(alu_i_op_t, ori)
+                CASE_PD_DECODE(alu_i_op_t, andi)
+                default: break;
+            }
+            } break;
+        case TO_U8(opcode::d_load):
+            d.imm = ip.imm_i();
+            switch (funct3) {
+                CASE_PD_DECODE(load_op_t, lb)
+                CASE_PD_DECODE(load_op_t, lh)
+                CASE_PD_DECODE(load_op_t, lw)
+                CASE_PD_DECODE(load_op_t, lbu)
+                CASE_PD_DECODE(load_op_t, lhu)
+                default: break;
+            }
+            break;
+        case TO_U8(opcode::d_store):
+            d.imm = ip.imm_s();
+            switch (funct3) {
+                CASE_PD_DECODE(store_op_t, sb)
+                CASE_PD_DECODE(store_op_t, sh)
+                CASE_PD_DECODE(store_op_t, sw)
+                default: break;
+            }
+            break;
+        case TO_U8(opcode::d_branch):
+            d.imm = ip.imm_b();
+            switch (funct3) {
+                CASE_PD_DECODE(branch_op_t, beq)
+                CASE_PD_DECODE(branch_op_t, bne)
+                CASE_PD_DECODE(branch_op_t, blt)
+                CASE_PD_DECODE(branch_op_t, bge)
+                CASE_PD_DECODE(branch_op_t, bltu)
+                CASE_PD_DECODE(branch_op_t, bgeu)
+                default: break;
+            }
+            break;
+        case TO_U8(opcode::d_jalr):
+            d.imm = ip.imm_i();
+            if (funct3 == 0) d.op = pd_op_t::op_jalr;
+            break;
+        case TO_U8(opcode::d_jal):
+            d.imm = ip.imm_j();
+            d.op = pd_op_t::op_jal;
+            break;
+        case TO_U8(opcode::d_lui):
+            d.imm = ip.imm_u();
+            d.op = pd_op_t::op_lui;
+            break;
+        case TO_U8(opcode::d_auipc):
+            d.imm = ip.imm_u();
+            d.op = pd_op_t::op_auipc;
+            break;
+        default: break;
+    }
+}
+
+#ifdef RV32C_EN
+// mirrors d_compressed_0/1/2, reserved forms that trap stay as fallback
+void decode_cache::decode_rvc(pd_inst_t& d) {
+    uint32_t funct3 = ip.c_funct3();
+    switch (d.inst & M_OPC2) {
+        case 0x0:
+            switch (funct3) {
+                case 0x0: // c.addi4spn
+                    if (ip.c_imm_4spn() == 0) break;
+                    PD_SET(addi, ip.c_regl(), 2u, 0u, ip.c_imm_4spn())
+                    break;
+                case 0x2: // c.lw
+                    PD_SET(lw, ip.c_regl(), ip.c_regh(), 0u, ip.c_imm_mem())
+                    break;
+                case 0x6: // c.sw
+                    PD_SET(sw, 0u, ip.c_regh(), ip.c_regl(), ip.c_imm_mem())
+                    break;
+                default: break;
+            }
+            break;
+        case 0x1:
+            switch (funct3) {
+                case 0x0: // c.addi
+                    PD_SET(addi, ip.rd(), ip.rd(), 0u, ip.c_imm_arith())
+                    break;
+                case 0x1: // c.jal
+                    PD_SET(jal, 1u, 0u, 0u, ip.c_imm_j())
+                    break;
+                case 0x2: // c.li
+                    PD_SET(addi, ip.rd(), 0u, 0u, ip.c_imm_arith())
+                    break;
+                case 0x3:
+                    if (ip.rd() == 0x0) { // c.nop
+                        PD_SET(addi, 0u, 0u, 0u, 0u)
+                    } else if (ip.rd() == 0x2) { // c.addi16sp
+                        if (ip.c_imm_16sp() == 0) break;
+                        PD_SET(addi, 2u, 2u, 0u, ip.c_imm_16sp())
+                    } else { // c.lui
+                        if (ip.c_imm_lui() == 0) break;
+                        PD_SET(lui, ip.rd(), 0u, 0u, ip.c_imm_lui())
+                    }
+                    break;
+                case 0x4:
+                    switch (ip.c_funct2h()) {
+                        case 0x0: // c.srli
+                            PD_SET(srli, ip.c_regh(), ip.c_regh(), 0u,
+                                   ip.c_imm_arith())
+                            break;
+                        case 0x1: // c.srai
+                            PD_SET(srai, ip.c_regh(), ip.c_regh(), 0u,
+                                   ip.c_imm_arith())
+                            break;
+                        case 0x2: // c.andi
+                            PD_SET(andi, ip.c_regh(), ip.c_regh(), 0u,
+                                   ip.c_imm_arith())
+                            break;
+                        case 0x3:
+                            switch ((ip.c_funct6() << 2) | ip.c_funct2l()) {
+                                case 0x8c: // c.sub
+                                    PD_SET(sub, ip.c_regh(), ip.c_regh(),
+                                           ip.c_regl(), 0u)
+                                    break;
+                                case 0x8d: // c.xor
+                                    PD_SET(xor, ip.c_regh(), ip.c_regh(),
+                                           ip.c_regl(), 0u)
+                                    break;
+                                case 0x8e: // c.or
+                                    PD_SET(or, ip.c_regh(), ip.c_regh(),
+                                           ip.c_regl(), 0u)
+                                    break;
+                                case 0x8f: // c.and
+                                    PD_SET(and, ip.c_regh(), ip.c_regh(),
+                                           ip.c_regl(), 0u)
+                                    break;
+                                default: break;
+                            }
+                            break;
+                    }
+                    break;
+                case 0x5: // c.j
+                    PD_SET(jal, 0u, 0u, 0u, ip.c_imm_j())
+                    break;
+                case 0x6: // c.beqz
+                    PD_SET(beq, 0u, ip.c_regh(), 0u, ip.c_imm_b())
+                    break;
+                case 0x7: // c.bnez
+                    PD_SET(bne, 0u, ip.c_regh(), 0u, ip.c_imm_b())
+                    break;
+                default: break;
+            }
+            break;
+        case 0x2:
+            switch (funct3) {
+                case 0x0: // c.slli
+                    PD_SET(slli, ip.rd(), ip.rd(), 0u, ip.c_imm_slli())
+                    break;
+                case 0x2: // c.lwsp
+                    PD_SET(lw, ip.rd(), 2u, 0u, ip.c_imm_lwsp())
+                    break;
+                case 0x6: // c.swsp
+                    PD_SET(sw, 0u, 2u, ip.c_rs2(), ip.c_imm_swsp())
+                    break;
+                case 0x4:
+                    switch (ip.c_funct4()) {
+                        case 0x8:
+                            if (ip.c_rs2() != 0x0) { // c.mv
+                                PD_SET(add, ip.rd(), 0u, ip.c_rs2(), 0u)
+                            } else if (ip.rd() != 0x0) { // c.jr
+                                PD_SET(jalr, 0u, ip.rd(), 0u, 0u)
+                            }
+                            break;
+                        case 0x9:
+                            if (ip.c_rs2() != 0x0) { // c.add
+                                PD_SET(add, ip.rd(), ip.rd(), ip.c_rs2(), 0u)
+                            } else if (ip.rd() != 0x0) { // c.jalr
+                                PD_SET(jalr, 1u, ip.rd(), 0u, 0u)
+                            } // else c.ebreak
+                            break;
+                        default: break;
+                    }
+                    break;
+                default: break;
+            }
+            break;
+        default: break;
+    }
+}
+#endif
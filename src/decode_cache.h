@@ -0,0 +1,149 @@
+#pragma once
+
+#include "defines.h"
+#include "inst_parser.h"
+#include "memory.h"
+
+namespace decode_cache_cfg {
+    constexpr uint32_t blocks = 2048; // direct-mapped, indexed by start pc
+    constexpr uint32_t block_insts = 32; // max instructions per block
+    static_assert (is_pow2(blocks));
+}
+
+// resolved handlers for core::exec_pd
+// anything not listed goes through the reference decoders in core::exec
+enum class pd_op_t : uint8_t {
+    // rv32i
+    op_add, op_sub, op_sll, op_srl, op_sra, op_slt, op_sltu,
+    op_xor, op_or, op_and,
+    op_addi, op_slli, op_srli, op_srai, op_slti, op_sltiu,
+    op_xori, op_ori, op_andi,
+    op_lb, op_lh, op_lw, op_lbu, op_lhu,
+    op_sb, op_sh, op_sw,
+    op_beq, op_bne, op_blt, op_bge, op_bltu, op_bgeu,
+    op_jal, op_jalr,
+    op_lui, op_auipc,
+    // rv32m
+    op_mul, op_mulh, op_mulhsu, op_mulhu,
+    op_div, op_divu, op_rem, op_remu,
+    // zbb
+    op_max, op_maxu, op_min, op_minu,
+    // csr, system, fence, custom, reserved encodings
+    fallback,
+    _count
+};
+
+// rvc is expanded to its rv32 equivalent, isz keeps the original size
+struct pd_inst_t {
+    pd_op_t op;
+    uint8_t rd;
+    uint8_t rs1;
+    uint8_t rs2;
+    uint32_t imm; // sign-extended where applicable
+    uint32_t inst; // as seen by core::exec, i.e. 16-bit for rvc
+    uint32_t isz; // bytes
+    #ifdef THREADED_DISPATCH_EN
+    const void* handler; // label in core::run_fast, resolved from op
+    #endif
+};
+
+struct pd_block_t {
+    uint32_t pc = 0; // block start, also the tag
+    uint32_t len = 0; // instructions decoded so far, 0 is invalid
+    bool closed = false; // ends with a control flow or fallback instruction
+    // successors seen so far, e.g. taken and not taken
+    // only a hint, valid while the linked block still starts at the target pc
+    std::array<pd_block_t*, 2> succ = {nullptr, nullptr};
+    std::array<pd_inst_t, decode_cache_cfg::block_insts> insts;
+    #ifdef JIT_EN
+    void* jit = nullptr; // host code once complete, see jit.h
+    #endif
+    bool open() const {
+        return (!closed && (len < decode_cache_cfg::block_insts));
+    }
+};
+
+/*
+PC-indexed cache of predecoded basic blocks
+- blocks are extended lazily, one instruction at a time, right before that
+  instruction executes for the first time, so fetch faults are raised at the
+  same point as on the reference path
+- sequential execution within a block is a cursor increment, the block table
+  is only looked up after control flow changes
+- blocks are chained to their successors, so hot control flow goes from
+  block to block without indexing the table
+- any store overlapping decoded code and fence.i invalidate all blocks
+*/
+class decode_cache {
+    private:
+        memory* mem;
+        inst_parser ip;
+        std::vector<pd_block_t> blocks;
+        pd_block_t* blk; // current block
+        uint32_t idx; // next instruction within the current block
+        uint32_t seq_pc; // pc that continues the current block
+        uint32_t code_lo; // range of decoded code, for store invalidation
+        uint32_t code_hi;
+        #ifdef THREADED_DISPATCH_EN
+        const void* const* handlers = nullptr; // indexed by pd_op_t
+        #endif
+        #ifdef JIT_EN
+        uint64_t flush_cnt = 0;
+        #endif
+
+    public:
+        decode_cache() = delete;
+        decode_cache(memory* mem);
+
+        // nullptr if pc can't be predecoded, reference fetch handles it
+        const pd_inst_t* get(uint32_t pc) {
+            bool seq = (
+                (blk != nullptr) && (pc == seq_pc) &&
+                ((idx < blk->len) || blk->open())
+            );
+            if (!seq) {
+                if (pc & 0x1) return nullptr;
+                chain(pc);
+            }
+            if (idx == blk->len) extend(pc);
+            const pd_inst_t* d = &blk->insts[idx++];
+            seq_pc = pc + d->isz;
+            return d;
+        }
+
+        // puts back the instruction returned by the last get
+        void unget(uint32_t pc) {
+            idx--;
+            seq_pc = pc;
+        }
+
+        void invalidate(uint32_t addr, uint32_t size) {
+            if ((addr < code_hi) && ((addr + size) > code_lo)) flush();
+        }
+
+        void flush();
+
+        #ifdef JIT_EN
+        // complete block starting at pc, nullptr if missing or still open
+        pd_block_t* full_block(uint32_t pc) {
+            pd_block_t* b = &blocks[(pc >> 1) & (decode_cache_cfg::blocks - 1)];
+            if ((b->pc != pc) || (b->len == 0) || b->open()) return nullptr;
+            return b;
+        }
+        // changes whenever decoded blocks are dropped
+        uint64_t get_flush_cnt() const { return flush_cnt; }
+        #endif
+
+        #ifdef THREADED_DISPATCH_EN
+        void set_handlers(const void* const* h) { handlers = h; flush(); }
+        #endif
+
+    private:
+        void chain(uint32_t pc);
+        void enter(uint32_t pc);
+        void extend(uint32_t pc);
+        void decode(uint32_t pc, pd_inst_t& d);
+        #ifdef RV32C_EN
+        void decode_rvc(pd_inst_t& d);
+        #endif
+};
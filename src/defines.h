@@ -20,6 +20,37 @@
 #endif
 #endif
 
+// predecoded fast path runs lean builds end to end
+// instrumented builds only use it to fast-forward to the profiling start
+#if defined(DECODE_CACHE_EN) && defined(DPI)
+#undef DECODE_CACHE_EN
+#endif
+
+// hw models have to see every data access
+#if defined(SOFT_TLB_EN) && defined(HW_MODELS_EN)
+#undef SOFT_TLB_EN
+#endif
+
+// threaded dispatch runs over predecoded instructions
+#if defined(THREADED_DISPATCH_EN) && !defined(DECODE_CACHE_EN)
+#undef THREADED_DISPATCH_EN
+#endif
+
+// translated blocks are x86-64 host code and replace the lean fast path
+#if defined(JIT_EN) && (!defined(DECODE_CACHE_EN) || !defined(__x86_64__) || \
+    defined(PROFILERS_EN) || defined(HW_MODELS_EN) || defined(DASM_EN))
+#undef JIT_EN
+#endif
+
+// binary exec log follows single_step, not the predecoded lean fast path
+#if !defined(DPI) && (defined(PROFILERS_EN) || defined(HW_MODELS_EN) || \
+    defined(DASM_EN) || !defined(DECODE_CACHE_EN))
+#define EXEC_LOG_BIN_EN
+#endif
+#if defined(DASM_EN) || defined(EXEC_LOG_BIN_EN)
+#define EXEC_LOG_EN // either log, shares the logging flags
+#endif
+
 #include "types.h"
 
 // casts
@@ -132,7 +163,9 @@
         break;
 
 #ifdef HW_MODELS_EN
-#define DIV_HM_EVAL(uns) div.eval(rf[ip.rs1()], rf[ip.rs2()], uns);
+#define DIV_HM_EVAL(uns) \
+    div.eval(rf[ip.rs1()], rf[ip.rs2()], uns); \
+    if (hw_trace.is_en()) hw_trace.div(rf[ip.rs1()], rf[ip.rs2()], uns);
 #else
 #define DIV_HM_EVAL(uns)
 #endif
@@ -396,6 +429,137 @@
 
 #define W_CSR(expr) write_csr(TO_U16(ip.csr_addr()), expr)
 
+// decode cache
+#define CASE_PD_DECODE(type, o) \
+    case TO_U8(type::op_##o): \
+        d.op = pd_op_t::op_##o; \
+        break;
+
+#define PD_SET(o, r_d, r_s1, r_s2, im) \
+    d.op = pd_op_t::op_##o; \
+    d.rd = TO_U8(r_d); \
+    d.rs1 = TO_U8(r_s1); \
+    d.rs2 = TO_U8(r_s2); \
+    d.imm = (im);
+
+// handler entry and exit, defined by the dispatch loop that expands them
+// PD_OP(o): handler label, PD_NEXT: retire and go to the next instruction,
+// PD_NEXT_ST: same after a store, PD_TRAPPED: leave after a trap
+#define CASE_PD_ALU_REG(o) \
+    PD_OP(op_##o) \
+        write_rf(d->rd, alu_##o(rf[d->rs1], rf[d->rs2])); \
+        next_pc = (pc + d->isz); \
+        PD_NEXT
+
+#define CASE_PD_ALU_IMM(o) \
+    PD_OP(op_##o) \
+        write_rf(d->rd, alu_##o(rf[d->rs1], d->imm)); \
+        next_pc = (pc + d->isz); \
+        PD_NEXT
+
+#define CASE_PD_LOAD(o) \
+    PD_OP(op_##o) { \
+        uint32_t loaded = load_##o(rf[d->rs1] + d->imm); \
+        if (tu.is_trapped()) PD_TRAPPED \
+        write_rf(d->rd, loaded); \
+        next_pc = (pc + d->isz); \
+        } PD_NEXT
+
+#define CASE_PD_STORE(o) \
+    PD_OP(op_##o) \
+        store_##o((rf[d->rs1] + d->imm), rf[d->rs2]); \
+        if (tu.is_trapped()) PD_TRAPPED \
+        next_pc = (pc + d->isz); \
+        PD_NEXT_ST
+
+#define CASE_PD_BRANCH(o, cond) \
+    PD_OP(op_##o) \
+        next_pc = (cond) ? (pc + d->imm) : (pc + d->isz); \
+        PD_TARGET_ALIGN_CHECK("branch unaligned access") \
+        PD_NEXT
+
+#ifndef RV32C_EN
+#define PD_TARGET_ALIGN_CHECK(msg) \
+    if (next_pc % 4 != 0) { \
+        tu.e_inst_addr_misaligned(next_pc, msg); \
+        PD_TRAPPED \
+    }
+#else
+#define PD_TARGET_ALIGN_CHECK(msg)
+#endif
+
+// all predecoded handlers, expanded once per dispatch loop
+#define PD_HANDLERS \
+    CASE_PD_ALU_REG(add) \
+    CASE_PD_ALU_REG(sub) \
+    CASE_PD_ALU_REG(sll) \
+    CASE_PD_ALU_REG(srl) \
+    CASE_PD_ALU_REG(sra) \
+    CASE_PD_ALU_REG(slt) \
+    CASE_PD_ALU_REG(sltu) \
+    CASE_PD_ALU_REG(xor) \
+    CASE_PD_ALU_REG(or) \
+    CASE_PD_ALU_REG(and) \
+    CASE_PD_ALU_IMM(addi) \
+    CASE_PD_ALU_IMM(slli) \
+    CASE_PD_ALU_IMM(srli) \
+    CASE_PD_ALU_IMM(srai) \
+    CASE_PD_ALU_IMM(slti) \
+    CASE_PD_ALU_IMM(sltiu) \
+    CASE_PD_ALU_IMM(xori) \
+    CASE_PD_ALU_IMM(ori) \
+    CASE_PD_ALU_IMM(andi) \
+    CASE_PD_LOAD(lb) \
+    CASE_PD_LOAD(lh) \
+    CASE_PD_LOAD(lw) \
+    CASE_PD_LOAD(lbu) \
+    CASE_PD_LOAD(lhu) \
+    CASE_PD_STORE(sb) \
+    CASE_PD_STORE(sh) \
+    CASE_PD_STORE(sw) \
+    CASE_PD_BRANCH(beq, (rf[d->rs1] == rf[d->rs2])) \
+    CASE_PD_BRANCH(bne, (rf[d->rs1] != rf[d->rs2])) \
+    CASE_PD_BRANCH(blt, (rf[d->rs1] < rf[d->rs2])) \
+    CASE_PD_BRANCH(bge, (rf[d->rs1] >= rf[d->rs2])) \
+    CASE_PD_BRANCH(bltu, (TO_U32(rf[d->rs1]) < TO_U32(rf[d->rs2]))) \
+    CASE_PD_BRANCH(bgeu, (TO_U32(rf[d->rs1]) >= TO_U32(rf[d->rs2]))) \
+    PD_OP(op_jal) \
+        next_pc = (pc + d->imm); \
+        PD_TARGET_ALIGN_CHECK("jal unaligned access") \
+        write_rf(d->rd, (pc + d->isz)); \
+        PD_NEXT \
+    PD_OP(op_jalr) \
+        next_pc = ((rf[d->rs1] + d->imm) & 0xFFFFFFFE); \
+        PD_TARGET_ALIGN_CHECK("jalr unaligned access") \
+        write_rf(d->rd, (pc + d->isz)); \
+        PD_NEXT \
+    PD_OP(op_lui) \
+        write_rf(d->rd, d->imm); \
+        next_pc = (pc + d->isz); \
+        PD_NEXT \
+    PD_OP(op_auipc) \
+        write_rf(d->rd, (d->imm + pc)); \
+        next_pc = (pc + d->isz); \
+        PD_NEXT \
+    CASE_PD_ALU_REG(mul) \
+    CASE_PD_ALU_REG(mulh) \
+    CASE_PD_ALU_REG(mulhsu) \
+    CASE_PD_ALU_REG(mulhu) \
+    CASE_PD_ALU_REG(div) \
+    CASE_PD_ALU_REG(divu) \
+    CASE_PD_ALU_REG(rem) \
+    CASE_PD_ALU_REG(remu) \
+    CASE_PD_ALU_REG(max) \
+    CASE_PD_ALU_REG(maxu) \
+    CASE_PD_ALU_REG(min) \
+    CASE_PD_ALU_REG(minu)
+
+#ifdef DECODE_CACHE_EN
+#define DC_STORE(addr, size) dc.invalidate((addr), (size));
+#else
+#define DC_STORE(addr, size)
+#endif
+
 #define SIM_ERROR std::cerr << "\n >> SIM RUNTIME ERROR: "
 #define SIM_WARNING std::cout << "\n >> SIM RUNTIME WARNING: "
 #define DASM_TRAP dasm.asm_ss << "Instruction trapped: "
@@ -434,6 +598,12 @@
              << std::right << std::setw(8) << std::setfill('0') \
              << it->second.value << std::dec << std::setfill(' ')
 
+// padding before the register/memory update in the text log, so updates
+// line up in one column for any instruction width and text length
+inline int32_t dasm_align_w(uint32_t inst_w, int32_t text_len) {
+    return 38 - TO_I32(inst_w) - text_len;
+}
+
 #ifdef DASM_EN
 // FIXME: need to differentiate names between macros that redirect to dasm and
 // those that are just formatting string or accessing registers
@@ -447,11 +617,13 @@
 #define DASM_OP(o) dasm.op = #o;
 
 #define DASM_CSR_REG \
+    if (dasm.en) \
     dasm.asm_ss << dasm.op << " " << rf_names[ip.rd()][rf_names_idx] << "," \
                 << csr.at(TO_U16(ip.csr_addr())).name << "," \
                 << rf_names[ip.rs1()][rf_names_idx];
 
 #define DASM_CSR_IMM \
+    if (dasm.en) \
     dasm.asm_ss << dasm.op << " " << rf_names[ip.rd()][rf_names_idx] << "," \
                 << csr.at(TO_U16(ip.csr_addr())).name << "," \
                 << ip.uimm_csr();
@@ -469,7 +641,8 @@
     rf_names[ip.c_regl()][rf_names_idx]
 
 #define DASM_ALIGN \
-    dasm.asm_ss << std::setw(38 - TO_I32(inst_w) - TO_I32(dasm.asm_ss.tellp()))\
+    dasm.asm_ss << std::setw( \
+                       dasm_align_w(inst_w, TO_I32(dasm.asm_ss.tellp()))) \
                 << std::setfill(' ') << "  "
 
 // parametrized
@@ -657,7 +830,8 @@ inline std::string dasm_ascii_hint(int32_t val, uint32_t addr) {
 
 #define PROF_DMEM(size) \
     prof.te.dmem_size = TO_U8(size); \
-    prof.te.dmem = addr;
+    prof.te.dmem = addr; \
+    prof_perf.set_dmem(addr);
 
 // cosim collects these from RTL, don't count on the isa sim side
 #ifndef DPI
@@ -31,6 +31,16 @@ void clint::update_mtime() {
     update_mtime(1);
 }
 
+// steps until mtime >= mtimecmp, counting the step that gets there
+uint64_t clint::steps_to_mtip() {
+    uint64_t mtime = dev::rd_64(MTIME);
+    uint64_t mtimecmp = dev::rd_64(MTIMECMP);
+    if (mtime >= mtimecmp) return 1;
+    uint64_t diff = (mtimecmp - mtime);
+    if (diff > (UINT64_MAX / 100)) return UINT64_MAX; // never, in practice
+    return ((diff * 100) - mtime_ticks);
+}
+
 uint64_t clint::rd_64(uint32_t address) {
     if ((address >= MTIMECMP) && (address < MTIME + 8)) {
         return dev::rd_64(address);
@@ -47,3 +57,13 @@ void clint::wr_64(uint32_t address, uint64_t data) {
         tu->e_dmem_access_fault(address, "clint: write error", mem_op_t::write);
     }
 }
+
+void clint::save(ckpt_out& out) {
+    dev::save(out);
+    out.put(mtime_ticks);
+}
+
+void clint::restore(ckpt_in& in) {
+    dev::restore(in);
+    mtime_ticks = in.get<uint64_t>();
+}
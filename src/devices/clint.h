@@ -22,4 +22,9 @@ class clint : public dev {
         void set_mip(uint32_t* csr_mip);
         void update_mtime(uint64_t mtime_elapsed);
         void update_mtime();
+        // steps until the next mtime increment
+        uint64_t steps_to_mtime_inc() { return (100 - mtime_ticks); }
+        uint64_t steps_to_mtip();
+        virtual void save(ckpt_out& out) override;
+        virtual void restore(ckpt_in& in) override;
 };
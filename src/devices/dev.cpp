@@ -93,3 +93,11 @@ inline void dev::wr_64(uint32_t addr, uint64_t data) {
     mem[addr + 6] = TO_U8(data >> 48);
     mem[addr + 7] = TO_U8(data >> 56);
 }
+
+void dev::save(ckpt_out& out) {
+    out.put_vec(mem);
+}
+
+void dev::restore(ckpt_in& in) {
+    in.get_vec(mem);
+}
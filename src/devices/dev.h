@@ -1,6 +1,7 @@
 #pragma once
 
 #include "defines.h"
+#include "checkpoint.h"
 
 class dev {
     protected:
@@ -20,4 +21,6 @@ class dev {
         virtual void wr_16(uint32_t addr, uint16_t data);
         virtual void wr_32(uint32_t addr, uint32_t data);
         virtual void wr_64(uint32_t addr, uint64_t data);
+        virtual void save(ckpt_out& out);
+        virtual void restore(ckpt_in& in);
 };
@@ -5,8 +5,11 @@
     hw_cfg.icache_sets, \
     hw_cfg.icache_ways, \
     hw_cfg.icache_re_policy, \
+    hw_cfg.icache_rrpv_bits, \
+    hw_cfg.cache_seed, \
     hw_cfg.icache_in_policy, \
     cache_wr_policy_t::none, \
+    TO_U32(__builtin_ctz(size)), \
     "icache"
 
 #define DCACHE_CFG \
@@ -14,29 +17,54 @@
     hw_cfg.dcache_sets, \
     hw_cfg.dcache_ways, \
     hw_cfg.dcache_re_policy, \
+    hw_cfg.dcache_rrpv_bits, \
+    hw_cfg.cache_seed, \
     hw_cfg.dcache_in_policy, \
     hw_cfg.dcache_wr_policy, \
+    TO_U32(__builtin_ctz(size)), \
     "dcache"
 
 main_memory::main_memory(
-    size_t size,
+    uint32_t size,
     std::string test_elf,
     [[maybe_unused]] hw_cfg_t hw_cfg) :
-        dev(size)
+        dev(0), // backed by pages instead
+        mem_size(size),
+        addr_mask(size - 1),
+        pages(size >> mem_map::page_bits)
         #ifdef HW_MODELS_EN
         ,
         icache(ICACHE_CFG),
         dcache(DCACHE_CFG),
+        icache_stack_dist("icache", hw_cfg.cache_stack_dist),
+        dcache_stack_dist("dcache", hw_cfg.cache_stack_dist),
         show_state(hw_cfg.show_cache_state)
         #endif
 {
+    fill_page.fill(fill);
     burn_elf(test_elf);
     #ifdef HW_MODELS_EN
     icache.set_roi(hw_cfg.roi_start, hw_cfg.roi_size);
     dcache.set_roi(hw_cfg.roi_start, hw_cfg.roi_size);
+    icache_sweep.reserve(hw_cfg.icache_sweep.size());
+    for (const auto& c : hw_cfg.icache_sweep) {
+        icache_sweep.emplace_back(
+            cache_type_t::inst, c.sets, c.ways, c.re_policy,
+            hw_cfg.icache_rrpv_bits, hw_cfg.cache_seed, c.in_policy,
+            cache_wr_policy_t::none, TO_U32(__builtin_ctz(size)), c.name);
+    }
+    dcache_sweep.reserve(hw_cfg.dcache_sweep.size());
+    for (const auto& c : hw_cfg.dcache_sweep) {
+        dcache_sweep.emplace_back(
+            cache_type_t::data, c.sets, c.ways, c.re_policy,
+            hw_cfg.dcache_rrpv_bits, hw_cfg.cache_seed, c.in_policy,
+            c.wr_policy, TO_U32(__builtin_ctz(size)), c.name);
+    }
     #if CACHE_MODE == CACHE_MODE_FUNC
     icache.set_mem(this);
     dcache.set_mem(this);
+    for (auto& c : icache_sweep) c.set_mem(this);
+    for (auto& c : dcache_sweep) c.set_mem(this);
     #endif
     #endif
 }
@@ -50,17 +78,19 @@ void main_memory::burn_bin(std::string test_bin) {
     }
 
     size_t file_size = bin_file.tellg();
-    if (file_size > mem_map::mem_size) {
+    if (file_size > mem_size) {
         std::cerr << "ERROR: File size is greater than memory size."
                   << " Binary size: " << file_size << "B"
-                  << " Memory size: " << mem_map::mem_size << "B"
+                  << " Memory size: " << mem_size << "B"
                   << " Binary not loaded" << std::endl;
         throw std::runtime_error("File size is greater than memory size.");
     }
 
+    std::vector<char> buf(file_size);
     bin_file.seekg(0, std::ios::beg);
-    bin_file.read(reinterpret_cast<char*>(mem.data()), file_size);
+    bin_file.read(buf.data(), file_size);
     bin_file.close();
+    burn(0, buf.data(), file_size);
 }
 
 void main_memory::burn_elf(std::string test_elf) {
@@ -76,17 +106,17 @@ void main_memory::burn_elf(std::string test_elf) {
         if (seg->get_type() != ELFIO::PT_LOAD) continue;
         load_seg = seg.get();
         uint64_t paddr = load_seg->get_physical_address();
-        uint64_t size = load_seg->get_file_size();
+        uint64_t seg_size = load_seg->get_file_size();
         if ((paddr < mem_map::base_addr) ||
-            ((paddr + size) > (mem_map::base_addr + mem_map::mem_size)))
+            ((paddr + seg_size) > (mem_map::base_addr + mem_size)))
         {
                 std::cerr << "ELF segment out of bounds: " << std::hex
                           << "paddr = 0x" << paddr
-                          << " size = 0x" << size << std::dec << std::endl;
+                          << " size = 0x" << seg_size << std::dec << std::endl;
                 throw std::runtime_error("ELF segment out of memory range");
             }
         uint64_t off = (paddr - mem_map::base_addr);
-        std::memcpy(&mem[off], seg->get_data(), size);
+        burn(TO_U32(off), seg->get_data(), seg_size);
 
         // permissions
         uint32_t flags = seg->get_flags();
@@ -102,10 +132,10 @@ void main_memory::burn_elf(std::string test_elf) {
     }
 
     // implicit stack/heap region: everything above loaded segments is rw-
-    if (end_of_loaded < mem_map::mem_size) {
+    if (end_of_loaded < mem_size) {
         regions.push_back({
             end_of_loaded,
-            (mem_map::mem_size - end_of_loaded),
+            (mem_size - end_of_loaded),
             true, true, false
         });
     }
@@ -156,6 +186,27 @@ void main_memory::burn_elf(std::string test_elf) {
     uint16_t idx = 1; // 0th index is reserved
     for (const auto& sym : symbol_map) symbol_map[sym.first].idx = idx++;
 
+    // pc to symbol lookup over executable regions, profilers resolve the
+    // callstack with a single read instead of a map search
+    for (const auto& rgn : regions) {
+        if (!rgn.x || symbol_map.empty()) continue;
+        symbol_pc_lut_t lut;
+        lut.base = (mem_map::base_addr + rgn.base);
+        lut.size = rgn.size;
+        lut.idx.resize((rgn.size + 1) >> 1);
+        auto it = symbol_map.upper_bound(lut.base);
+        uint16_t sym = 0;
+        if (it != symbol_map.begin()) sym = std::prev(it)->second.idx;
+        for (uint32_t i = 0; i < lut.idx.size(); i++) {
+            uint32_t pc = (lut.base + (i << 1));
+            for (; (it != symbol_map.end()) && (it->first <= pc); it++) {
+                sym = it->second.idx;
+            }
+            lut.idx[i] = sym;
+        }
+        symbol_pc_lut.push_back(std::move(lut));
+    }
+
     //for (const auto& sym : symbol_map) {
     //    std::cout << std::setw(3) << std::setfill(' ')
     //              << TO_U32(sym.second.idx)
@@ -185,10 +236,171 @@ void main_memory::check_access(
     }
 }
 
+void main_memory::burn(uint32_t off, const char* data, size_t len) {
+    while (len > 0) {
+        uint32_t in_page = (off & mem_map::page_mask);
+        size_t n = std::min<size_t>(len, (mem_map::page_size - in_page));
+        std::memcpy((page_wr(off) + in_page), data, n);
+        off += TO_U32(n);
+        data += n;
+        len -= n;
+    }
+}
+
+// copy of the fill page on the first write
+uint8_t* main_memory::page_wr(uint32_t off) {
+    auto& p = pages[(off & addr_mask) >> mem_map::page_bits];
+    if (p == nullptr) {
+        p = std::make_unique<uint8_t[]>(mem_map::page_size);
+        std::memcpy(p.get(), fill_page.data(), mem_map::page_size);
+    }
+    return p.get();
+}
+
+// little-endian, byte by byte if the access crosses a page (rvc fetch only)
+uint64_t main_memory::rd_n(uint32_t addr, uint32_t n) {
+    uint64_t data = 0;
+    uint32_t in_page = (addr & mem_map::page_mask);
+    if ((in_page + n) <= mem_map::page_size) {
+        const uint8_t* p = (page_rd(addr) + in_page);
+        for (uint32_t i = 0; i < n; i++) data |= (TO_U64(p[i]) << (8 * i));
+    } else {
+        for (uint32_t i = 0; i < n; i++) {
+            data |= (TO_U64(rd_8(addr + i)) << (8 * i));
+        }
+    }
+    return data;
+}
+
+void main_memory::wr_n(uint32_t addr, uint64_t data, uint32_t n) {
+    uint32_t in_page = (addr & mem_map::page_mask);
+    if ((in_page + n) <= mem_map::page_size) {
+        uint8_t* p = (page_wr(addr) + in_page);
+        for (uint32_t i = 0; i < n; i++) p[i] = TO_U8(data >> (8 * i));
+    } else {
+        for (uint32_t i = 0; i < n; i++) {
+            wr_8((addr + i), TO_U8(data >> (8 * i)));
+        }
+    }
+}
+
+uint8_t main_memory::rd_8(uint32_t addr) {
+    return page_rd(addr)[addr & mem_map::page_mask];
+}
+
+uint16_t main_memory::rd_16(uint32_t addr) { return TO_U16(rd_n(addr, 2)); }
+uint32_t main_memory::rd_32(uint32_t addr) { return TO_U32(rd_n(addr, 4)); }
+uint64_t main_memory::rd_64(uint32_t addr) { return rd_n(addr, 8); }
+
+void main_memory::wr_8(uint32_t addr, uint8_t data) {
+    page_wr(addr)[addr & mem_map::page_mask] = data;
+}
+
+void main_memory::wr_16(uint32_t addr, uint16_t data) { wr_n(addr, data, 2); }
+void main_memory::wr_32(uint32_t addr, uint32_t data) { wr_n(addr, data, 4); }
+void main_memory::wr_64(uint32_t addr, uint64_t data) { wr_n(addr, data, 8); }
+
+// regions are saved only to catch a checkpoint from a different elf
+void main_memory::save(ckpt_out& out) {
+    out.put(mem_size);
+    out.put(TO_U32(regions.size()));
+    for (const auto& rgn : regions) {
+        out.put(rgn.base);
+        out.put(rgn.size);
+        out.put(rgn.perm());
+    }
+    uint32_t allocated = TO_U32(std::count_if(
+        pages.begin(), pages.end(), [](const auto& p) { return p != nullptr; }
+    ));
+    out.put(allocated);
+    for (uint32_t i = 0; i < pages.size(); i++) {
+        if (pages[i] == nullptr) continue;
+        out.put(i);
+        out.put_bytes(pages[i].get(), mem_map::page_size);
+    }
+}
+
+void main_memory::restore(ckpt_in& in) {
+    uint32_t size = in.get<uint32_t>();
+    if (size != mem_size) {
+        std::cerr << "ERROR: Checkpoint memory size " << size
+                  << "B doesn't match --mem_size " << mem_size << "B"
+                  << std::endl;
+        in.error("memory size mismatch");
+    }
+    bool same_regions = (in.get<uint32_t>() == regions.size());
+    for (const auto& rgn : regions) {
+        if (!same_regions) break;
+        uint32_t base = in.get<uint32_t>();
+        uint32_t rsize = in.get<uint32_t>();
+        uint8_t perm = in.get<uint8_t>();
+        same_regions = (
+            (base == rgn.base) && (rsize == rgn.size) &&
+            (perm == rgn.perm())
+        );
+    }
+    if (!same_regions) in.error("saved from a different elf");
+
+    for (auto& p : pages) p.reset();
+    uint32_t allocated = in.get<uint32_t>();
+    for (uint32_t i = 0; i < allocated; i++) {
+        uint32_t page = in.get<uint32_t>();
+        if (page >= pages.size()) in.error("page out of range");
+        in.get_bytes(page_wr(page << mem_map::page_bits), mem_map::page_size);
+    }
+}
+
+#ifdef HW_MODELS_EN
+// cold cache if the checkpoint has none or one of a different geometry
+// memory is always written first, so a cold cache is still coherent
+void main_memory::restore_cache(
+    ckpt_in& in, cache& c, const std::string& tag)
+{
+    if (in.restore_opt(tag, [&]() { return c.restore(in); })) return;
+    SIM_WARNING << "Checkpoint has no matching " << tag
+                << " state, starting cold\n";
+}
+
+void main_memory::log_stack_dist(std::string out_dir) {
+    if (!icache_stack_dist.is_en()) return;
+    std::ofstream ofs(out_dir + "stack_dist.json");
+    ofs << "{\n\"line_size\": " << cache_cfg::line_size << ",\n";
+    icache_stack_dist.log(ofs);
+    ofs << ",\n";
+    dcache_stack_dist.log(ofs);
+    ofs << "\n}\n";
+}
+#endif
+
+#ifdef SOFT_TLB_EN
+// host pointer to the page at off, if every byte passes check_access
+// reads only map pages that were already written, fill page is shared
+uint8_t* main_memory::page_ptr(uint32_t off, bool is_w) {
+    for (const auto& rgn : regions) {
+        bool overlap = (
+            (off < (rgn.base + rgn.size)) &&
+            ((off + mem_map::page_size) > rgn.base)
+        );
+        if (overlap && !(is_w ? rgn.w : rgn.r)) return nullptr;
+    }
+    if (is_w) return page_wr(off);
+    return pages[off >> mem_map::page_bits].get();
+}
+#endif
+
 uint32_t main_memory::rd_inst(norm_address_t addr) {
     check_access(addr, false, false, true);
-    uint32_t inst = dev::rd_32(addr.v);
+    uint32_t inst = rd_32(addr.v);
     #ifdef HW_MODELS_EN
+    if (!cache_bypass) inst_ref(addr, inst);
+    #endif
+    return inst;
+}
+
+#ifdef HW_MODELS_EN
+void main_memory::inst_ref(
+    norm_address_t addr, [[maybe_unused]] uint32_t inst)
+{
     #if CACHE_MODE == CACHE_MODE_FUNC and defined(CACHE_VERIFY)
     uint32_t inst_ic = icache.rd(addr, 4);
     if (inst_ic != inst) {
@@ -203,12 +415,54 @@ uint32_t main_memory::rd_inst(norm_address_t addr) {
     #else
     icache.rd(addr, 4);
     #endif
+    for (auto& c : icache_sweep) c.rd(addr, 4);
+    if (icache_stack_dist.is_en()) icache_stack_dist.reference(addr);
+    if (hw_trace != nullptr) hw_trace->fetch(addr);
+}
+
+void main_memory::data_rd_ref(
+    norm_address_t addr, [[maybe_unused]] uint32_t data, uint32_t size)
+{
+    #if CACHE_MODE == CACHE_MODE_FUNC and defined(CACHE_VERIFY)
+    uint32_t data_dc = dcache.rd(addr, size);
+    if (data_dc != data) {
+        std::cerr << "ERROR: Data cache and memory mismatch."
+                  << " Address: 0x" << std::hex << to_full(addr)
+                  << " dcache: 0x" << data_dc
+                  << " Memory: 0x" << data
+                  << std::endl;
+        dcache.dump();
+        throw std::runtime_error("Data cache and memory mismatch.");
+    }
+    #else
+    dcache.rd(addr, size);
     #endif
-    return inst;
+    for (auto& c : dcache_sweep) c.rd(addr, size);
+    if (dcache_stack_dist.is_en()) dcache_stack_dist.reference(addr);
+    if (hw_trace != nullptr) hw_trace->data(hw_trace_ev_t::rd, addr, size);
+}
+
+void main_memory::data_wr_ref(
+    norm_address_t addr, uint32_t data, uint32_t size)
+{
+    dcache.wr(addr, data, size);
+    for (auto& c : dcache_sweep) c.wr(addr, data, size);
+    if (dcache_stack_dist.is_en()) dcache_stack_dist.reference(addr);
+    if (hw_trace != nullptr) hw_trace->data(hw_trace_ev_t::wr, addr, size);
 }
 
-#ifdef HW_MODELS_EN
 scp_status_t main_memory::scp(norm_address_t addr, scp_mode_t scp_mode) {
+    // hint ignored while caches are bypassed, as if they were not simulated
+    if (cache_bypass) return scp_status_t::fail;
+    if (hw_trace != nullptr) {
+        hw_trace->data(hw_trace_ev_t::scp, addr, TO_U32(scp_mode));
+    }
+    // sweep caches follow the hints only where scp lines are possible
+    for (auto& c : dcache_sweep) {
+        if (c.is_direct_mapped()) continue;
+        if (scp_mode == scp_mode_t::m_lcl) c.scp_lcl(addr);
+        else if (scp_mode == scp_mode_t::m_rel) c.scp_rel(addr);
+    }
     if (scp_mode == scp_mode_t::m_lcl) return dcache.scp_lcl(addr);
     else if (scp_mode == scp_mode_t::m_rel) return dcache.scp_rel(addr);
     else throw std::runtime_error("ERROR: Invalid cache hint mode");
@@ -220,20 +474,7 @@ uint32_t main_memory::rd(uint32_t addr, uint32_t size) {
     check_access(naddr, true, false, false);
     uint32_t data = dev::rd(addr, size);
     #ifdef HW_MODELS_EN
-    #if CACHE_MODE == CACHE_MODE_FUNC and defined(CACHE_VERIFY)
-    uint32_t data_dc = dcache.rd(naddr, size);
-    if (data_dc != data) {
-        std::cerr << "ERROR: Data cache and memory mismatch."
-                  << " Address: 0x" << std::hex << to_full(naddr)
-                  << " dcache: 0x" << data_dc
-                  << " Memory: 0x" << data
-                  << std::endl;
-        dcache.dump();
-        throw std::runtime_error("Data cache and memory mismatch.");
-    }
-    #else
-    dcache.rd(naddr, size);
-    #endif
+    if (!cache_bypass) data_rd_ref(naddr, data, size);
     #endif
     return data;
 }
@@ -246,7 +487,7 @@ void main_memory::wr(uint32_t addr, uint32_t data, uint32_t size) {
     // against memory on write-through / writeback)
     dev::wr(addr, data, size);
     #ifdef HW_MODELS_EN
-    dcache.wr(naddr, data, size);
+    if (!cache_bypass) data_wr_ref(naddr, data, size);
     #endif
 }
 
@@ -6,38 +6,93 @@
 #include "external/ELFIO/elfio/elfio.hpp"
 #ifdef HW_MODELS_EN
 #include "cache.h"
+#include "stack_dist.h"
+#include "hw_trace.h"
 #endif
 
 struct mem_region_t {
     uint32_t base; // offset from mem_map::base_addr
     uint32_t size;
     bool r, w, x;
+    uint8_t perm() const { return TO_U8((r << 2) | (w << 1) | TO_U8(x)); }
 };
 
+/*
+Sparse main memory
+- backed by pages allocated on the first write, so startup time and host
+  memory scale with what the workload touches, not with the memory size
+- untouched pages read as the fill pattern, from a single shared page
+- offsets wrap at size, size is a power of 2
+*/
 class main_memory : public dev {
+    private:
+        static constexpr uint8_t fill = 0xA5; // uninitialized memory pattern
+        const uint32_t mem_size;
+        const uint32_t addr_mask;
+        std::vector<std::unique_ptr<uint8_t[]>> pages;
+        std::array<uint8_t, mem_map::page_size> fill_page;
+
     private:
         void burn_bin(std::string test_bin);
         void burn_elf(std::string test_elf);
+        void burn(uint32_t off, const char* data, size_t len);
         void check_access(
             norm_address_t addr, bool is_r, bool is_w, bool is_x) const;
+        const uint8_t* page_rd(uint32_t off) const {
+            uint32_t page = ((off & addr_mask) >> mem_map::page_bits);
+            const uint8_t* p = pages[page].get();
+            return (p != nullptr) ? p : fill_page.data();
+        }
+        uint8_t* page_wr(uint32_t off);
+        uint64_t rd_n(uint32_t addr, uint32_t n);
+        void wr_n(uint32_t addr, uint64_t data, uint32_t n);
         std::vector<mem_region_t> regions;
         std::map<uint32_t, symbol_map_entry_t> symbol_map;
+        std::vector<symbol_pc_lut_t> symbol_pc_lut;
         #ifdef HW_MODELS_EN
         cache icache;
         cache dcache;
+        // see the same accesses as the caches above, for stats only
+        std::vector<cache> icache_sweep;
+        std::vector<cache> dcache_sweep;
+        stack_dist icache_stack_dist;
+        stack_dist dcache_stack_dist;
         const bool show_state;
+        bool cache_bypass = false; // e.g. while fast-forwarding
+        hw_trace_out* hw_trace = nullptr; // only if recording
+        void restore_cache(ckpt_in& in, cache& c, const std::string& tag);
+        // all caches, stack distance and trace see the same references
+        void inst_ref(norm_address_t addr, uint32_t inst);
+        void data_rd_ref(norm_address_t addr, uint32_t data, uint32_t size);
+        void data_wr_ref(norm_address_t addr, uint32_t data, uint32_t size);
         #endif
 
     public:
         main_memory() = delete;
-        main_memory(size_t size, std::string test_elf, hw_cfg_t hw_cfg);
-        std::map<uint32_t, symbol_map_entry_t> get_symbol_map() {
+        main_memory(uint32_t size, std::string test_elf, hw_cfg_t hw_cfg);
+        const std::map<uint32_t, symbol_map_entry_t>& get_symbol_map() const {
             return symbol_map;
         }
+        const std::vector<symbol_pc_lut_t>& get_symbol_pc_lut() const {
+            return symbol_pc_lut;
+        }
         uint32_t rd_inst(norm_address_t addr);
         uint32_t just_inst(norm_address_t addr) { return dev::rd(addr.v, 4); }
+        #ifdef SOFT_TLB_EN
+        uint8_t* page_ptr(uint32_t off, bool is_w);
+        #endif
         virtual uint32_t rd(uint32_t addr, uint32_t size) override;
         virtual void wr(uint32_t addr, uint32_t data, uint32_t size) override;
+        virtual uint8_t rd_8(uint32_t addr) override;
+        virtual uint16_t rd_16(uint32_t addr) override;
+        virtual uint32_t rd_32(uint32_t addr) override;
+        virtual uint64_t rd_64(uint32_t addr) override;
+        virtual void wr_8(uint32_t addr, uint8_t data) override;
+        virtual void wr_16(uint32_t addr, uint16_t data) override;
+        virtual void wr_32(uint32_t addr, uint32_t data) override;
+        virtual void wr_64(uint32_t addr, uint64_t data) override;
+        virtual void save(ckpt_out& out) override;
+        virtual void restore(ckpt_in& in) override;
         std::array<uint8_t, cache_cfg::line_size> rd_line(norm_address_t addr);
         void wr_line(
             norm_address_t addr,
@@ -45,29 +100,83 @@ class main_memory : public dev {
         );
         #ifdef HW_MODELS_EN
         scp_status_t scp(norm_address_t addr, scp_mode_t scp_mode);
+        void set_cache_bypass(bool bypass) {
+            if (hw_trace != nullptr) {
+                hw_trace->state(hw_trace_ev_t::bypass, bypass);
+            }
+            cache_bypass = bypass;
+        }
+        void set_hw_trace(hw_trace_out* t) { hw_trace = t; }
+        // references from a HW trace, memory is not accessed
+        void replay_inst(norm_address_t addr) {
+            if (!cache_bypass) inst_ref(addr, 0);
+        }
+        void replay_rd(norm_address_t addr, uint32_t size) {
+            data_rd_ref(addr, 0, size);
+        }
+        void replay_wr(norm_address_t addr, uint32_t size) {
+            data_wr_ref(addr, 0, size);
+        }
         void cache_profiling(bool enable) {
             icache.profiling(enable);
             dcache.profiling(enable);
+            for (auto& c : icache_sweep) c.profiling(enable);
+            for (auto& c : dcache_sweep) c.profiling(enable);
+            icache_stack_dist.profiling(enable);
+            dcache_stack_dist.profiling(enable);
         }
         void speculative_exec(speculative_t smode) {
             icache.speculative_exec(smode);
             dcache.speculative_exec(smode);
+            for (auto& c : icache_sweep) c.speculative_exec(smode);
+            for (auto& c : dcache_sweep) c.speculative_exec(smode);
         }
+        cache_cnt_t icache_cnt() const { return icache.get_cnt(); }
+        cache_cnt_t dcache_cnt() const { return dcache.get_cnt(); }
         void log_cache_stats(std::ofstream& hw_ofs, uint64_t profiled_insts) {
            icache.summarize_stats(profiled_insts);
            dcache.summarize_stats(profiled_insts);
            icache.log_stats(hw_ofs);
            dcache.log_stats(hw_ofs);
+           for (auto& c : icache_sweep) {
+               c.summarize_stats(profiled_insts);
+               c.log_stats(hw_ofs);
+           }
+           for (auto& c : dcache_sweep) {
+               c.summarize_stats(profiled_insts);
+               c.log_stats(hw_ofs);
+           }
         }
+        void log_stack_dist(std::string out_dir);
         void set_cache_hws(hw_status_t* ic, hw_status_t* dc) {
             icache.set_hws(ic);
             dcache.set_hws(dc);
         }
+        void save_caches(ckpt_out& out) {
+            out.begin("icache");
+            icache.save(out);
+            out.end();
+            out.begin("dcache");
+            dcache.save(out);
+            out.end();
+        }
+        void restore_caches(ckpt_in& in) {
+            restore_cache(in, icache, "icache");
+            restore_cache(in, dcache, "dcache");
+        }
         void finish(uint64_t profiled_insts) {
             icache.summarize_stats(profiled_insts);
             dcache.summarize_stats(profiled_insts);
             icache.show_stats(show_state);
             dcache.show_stats(show_state);
+            for (auto& c : icache_sweep) {
+                c.summarize_stats(profiled_insts);
+                c.show_stats(false);
+            }
+            for (auto& c : dcache_sweep) {
+                c.summarize_stats(profiled_insts);
+                c.show_stats(false);
+            }
         }
         #if CACHE_MODE == CACHE_MODE_FUNC
         uint32_t align_to_cache_line(uint32_t addr) {
@@ -102,5 +102,18 @@ void uart::update_input(uint64_t time) {
     #endif
     refresh_meip();
 }
+
+// position in the preloaded input, live stdin input is not replayed
+void uart::save(ckpt_out& out) {
+    dev::save(out);
+    out.put(TO_U64(uart_in_idx));
+    out.put(next_rx_time);
+}
+
+void uart::restore(ckpt_in& in) {
+    dev::restore(in);
+    uart_in_idx = in.get<uint64_t>();
+    next_rx_time = in.get<uint64_t>();
+}
 #endif // UART_INPUT_EN
 #endif // DPI
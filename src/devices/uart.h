@@ -2,6 +2,7 @@
 
 #include "defines.h"
 #include "dev.h"
+#include "async_out.h"
 
 enum class uart_baud_rate {
     _9600 = 9600,
@@ -22,7 +23,11 @@ class uart : public dev {
         static const uint8_t UART_STATUS = 0x00;
         static const uint8_t UART_RX_DATA = 0x04;
         static const uint8_t UART_TX_DATA = 0x08;
-        std::ofstream uart_ofs;
+        #ifdef DPI
+        std::ofstream uart_ofs; // flushed per character, see UART_FLUSH
+        #else
+        async_ofstream uart_ofs;
+        #endif
         const bool uart_show;
 
         #ifndef DPI
@@ -52,6 +57,9 @@ class uart : public dev {
         uint32_t rd(uint32_t address, uint32_t size) override;
         void set_mip(uint32_t* csr_mip) { this->csr_mip = csr_mip; }
         void update_input(uint64_t time);
+        uint64_t get_next_rx_time() { return next_rx_time; }
+        virtual void save(ckpt_out& out) override;
+        virtual void restore(ckpt_in& in) override;
         #endif
         #endif
 };
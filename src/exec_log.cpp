@@ -0,0 +1,72 @@
+#include "exec_log.h"
+
+void exec_log_out::open(std::string path, const std::string& meta) {
+    ts.open(path, trace_stream_t::exec_log, TO_U32(el_col_t::_count));
+    entry_str(0, exec_log_t::meta, meta);
+}
+
+void exec_log_out::resume(const std::array<int32_t, 32>& rf) {
+    for (uint32_t i = 1; i < 32; i++) rf_last[i] = TO_U32(rf[i]);
+    resync = true;
+}
+
+void exec_log_out::begin(uint64_t cnt, uint8_t type) {
+    if (ts.chunk_start()) {
+        // each chunk decodes on its own
+        cnt_last = 0;
+        pc_last = 0;
+        resync = true;
+    }
+    ts.begin(cnt);
+    if (resync) type |= exec_log_cfg::flag_rf;
+    col_u8(el_col_t::type, type);
+    ts.varint(TO_U32(el_col_t::cnt), (cnt - cnt_last));
+    cnt_last = cnt;
+    if (resync) {
+        for (uint32_t i = 1; i < 32; i++) col_u32(el_col_t::rf, rf_last[i]);
+        resync = false;
+    }
+}
+
+void exec_log_out::inst(
+    uint64_t cnt, bool cnt_en, uint32_t pc, uint32_t inst,
+    const std::array<int32_t, 32>& rf, uint8_t hm, bool aux_en, uint32_t aux)
+{
+    uint8_t type = TO_U8(exec_log_t::inst);
+    if (cnt_en) type |= exec_log_cfg::flag_cnt;
+    if (aux_en) type |= exec_log_cfg::flag_aux;
+    begin(cnt, type);
+    ts.zigzag(TO_U32(el_col_t::pc), (pc - pc_last));
+    pc_last = pc;
+    col_u32(el_col_t::inst, inst);
+
+    // at most rd and its pair change
+    uint8_t rd = 0;
+    uint8_t rdp = 0;
+    for (uint32_t i = 1; i < 32; i++) {
+        if (TO_U32(rf[i]) == rf_last[i]) continue;
+        if (!rd) rd = TO_U8(i);
+        else if (!rdp) rdp = TO_U8(i);
+        else resync = true; // not expected, next entry brings the rf
+        rf_last[i] = TO_U32(rf[i]);
+    }
+    col_u8(el_col_t::rd, rd);
+    if (rd) col_u32(el_col_t::rd_val, rf_last[rd]);
+    col_u8(el_col_t::rdp, rdp);
+    if (rdp) col_u32(el_col_t::rdp_val, rf_last[rdp]);
+    if (aux_en) col_u32(el_col_t::aux, aux);
+    col_u8(el_col_t::hm, hm);
+    ts.end();
+}
+
+void exec_log_out::entry_str(
+    uint64_t cnt, exec_log_t type, const std::string& str) {
+    begin(cnt, TO_U8(type));
+    ts.varint(TO_U32(el_col_t::text), str.size());
+    for (char c : str) col_u8(el_col_t::text, TO_U8(c));
+    ts.end();
+}
+
+void exec_log_out::finish() {
+    ts.finish();
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include "defines.h"
+#include "trace_stream.h"
+
+enum class exec_log_t : uint8_t { inst, text, meta };
+
+namespace exec_log_cfg {
+    constexpr uint8_t type_mask = 0x3;
+    constexpr uint8_t flag_cnt = (1u << 2); // inst count shown
+    constexpr uint8_t flag_aux = (1u << 3); // csr value after the inst
+    constexpr uint8_t flag_rf = (1u << 4); // rf snapshot before the entry
+}
+
+enum class el_col_t : uint32_t {
+    type, cnt, pc, inst, rd, rd_val, rdp, rdp_val, aux, hm, text, rf, _count
+};
+
+/*
+Binary exec log, rendered to the 'exec.log' text by script/exec_log.py
+- one entry per logged instruction: pc and inst, registers it changed and
+  their new values, csr value for csr instructions, hw model hit/miss flags
+- operands, memory addresses and simd lanes in the text all follow from the
+  instruction and the register file, which the renderer tracks
+- full rf is stored at each chunk start and when logging resumes
+- trap and callstack lines are stored as text, first entry is the metadata
+  the renderer needs (csr names, uart addresses) as json
+- chunked, indexed by instruction count, as trace.bin
+- columns:
+    - type: exec_log_t and flags (u8)
+    - cnt: instruction count delta (varint)
+    - pc: delta from the previous pc (zigzag), inst (u32)
+    - rd, rdp: changed registers, 0 if none (u8), values only if changed (u32)
+    - aux: with flag_aux (u32)
+    - hm: hw_status_t of i$, d$ and bp, 2 bits each (u8)
+    - text: length (varint) and characters
+    - rf: x1 to x31 with flag_rf (u32)
+*/
+class exec_log_out {
+    private:
+        trace_stream_out ts;
+        std::array<uint32_t, 32> rf_last = {};
+        uint64_t cnt_last = 0;
+        uint32_t pc_last = 0;
+        bool resync = true;
+
+    private:
+        void begin(uint64_t cnt, uint8_t type);
+        void entry_str(uint64_t cnt, exec_log_t type, const std::string& str);
+        void col_u8(el_col_t c, uint8_t v) { ts.u8(TO_U32(c), v); }
+        void col_u32(el_col_t c, uint32_t v) { ts.u32(TO_U32(c), v); }
+
+    public:
+        exec_log_out() = default;
+        void open(std::string path, const std::string& meta);
+        bool is_en() const { return ts.is_en(); }
+        // rf before the next logged instruction, after a gap in logging
+        void resume(const std::array<int32_t, 32>& rf);
+        void inst(uint64_t cnt, bool cnt_en, uint32_t pc, uint32_t inst,
+                  const std::array<int32_t, 32>& rf, uint8_t hm,
+                  bool aux_en, uint32_t aux);
+        void text(uint64_t cnt, const std::string& str) {
+            entry_str(cnt, exec_log_t::text, str);
+        }
+        void finish();
+};
@@ -65,6 +65,15 @@ class bp {
 
         virtual void goto_future(uint32_t /* correct_pc */) {}; // ideal bp only
 
+        // predictor state, stats start from scratch
+        virtual void save(ckpt_out& out) {
+            if (pht_ptr != nullptr) pht_ptr->save(out);
+        }
+
+        virtual void restore(ckpt_in& in) {
+            if (pht_ptr != nullptr) pht_ptr->restore(in);
+        }
+
         virtual void dump() {
             if (pht_ptr == nullptr) return;
             std::cout << INDENT << type_name << ": " << std::endl;
@@ -101,6 +110,8 @@ class bp {
             return stats.get_predicted(pc);
         }
 
+        const bp_stats_t& get_stats() const { return stats; }
+
     protected:
         virtual void find_b_dir(uint32_t target_pc, uint32_t pc) {
             b_dir_last = (target_pc > pc) ? b_dir_t::forward :
@@ -61,4 +61,16 @@ class bp_combined : public bp {
             bpsn[1]->dump();
             std::cout << std::dec << std::endl;
         }
+
+        virtual void save(ckpt_out& out) override {
+            pht.save(out);
+            bpsn[0]->save(out);
+            bpsn[1]->save(out);
+        }
+
+        virtual void restore(ckpt_in& in) override {
+            pht.restore(in);
+            bpsn[0]->restore(in);
+            bpsn[1]->restore(in);
+        }
 };
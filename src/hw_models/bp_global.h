@@ -35,4 +35,14 @@ class bp_global : public bp {
             ghr = ((ghr << 1) | taken);
             return (next_pc == predicted_pc);
         }
+
+        virtual void save(ckpt_out& out) override {
+            bp::save(out);
+            out.put(ghr);
+        }
+
+        virtual void restore(ckpt_in& in) override {
+            bp::restore(in);
+            ghr = in.get<uint32_t>();
+        }
 };
@@ -0,0 +1,270 @@
+#include "bp_grid.h"
+
+#define GRID_ERR(name, msg) \
+    std::cerr << "ERROR: " << name << " predictor " << msg << std::endl; \
+    throw std::runtime_error("Invalid branch predictor grid inputs");
+
+// same as summarize() in bp_stats_t
+struct bp_grid_summary_t {
+    uint64_t total;
+    uint64_t predicted;
+    uint64_t mispredicted;
+    float_t accuracy = -1.0;
+    float_t mpki = -1.0;
+    bp_grid_summary_t(uint64_t total, uint64_t mispredicted, uint64_t insts) :
+        total(total),
+        predicted(total - mispredicted),
+        mispredicted(mispredicted)
+    {
+        if ((insts == 0) || (total == 0)) return;
+        accuracy = (TO_F32(predicted) / TO_F32(total) * 100.0f);
+        mpki = 0;
+        if (mispredicted == 0) return;
+        mpki = (TO_F32(mispredicted) / (TO_F32(insts) / 1000.0f));
+    }
+};
+
+bp_grid::bp_grid(const std::vector<bp_grid_cfg_t>& cfgs) {
+    // static, then counters only, then local, to keep each loop uniform
+    auto in_group = [](bp_t type, size_t g) {
+        if (type == bp_t::sttc) return (g == 0);
+        if (type == bp_t::local) return (g == 2);
+        return (g == 1);
+    };
+    for (size_t g = 0; g < 3; g++) {
+        for (const auto& c : cfgs) {
+            if (!in_group(c.type, g)) continue;
+            for (auto m : c.static_method)
+            for (auto pc : c.pc_bits)
+            for (auto cnt : c.cnt_bits)
+            for (auto lh : c.lhist_bits)
+            for (auto gh : c.ghr_bits)
+            for (auto f : c.fold_pc) add(c.type, m, pc, cnt, lh, gh, f);
+        }
+        if (g == 0) static_end = names.size();
+        if (g == 1) table_end = names.size();
+    }
+    pc_parts.resize(pc_keys.size(), 0);
+}
+
+uint8_t bp_grid::get_pc_key(uint8_t pc_bits, bp_pc_folds_t fold_pc) {
+    // same number of folds as in bp
+    uint32_t folds = 0;
+    if ((fold_pc == bp_pc_folds_t::all) && (pc_bits > 0)) {
+        folds = TO_U32(
+            (mem_map::addr_bits - inst::align::pc_low_bits) / TO_U32(pc_bits));
+    }
+    std::pair<uint8_t, uint32_t> key = {pc_bits, folds};
+    auto it = std::find(pc_keys.begin(), pc_keys.end(), key);
+    if (it != pc_keys.end()) return TO_U8(it - pc_keys.begin());
+    pc_keys.push_back(key);
+    return TO_U8(pc_keys.size() - 1);
+}
+
+void bp_grid::add(
+    bp_t type, bp_sttc_t m, uint8_t pc_bits, uint8_t cnt_bits,
+    uint8_t lhist_bits, uint8_t ghr_bits, bp_pc_folds_t fold_pc)
+{
+    static const std::map<bp_t, std::string> type_str = {
+        {bp_t::sttc, "static"}, {bp_t::bimodal, "bimodal"},
+        {bp_t::local, "local"}, {bp_t::global, "global"},
+        {bp_t::gselect, "gselect"}, {bp_t::gshare, "gshare"}
+    };
+    static const std::array<std::string, 3> method_str = {"at", "ant", "btfn"};
+    const bool has_pc = ((type != bp_t::sttc) && (type != bp_t::global));
+    const bool has_ghr = ((type == bp_t::global) || (type == bp_t::gselect) ||
+                          (type == bp_t::gshare));
+
+    // e.g. bp_gshare_pc8_ghr8_cnt3_fold_all
+    std::string name = "bp_" + type_str.at(type);
+    if (type == bp_t::sttc) name += "_" + method_str[TO_U8(m)];
+    if (has_pc) name += "_pc" + std::to_string(pc_bits);
+    if (type == bp_t::local) name += "_lhist" + std::to_string(lhist_bits);
+    if (has_ghr) name += "_ghr" + std::to_string(ghr_bits);
+    if (type != bp_t::sttc) name += "_cnt" + std::to_string(cnt_bits);
+    if (has_pc) {
+        name += (fold_pc == bp_pc_folds_t::all) ? "_fold_all" : "_fold_none";
+    }
+    if (std::find(names.begin(), names.end(), name) != names.end()) return;
+    // nothing to fold, same as fold_pc none
+    if ((fold_pc == bp_pc_folds_t::all) && (pc_bits == 0)) return;
+
+    uint8_t idx_bits = 0;
+    uint32_t size_bits = 0;
+    if (type != bp_t::sttc) {
+        if ((cnt_bits == 0) || (cnt_bits > 8)) {
+            GRID_ERR(name, "cnt_bits has to be from 1 to 8");
+        }
+        if (has_pc && (pc_bits == 0) && (type != bp_t::gselect) &&
+            (type != bp_t::gshare)) {
+            GRID_ERR(name, "pc_bits cannot be 0");
+        }
+        switch (type) {
+            case bp_t::bimodal: idx_bits = pc_bits; break;
+            case bp_t::local: idx_bits = lhist_bits; break;
+            case bp_t::global: idx_bits = ghr_bits; break;
+            case bp_t::gselect: idx_bits = TO_U8(pc_bits + ghr_bits); break;
+            default: idx_bits = std::max(pc_bits, ghr_bits); break;
+        }
+        if ((idx_bits == 0) || (idx_bits > 30) || (pc_bits > 30)) {
+            GRID_ERR(name, "index bits have to be from 1 to 30");
+        }
+        size_bits = ((1u << idx_bits) * cnt_bits);
+        if (type == bp_t::local) size_bits += ((1u << pc_bits) * lhist_bits);
+        if (has_ghr) size_bits += ghr_bits;
+    }
+
+    names.push_back(name);
+    type_names.push_back(type_str.at(type));
+    sizes.push_back((type == bp_t::sttc) ? 0 : ((size_bits + 4) >> 3));
+    method.push_back(m);
+    pc_key.push_back(get_pc_key(has_pc ? pc_bits : 0, fold_pc));
+    pc_shift.push_back((type == bp_t::gselect) ? ghr_bits : 0);
+    ghr_mask.push_back(has_ghr ? ((1u << ghr_bits) - 1) : 0);
+    ghr_shift.push_back(((type == bp_t::gshare) && (pc_bits > ghr_bits)) ?
+                        TO_U8(pc_bits - ghr_bits) : 0);
+    idx_mask.push_back((1u << idx_bits) - 1);
+    // same init as bp_pht, weakly taken
+    const uint8_t max = TO_U8((1u << cnt_bits) - 1);
+    const uint8_t thr = ((max == 1) ? max : TO_U8(max >> 1));
+    cnt_max.push_back(max);
+    thr_taken.push_back(thr);
+    pht_off.push_back(TO_U32(pht.size()));
+    if (type != bp_t::sttc) pht.resize(pht.size() + (1u << idx_bits), thr);
+    lhist_off.push_back(TO_U32(lhist.size()));
+    lhist_mask.push_back((1u << lhist_bits) - 1);
+    if (type == bp_t::local) lhist.resize(lhist.size() + (1u << pc_bits), 0);
+    mispredicted[0].push_back(0);
+    mispredicted[1].push_back(0);
+}
+
+void bp_grid::update(bool taken, uint32_t next_pc) {
+    const uint32_t pc = pc_last;
+    // same direction and correctness as bp, target is taken, pc + 4 is not
+    const size_t bwd = (target_last <= pc);
+    const bool correct_t = (next_pc == target_last);
+    const bool correct_nt = (next_pc == (pc + 4));
+    const uint64_t prof = prof_active;
+    const uint32_t tk = taken;
+    branches[bwd] += prof;
+    auto& mis = mispredicted[bwd];
+
+    for (size_t k = 0; k < pc_keys.size(); k++) {
+        const auto [bits, folds] = pc_keys[k];
+        const uint32_t mask = ((1u << bits) - 1);
+        uint32_t part = 0;
+        for (uint32_t p = 0; p <= folds; p++) {
+            part ^= ((pc >> (inst::align::pc_low_bits + (bits * p))) & mask);
+        }
+        pc_parts[k] = part;
+    }
+
+    for (size_t i = 0; i < static_end; i++) {
+        bool pred = ((method[i] == bp_sttc_t::at) ||
+                     ((method[i] == bp_sttc_t::btfn) && bwd));
+        mis[i] += (prof & !(pred ? correct_t : correct_nt));
+    }
+
+    for (size_t i = static_end; i < table_end; i++) {
+        uint32_t idx = (
+            ((pc_parts[pc_key[i]] << pc_shift[i]) ^
+             ((ghr & ghr_mask[i]) << ghr_shift[i])) &
+            idx_mask[i]);
+        uint8_t& cnt = pht[pht_off[i] + idx];
+        bool pred = (cnt >= thr_taken[i]);
+        mis[i] += (prof & !(pred ? correct_t : correct_nt));
+        if (taken) cnt = TO_U8(cnt + (cnt < cnt_max[i]));
+        else cnt = TO_U8(cnt - (cnt > 0));
+    }
+
+    for (size_t i = table_end; i < names.size(); i++) {
+        uint32_t& hist = lhist[lhist_off[i] + pc_parts[pc_key[i]]];
+        uint8_t& cnt = pht[pht_off[i] + hist];
+        bool pred = (cnt >= thr_taken[i]);
+        mis[i] += (prof & !(pred ? correct_t : correct_nt));
+        if (taken) cnt = TO_U8(cnt + (cnt < cnt_max[i]));
+        else cnt = TO_U8(cnt - (cnt > 0));
+        hist = (((hist << 1) | tk) & lhist_mask[i]);
+    }
+
+    ghr = ((ghr << 1) | tk);
+}
+
+std::string bp_grid::ckpt_signature() const {
+    return ("grid:" + std::to_string(names.size()) + ":" +
+            std::to_string(pht.size()) + ":" + std::to_string(lhist.size()));
+}
+
+void bp_grid::save(ckpt_out& out) const {
+    out.put_vec(pht);
+    out.put_vec(lhist);
+    out.put(ghr);
+}
+
+void bp_grid::restore(ckpt_in& in) {
+    in.get_vec(pht);
+    in.get_vec(lhist);
+    ghr = in.get<uint32_t>();
+}
+
+void bp_grid::stats_line(size_t i, std::ostream& os) const {
+    bp_grid_summary_t s(
+        (branches[0] + branches[1]),
+        (mispredicted[0][i] + mispredicted[1][i]),
+        profiled_insts);
+    os << std::left << std::setw(36) << names[i]
+       << " (" << std::right << std::setw(5) << sizes[i] << " B): "
+       << std::fixed << std::setprecision(2)
+       << "P: " << s.predicted
+       << ", M: " << s.mispredicted
+       << ", ACC: " << s.accuracy << "%"
+       << ", MPKI: " << s.mpki;
+}
+
+// best predictor of each type, the rest is in hw_stats.json
+void bp_grid::show_stats() const {
+    std::cout << "Branch predictor grid: " << names.size()
+              << " predictors, best of each type:\n";
+    std::map<std::string, size_t> best;
+    for (size_t i = 0; i < names.size(); i++) {
+        auto it = best.find(type_names[i]);
+        uint64_t m = (mispredicted[0][i] + mispredicted[1][i]);
+        if ((it == best.end()) ||
+            (m < (mispredicted[0][it->second] + mispredicted[1][it->second])))
+        {
+            best[type_names[i]] = i;
+        }
+    }
+    for (const auto& [type, i] : best) {
+        std::cout << INDENT;
+        stats_line(i, std::cout);
+        std::cout << "\n";
+    }
+}
+
+// same entries as the single predictors
+void bp_grid::log_stats(std::ofstream& log_file) const {
+    for (size_t i = 0; i < names.size(); i++) {
+        bp_grid_summary_t s(
+            (branches[0] + branches[1]),
+            (mispredicted[0][i] + mispredicted[1][i]),
+            profiled_insts);
+        log_file << "\"" << names[i] << "\"" << ": {"
+                 << JSON_N << "\"type\": \"" << type_names[i] << "\","
+                 << std::fixed << std::setprecision(2)
+                 << JSON_N << "\"branches\": " << s.total << ","
+                 << JSON_N << "\"predicted\": " << s.predicted << ","
+                 << JSON_N << "\"predicted_fwd\": "
+                 << (branches[0] - mispredicted[0][i]) << ","
+                 << JSON_N << "\"predicted_bwd\": "
+                 << (branches[1] - mispredicted[1][i]) << ","
+                 << JSON_N << "\"mispredicted\": " << s.mispredicted << ","
+                 << JSON_N << "\"mispredicted_fwd\": "
+                 << mispredicted[0][i] << ","
+                 << JSON_N << "\"mispredicted_bwd\": "
+                 << mispredicted[1][i] << ","
+                 << JSON_N << "\"accuracy\": " << s.accuracy << ","
+                 << JSON_N << "\"mpki\": " << s.mpki << ","
+                 << JSON_N << "\"size\": " << sizes[i] << "\n},";
+    }
+}
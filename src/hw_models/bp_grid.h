@@ -0,0 +1,74 @@
+#pragma once
+
+#include "defines.h"
+#include "hw_model_types.h"
+#include "checkpoint.h"
+
+/*
+Grid of branch predictors driven by the same branch stream, stats only
+- static, bimodal, local, global, gselect and gshare, each predictor behaves
+  as its single predictor class with the same parameters
+- kept as struct of arrays so a branch is one pass over plain arrays instead
+  of a virtual call chain per predictor:
+    - counters of all predictors in one table, at per predictor offsets
+    - PC index part computed once per distinct pc_bits/fold_pc
+    - one global history for all, it only depends on the branch outcomes
+- only totals are collected, no per branch stats
+*/
+class bp_grid {
+    private:
+        // predictors are grouped: static, counters only, local
+        size_t static_end = 0;
+        size_t table_end = 0;
+        // per predictor
+        std::vector<std::string> names;
+        std::vector<std::string> type_names;
+        std::vector<uint32_t> sizes; // bytes
+        std::vector<bp_sttc_t> method; // static only
+        std::vector<uint8_t> pc_key; // into pc_parts
+        std::vector<uint8_t> pc_shift; // pc part above ghr, gselect
+        std::vector<uint32_t> ghr_mask;
+        std::vector<uint8_t> ghr_shift; // ghr part aligned to pc top, gshare
+        std::vector<uint32_t> idx_mask;
+        std::vector<uint32_t> pht_off;
+        std::vector<uint8_t> cnt_max;
+        std::vector<uint8_t> thr_taken;
+        std::vector<uint32_t> lhist_off; // local only
+        std::vector<uint32_t> lhist_mask; // local only
+        std::array<std::vector<uint64_t>, 2> mispredicted; // fwd, bwd
+        // shared state
+        std::vector<uint8_t> pht;
+        std::vector<uint32_t> lhist;
+        uint32_t ghr = 0;
+        std::vector<std::pair<uint8_t, uint32_t>> pc_keys; // pc_bits, folds
+        std::vector<uint32_t> pc_parts;
+        // last branch
+        uint32_t pc_last = 0;
+        uint32_t target_last = 0;
+        std::array<uint64_t, 2> branches = {0, 0}; // fwd, bwd
+        bool prof_active = false;
+        uint64_t profiled_insts = 0;
+
+    private:
+        void add(bp_t type, bp_sttc_t m, uint8_t pc_bits, uint8_t cnt_bits,
+                 uint8_t lhist_bits, uint8_t ghr_bits, bp_pc_folds_t fold_pc);
+        uint8_t get_pc_key(uint8_t pc_bits, bp_pc_folds_t fold_pc);
+        void stats_line(size_t i, std::ostream& os) const;
+
+    public:
+        bp_grid(const std::vector<bp_grid_cfg_t>& cfgs);
+        bool is_en() const { return !names.empty(); }
+        size_t get_count() const { return names.size(); }
+        void profiling(bool enable) { prof_active = enable; }
+        void predict(uint32_t pc, uint32_t target_pc) {
+            pc_last = pc;
+            target_last = target_pc;
+        }
+        void update(bool taken, uint32_t next_pc);
+        std::string ckpt_signature() const;
+        void save(ckpt_out& out) const;
+        void restore(ckpt_in& in);
+        void summarize(uint64_t insts) { profiled_insts = insts; }
+        void show_stats() const;
+        void log_stats(std::ofstream& log_file) const;
+};
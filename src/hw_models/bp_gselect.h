@@ -48,4 +48,14 @@ class bp_gselect : public bp {
             ghr = ((ghr << 1) | taken);
             return (next_pc == predicted_pc);
         }
+
+        virtual void save(ckpt_out& out) override {
+            bp::save(out);
+            out.put(ghr);
+        }
+
+        virtual void restore(ckpt_in& in) override {
+            bp::restore(in);
+            ghr = in.get<uint32_t>();
+        }
 };
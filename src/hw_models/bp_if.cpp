@@ -87,6 +87,7 @@ bp_if::bp_if(std::string name, hw_cfg_t hw_cfg) :
     bp_combined_p1_type(hw_cfg.bp),
     bp_combined_p2_type(hw_cfg.bp2),
     bp_run_all(hw_cfg.bp_run_all),
+    grid(hw_cfg.bp_grid),
     to_dump_csv(hw_cfg.bp_dump_csv)
     {
         active_bp = create_predictor(bp_active_type, hw_cfg);
@@ -224,6 +225,7 @@ uint32_t bp_if::predict(uint32_t pc, int32_t offset, uint32_t funct3) {
         }
     }
     for (auto& p : all_bps) p->predict(target_pc, pc);
+    grid.predict(pc, target_pc);
     return active_bp->predict(target_pc, pc);
 }
 
@@ -231,6 +233,7 @@ void bp_if::update(uint32_t pc, uint32_t next_pc) {
     bool taken = next_pc != pc + 4;
     active_bp->eval_and_update(taken, next_pc);
     for (auto& p : all_bps) p->eval_and_update(taken, next_pc);
+    if (grid.is_en()) grid.update(taken, next_pc);
 
     // only update stats if profiling is active
     if (!prof_active) return;
@@ -241,6 +244,33 @@ void bp_if::update(uint32_t pc, uint32_t next_pc) {
     if (to_dump_csv) update_app_stats(pc, taken);
 }
 
+// predictors are restored only into the same set of predictors
+std::string bp_if::ckpt_signature() {
+    std::ostringstream sig;
+    sig << active_bp->type_name << ":" << active_bp->get_size();
+    for (const auto& p : all_bps) {
+        sig << "," << p->type_name << ":" << p->get_size();
+    }
+    if (grid.is_en()) sig << "," << grid.ckpt_signature();
+    return sig.str();
+}
+
+void bp_if::save(ckpt_out& out) {
+    out.put_str(ckpt_signature());
+    active_bp->save(out);
+    for (auto& p : all_bps) p->save(out);
+    if (grid.is_en()) grid.save(out);
+}
+
+// false and unchanged if predictors don't match
+bool bp_if::restore(ckpt_in& in) {
+    if (in.get_str() != ckpt_signature()) return false;
+    active_bp->restore(in);
+    for (auto& p : all_bps) p->restore(in);
+    if (grid.is_en()) grid.restore(in);
+    return true;
+}
+
 void bp_if::update_app_stats(uint32_t pc, bool taken) {
     bi_app_stats_t* ptr = &bi_app_stats[pc];
     ptr->taken += taken;
@@ -251,6 +281,7 @@ void bp_if::update_app_stats(uint32_t pc, bool taken) {
 void bp_if::finish(std::string out_dir, uint64_t profiled_insts, bool show) {
     for (auto& p : all_bps) p->summarize_stats(profiled_insts);
     active_bp->summarize_stats(profiled_insts);
+    grid.summarize(profiled_insts);
 
     std::string active_bp_name = active_bp->type_name;
     // put active bp in a list and iterate over all of them to dump/show stats
@@ -271,6 +302,7 @@ void bp_if::show_stats(std::string active_bp_name) {
     std::cout << std::endl;
 
     for (auto& p : all_bps) p->show_stats(bp_run_all);
+    if (grid.is_en()) grid.show_stats();
     return;
 
     // TODO: dump as cli switch? useful to have BP state at the end at all?
@@ -349,4 +381,5 @@ std::string bp_if::find_run_length(const std::vector<bool>& pattern) {
 
 void bp_if::log_stats(std::ofstream& log_file) {
     active_bp->log_stats(bp_name, log_file);
+    grid.log_stats(log_file);
 }
@@ -11,6 +11,7 @@
 #include "bp_combined.h"
 #include "bp_ideal.h"
 #include "bp_none.h"
+#include "bp_grid.h"
 
 struct bp_def_t {
     const bp_t type;
@@ -29,6 +30,7 @@ class bp_if {
         bp_ideal* bp_ideal_arch = nullptr; // non-owning observer pointer only
         bool bp_ideal_is_active;
         std::vector<std::unique_ptr<bp>> all_bps;
+        bp_grid grid;
         std::map<uint32_t, bi_app_stats_t> bi_app_stats;
         bool to_dump_csv = false;
 
@@ -39,16 +41,28 @@ class bp_if {
             prof_active = enable;
             active_bp->profiling(enable);
             for (auto& p : all_bps) p->profiling(enable);
+            grid.profiling(enable);
         }
         uint32_t predict(uint32_t pc, int32_t offset, uint32_t funct3);
         void update(uint32_t pc, uint32_t next_pc);
         void log_stats(std::ofstream& log_file);
         void finish(std::string out_dir, uint64_t profiled_insts, bool show);
+        #ifndef DPI
+        // running totals of the active predictor, e.g. for sampling
+        uint64_t get_branches() const {
+            return active_bp->get_stats().get_branches();
+        }
+        uint64_t get_mispredicted() const {
+            return active_bp->get_stats().get_mispredicted();
+        }
+        #endif
         void ideal(uint32_t correct_pc) {
             if (bp_ideal_arch) bp_ideal_arch->goto_future(correct_pc);
             if (bp_ideal_is_active) active_bp->goto_future(correct_pc);
         }
         // for predictor from cli args
+        void save(ckpt_out& out);
+        bool restore(ckpt_in& in);
         std::unique_ptr<bp> create_predictor(bp_t bp_type, hw_cfg_t hw_cfg);
         // for predefined predictors (wrapper only)
         std::unique_ptr<bp> create_predictor(bp_t bp_type, bp_cfg_t bp_cfg);
@@ -60,6 +74,7 @@ class bp_if {
         void update_app_stats(uint32_t pc, bool taken);
         std::string find_run_length(const std::vector<bool>& pattern);
         void dump_csv(std::string out_dir);
+        std::string ckpt_signature();
 
     private:
         // predefined branch predictors
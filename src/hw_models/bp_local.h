@@ -86,4 +86,14 @@ class bp_local : public bp {
             pht.dump();
             std::cout << std::dec << std::endl;
         }
+
+        virtual void save(ckpt_out& out) override {
+            bp::save(out);
+            out.put_vec(hist_table);
+        }
+
+        virtual void restore(ckpt_in& in) override {
+            bp::restore(in);
+            in.get_vec(hist_table);
+        }
 };
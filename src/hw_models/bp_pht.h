@@ -1,6 +1,7 @@
 #pragma once
 
 #include "defines.h"
+#include "checkpoint.h"
 
 #define CNT_ERR(param, msg) \
     std::cerr << "ERROR: " << param << " for " << type_name << " predictor " \
@@ -99,6 +100,10 @@ class bp_pht {
             } // no change if they match
         }
 
+        // counters only, accesses are stats
+        void save(ckpt_out& out) const { out.put_vec(pht); }
+        void restore(ckpt_in& in) { in.get_vec(pht); }
+
         void dump() {
             // TODO: should be stored as csv or similar
             std::cout << INDENT << INDENT << "counter accesses:\n";
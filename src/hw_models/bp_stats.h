@@ -75,6 +75,12 @@ struct bp_stats_t {
             }
             bi_predictor_stats[pc].predicted += correct;
         }
+        uint64_t get_branches() const {
+            return (predicted_fwd + predicted_bwd + get_mispredicted());
+        }
+        uint64_t get_mispredicted() const {
+            return (mispredicted_fwd + mispredicted_bwd);
+        }
         #endif
         void summarize(uint64_t total_insts) {
             #ifndef DPI
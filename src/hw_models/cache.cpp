@@ -6,13 +6,17 @@ cache::cache(
     uint32_t sets,
     uint32_t ways,
     cache_re_policy_t re_policy,
+    uint32_t rrpv_bits,
+    uint32_t seed,
     cache_in_policy_t in_policy,
     cache_wr_policy_t wr_policy,
+    uint32_t addr_bits,
     std::string cache_name) :
         type(type),
         sets(sets),
         ways(ways),
         re_policy(re_policy),
+        rrpv_bits(rrpv_bits),
         in_policy(in_policy),
         wr_policy(wr_policy),
         cache_name(cache_name)
@@ -20,20 +24,17 @@ cache::cache(
     validate_inputs();
     direct_mapped = (ways == 1);
 
-    // first dim is number of sets
-    cache_array.resize(sets);
-    // second dim number of ways in a set
-    // go through all entires and initialize lru_cnt and data
-    for (uint32_t set = 0; set < sets; set++) {
-        cache_array[set].resize(ways);
-        for (uint32_t way = 0; way < ways; way++) {
-            auto& line = cache_array[set][way];
-            line.metadata.lru_cnt = way;
-            #if CACHE_MODE == CACHE_MODE_FUNC
-            std::fill(line.data.begin(), line.data.end(), 0xCD);
-            #endif
-        }
-    }
+    uint32_t lines = sets * ways;
+    tags.assign(lines, 0);
+    valid.assign(lines, 0);
+    dirty.assign(lines, 0);
+    scp.assign(lines, 0);
+    ref_cnt.assign(lines, 0);
+    #if CACHE_MODE == CACHE_MODE_FUNC
+    data.resize(lines);
+    for (auto& d : data) d.fill(0xCD);
+    #endif
+    re = cache_re_make(re_policy, {sets, ways, rrpv_bits, seed});
 
     index_bits_num = 0;
     index_mask = 0;
@@ -42,14 +43,17 @@ cache::cache(
         index_mask = (index_mask << 1) | 1;
     }
     tag_bits_num = (
-        mem_map::addr_bits - index_bits_num - cache_cfg::byte_addr_bits
+        addr_bits - index_bits_num - cache_cfg::byte_addr_bits
     );
     tag_off = (cache_cfg::byte_addr_bits + index_bits_num);
     max_scp_ways = ways - 1; // should be fw configurable as MMIO, max = ways-1
-    metadata_bits_num = metadata_t::get_bits_num();
-    metadata_bits_num += TO_U32(log2(ways)); // lru counters
+    metadata_bits_num = flag_bits_num;
+    // nothing to pick from in direct-mapped caches
+    uint32_t re_bits_num = direct_mapped ?
+        0 : std::visit([](auto& r) { return r.bits(); }, re);
     size = {
-        sets, ways, cache_cfg::line_size, tag_bits_num, metadata_bits_num
+        sets, ways, cache_cfg::line_size, tag_bits_num, metadata_bits_num,
+        re_bits_num
     };
 }
 
@@ -110,86 +114,83 @@ cache_ref_t cache::reference(
         stats.referenced(atype, size);
         if (roi.has(a)) roi.stats.referenced(atype, size);
         #ifdef PROFILERS_EN
-        prof_perf->set_perf_event_flag(ref_event);
-        prof_perf->set_perf_event_flag(
-            ref_r_event,
-            ((type == cache_type_t::data) && (atype == mem_op_t::read))
-        );
+        if (prof_perf) {
+            prof_perf->set_perf_event_flag(ref_event);
+            prof_perf->set_perf_event_flag(
+                ref_r_event,
+                ((type == cache_type_t::data) && (atype == mem_op_t::read))
+            );
+        }
         #endif
     }
 
     ccl_info = {
         /* index */ ((a >> cache_cfg::byte_addr_bits) & index_mask),
         /* tag */ (a >> tag_off),
-        /* victim */ {0, 0},
+        /* victim_way */ 0,
         /* byte_addr */ (a & cache_cfg::byte_addr_mask)
     };
 
-    for (uint32_t way = 0; way < ways; way++) {
-        auto& line = cache_array[ccl_info.index][way];
-        if (line.metadata.valid && (line.tag == ccl_info.tag)) {
-            // hit, doesn't go to main mem
-            scp_status = update_scp(scp_mode, line, ccl_info.index);
-
-            #ifdef DASM_EN
-            hwmi_ptr->log_cache({
-                /* name */ cache_name,
-                /* type */ type,
-                /* addr */ to_full(addr),
-                /* tag */ ccl_info.tag,
-                /* index */ ccl_info.index,
-                /* way */ way,
-                /* byte_addr */ ccl_info.byte_addr,
-                /* atype */ atype,
-                /* is_scp */ (line.metadata.scp == true),
-                /* is_hit */ true,
-                /* is_dirty */ (line.metadata.dirty == true)
-            });
-            #endif
-
-            // don't update lru on release
-            if (scp_mode == scp_mode_t::m_rel) {
-                *hws = hw_status_t::hit;
-                return cache_ref_t::hit;
-            }
-
-            update_lru(ccl_info.index, way);
-            line.referenced();
-            stats.hit(atype);
-            if (roi.has(a)) roi.stats.hit(atype);
-
-            if (atype == mem_op_t::write) {
-                #if CACHE_MODE == CACHE_MODE_FUNC
-                write_to_cache(ccl_info, size, line);
-                #endif
-                if (wr_policy == cache_wr_policy_t::wt) {
-                    stats.writeback();
-                    if (roi.has(line_base_addr(line.tag, ccl_info.index))) {
-                        roi.stats.writeback();
-                    }
-                } else {
-                    line.metadata.dirty = true;
-                }
-            } else { // read
-                #if CACHE_MODE == CACHE_MODE_FUNC
-                read_from_cache(ccl_info, size, line);
-                #endif
-            }
+    uint32_t set_base = ccl_info.index * ways;
+    uint32_t line = (a >> cache_cfg::byte_addr_bits);
+    // sequential fetch re-references the same line, skip the tag match then
+    uint32_t way = (line == mru_line) ?
+        (mru_pos - set_base) : find_way(set_base, ccl_info.tag);
+
+    if (way < ways) {
+        // hit, doesn't go to main mem
+        uint32_t pos = set_base + way;
+        mru_line = line;
+        mru_pos = pos;
+        scp_status = update_scp(scp_mode, pos, set_base);
+
+        #ifdef DASM_EN
+        if (hwmi_ptr) hwmi_ptr->log_cache({
+            /* name */ cache_name,
+            /* type */ type,
+            /* addr */ to_full(addr),
+            /* tag */ ccl_info.tag,
+            /* index */ ccl_info.index,
+            /* way */ way,
+            /* byte_addr */ ccl_info.byte_addr,
+            /* atype */ atype,
+            /* is_scp */ (scp[pos] != 0),
+            /* is_hit */ true,
+            /* is_dirty */ (dirty[pos] != 0)
+        });
+        #endif
 
-            *hws = hw_status_t::hit;
+        // don't update replacement state on release
+        if (scp_mode == scp_mode_t::m_rel) {
+            if (hws) *hws = hw_status_t::hit;
             return cache_ref_t::hit;
+        }
+
+        re_hit(ccl_info.index, way);
+        referenced(pos);
+        stats.hit(atype);
+        if (roi.has(a)) roi.stats.hit(atype);
 
-        } else { // keep looking for victim line
-            // potentially a miss, keep the largest lru count as victim line
-            if ((line.metadata.lru_cnt >= ccl_info.victim.lru_cnt) &&
-                !line.metadata.scp)
-            {
-                // if there are ways-1 scp lines in the set, it can happen
-                // for lru 0 to be victim, hence the >= instead of > comparison
-                // as ccl_info is initialized to 0
-                ccl_info.victim = {way, line.metadata.lru_cnt};
+        if (atype == mem_op_t::write) {
+            #if CACHE_MODE == CACHE_MODE_FUNC
+            write_to_cache(ccl_info, size, pos);
+            #endif
+            if (wr_policy == cache_wr_policy_t::wt) {
+                stats.writeback();
+                if (roi.has(line_base_addr(tags[pos], ccl_info.index))) {
+                    roi.stats.writeback();
+                }
+            } else {
+                dirty[pos] = 1;
             }
+        } else { // read
+            #if CACHE_MODE == CACHE_MODE_FUNC
+            read_from_cache(ccl_info, size, pos);
+            #endif
         }
+
+        if (hws) *hws = hw_status_t::hit;
+        return cache_ref_t::hit;
     }
 
     if (scp_mode == scp_mode_t::m_rel) {
@@ -202,7 +203,7 @@ cache_ref_t cache::reference(
                     << " but cache missed, nothing has been released\n";
         return cache_ref_t::ignore;
     }
-    *hws = hw_status_t::miss;
+    if (hws) *hws = hw_status_t::miss;
     return cache_ref_t::miss;
 }
 
@@ -220,80 +221,90 @@ void cache::miss(
     if (roi.has(a)) roi.stats.miss(atype);
 
     #ifdef PROFILERS_EN
-    prof_perf->set_perf_event_flag(miss_event);
-    prof_perf->set_perf_event_flag(
-        miss_r_event,
-        ((type == cache_type_t::data) && (atype == mem_op_t::read))
-    );
+    if (prof_perf) {
+        prof_perf->set_perf_event_flag(miss_event);
+        prof_perf->set_perf_event_flag(
+            miss_r_event,
+            ((type == cache_type_t::data) && (atype == mem_op_t::read))
+        );
+    }
     #endif
 
-    auto& ccl = cache_array[ccl_info.index][ccl_info.victim.way_idx];
+    // picked only now, policies may update their state while picking
+    // an invalid way is filled first, the policy picks only in a full set
+    uint32_t set_base = ccl_info.index * ways;
+    ccl_info.victim_way = find_invalid(set_base);
+    if (ccl_info.victim_way == ways) {
+        ccl_info.victim_way = re_victim(ccl_info.index);
+    }
+    uint32_t pos = set_base + ccl_info.victim_way;
     #ifdef DASM_EN
-    hwmi_ptr->log_cache({
+    if (hwmi_ptr) hwmi_ptr->log_cache({
         /* name */ cache_name,
         /* type */ type,
         /* addr */ to_full(addr),
         /* tag */ ccl_info.tag,
         /* index */ ccl_info.index,
-        /* way */ ccl_info.victim.way_idx,
+        /* way */ ccl_info.victim_way,
         /* byte_addr */ ccl_info.byte_addr,
         /* atype */ atype,
         /* is_scp */ (scp_mode == scp_mode_t::m_lcl),
         /* is_hit */ false,
-        /* is_dirty */ ccl.metadata.dirty
+        /* is_dirty */ (dirty[pos] != 0)
     });
     #endif
 
     // replace the line (evict if dirty)
-    if (ccl.metadata.valid) {
-        stats.replace(ccl.metadata.dirty);
-        if (roi.has(line_base_addr(ccl.tag, ccl_info.index))) {
-            roi.stats.replace(ccl.metadata.dirty);
+    if (valid[pos]) {
+        stats.replace(dirty[pos]);
+        if (roi.has(line_base_addr(tags[pos], ccl_info.index))) {
+            roi.stats.replace(dirty[pos]);
         }
-        if (ccl.metadata.dirty) {
+        if (dirty[pos]) {
             #ifdef PROFILERS_EN
-            prof_perf->set_perf_event_flag(
-                writeback_event, (type == cache_type_t::data)
-            );
+            if (prof_perf) {
+                prof_perf->set_perf_event_flag(
+                    writeback_event, (type == cache_type_t::data)
+                );
+            }
             #endif
             #if CACHE_MODE == CACHE_MODE_FUNC and defined(CACHE_VERIFY)
             mem->wr_line(
-                norm_address_t{line_base_addr(ccl.tag, ccl_info.index)},
-                ccl.data
+                norm_address_t{line_base_addr(tags[pos], ccl_info.index)},
+                data[pos]
             );
             #endif
-            ccl.metadata.dirty = false;
+            dirty[pos] = 0;
         }
     }
 
     // bring in the new line requested by the core
-    ccl.referenced();
-    ccl.tag = ccl_info.tag; // ccl now caching new data
-    ccl.metadata.valid = true;
-    if (in_policy == cache_in_policy_t::update) {
-        // now the most recently used
-        update_lru(ccl_info.index, ccl_info.victim.way_idx);
-    }
-    scp_status = update_scp(scp_mode, ccl, ccl_info.index);
+    referenced(pos);
+    tags[pos] = ccl_info.tag; // line now caching new data
+    valid[pos] = 1;
+    mru_line = (a >> cache_cfg::byte_addr_bits);
+    mru_pos = pos;
+    re_fill(ccl_info.index, ccl_info.victim_way);
+    scp_status = update_scp(scp_mode, pos, set_base);
 
     #if CACHE_MODE == CACHE_MODE_FUNC
-    ccl.data = mem->rd_line(addr);
+    data[pos] = mem->rd_line(addr);
     #endif
     if (atype == mem_op_t::write) {
         #if CACHE_MODE == CACHE_MODE_FUNC
-        write_to_cache(ccl_info, size, ccl);
+        write_to_cache(ccl_info, size, pos);
         #endif
         if (wr_policy == cache_wr_policy_t::wt) {
             stats.writeback();
-            if (roi.has(line_base_addr(ccl.tag, ccl_info.index))) {
+            if (roi.has(line_base_addr(tags[pos], ccl_info.index))) {
                 roi.stats.writeback();
             }
         } else {
-            ccl.metadata.dirty = true;
+            dirty[pos] = 1;
         }
     } else { // read
         #if CACHE_MODE == CACHE_MODE_FUNC
-        read_from_cache(ccl_info, size, ccl);
+        read_from_cache(ccl_info, size, pos);
         #endif
     }
 
@@ -301,15 +312,15 @@ void cache::miss(
     #ifdef SCP_BACKDOOR
     // useful for debugging, to convert a specific address to scratchpad
     // NOTE: doesn't handle too many scp requests in this #ifdef
-    if (ccl.metadata.scp == false) {
+    if (!scp[pos]) {
         // tags are normalized; the constants are RAM offsets shifted to tags
-        uint32_t tag = ccl.tag;
+        uint32_t tag = tags[pos];
         if ((tag == TO_U32(0x17200 >> tag_off)) ||
             (tag == TO_U32((0x17200 + 64) >> tag_off)) ||
             (tag == TO_U32((0x17200 + 128) >> tag_off)) ||
             (tag == TO_U32((0x17200 + 192) >> tag_off)))
         {
-            ccl.metadata.scp = true; // converted to scratchpad
+            scp[pos] = 1; // converted to scratchpad
             std::cout << "Converted to scratchpad: " << std::hex
                       << to_full(addr) << "\n";
         }
@@ -318,10 +329,10 @@ void cache::miss(
     if (roi.stats.references >= 4096) {
         for (uint32_t set = 0; set < sets; set++) {
             for (uint32_t way = 0; way < ways; way++) {
-                if (cache_array[set][way].metadata.scp) {
-                    std::cout << "Releasing: " << std::hex
-                              << cache_array[set][way].tag << "\n";
-                    cache_array[set][way].metadata.scp = false;
+                uint32_t p = set * ways + way;
+                if (scp[p]) {
+                    std::cout << "Releasing: " << std::hex << tags[p] << "\n";
+                    scp[p] = 0;
                 }
             }
         }
@@ -332,47 +343,59 @@ void cache::miss(
     return;
 }
 
-void cache::update_lru(uint32_t index, uint32_t way) {
-    // TODO: don't update lru in speculative mode?
-    //if (smode == speculative_t::enter) return;
-    auto& active_set = cache_array[index];
-    auto& active_lru_cnt = active_set[way].metadata.lru_cnt;
-    // increment all counters newer than the current way
-    for (uint32_t i = 0; i < ways; i++) {
-        auto& line = active_set[i];
-        if (line.metadata.lru_cnt < active_lru_cnt) line.metadata.lru_cnt++;
-    }
-    // reset the current way
-    active_lru_cnt = 0;
+// returns ways if the tag is not in the set
+uint32_t cache::find_way(uint32_t set_base, uint32_t tag) const {
+    const uint32_t* t = &tags[set_base];
+    const uint8_t* v = &valid[set_base];
+    uint32_t way = 0;
+    // compare a chunk of ways at once, the inner loop is vectorized
+    for (; (way + way_chunk) <= ways; way += way_chunk) {
+        uint32_t match = 0;
+        for (uint32_t i = 0; i < way_chunk; i++) {
+            match |= TO_U32((t[way + i] == tag) & (v[way + i] != 0)) << i;
+        }
+        if (match) return way + TO_U32(__builtin_ctz(match));
+    }
+    // remaining ways, all of them if fewer than a chunk
+    for (; way < ways; way++) {
+        if ((t[way] == tag) && v[way]) return way;
+    }
+    return ways;
+}
+
+uint32_t cache::find_invalid(uint32_t set_base) const {
+    const uint8_t* v = &valid[set_base];
+    for (uint32_t way = 0; way < ways; way++) {
+        if (!v[way]) return way;
+    }
+    return ways;
 }
 
 scp_status_t cache::update_scp(
-    scp_mode_t scp_mode, cache_line_t& line,uint32_t index) {
+    scp_mode_t scp_mode, uint32_t pos, uint32_t set_base) {
     if (scp_mode == scp_mode_t::m_none) return scp_status_t::success;
-    if (scp_mode == scp_mode_t::m_lcl) return convert_to_scp(line, index);
-    else if (scp_mode == scp_mode_t::m_rel) return release_scp(line);
+    if (scp_mode == scp_mode_t::m_lcl) return convert_to_scp(pos, set_base);
+    else if (scp_mode == scp_mode_t::m_rel) return release_scp(pos);
     // TODO: exception code 24: custom use - unknown scp mode
     // else tu.e_hardware_error("Unknown SCP mode");
     else throw std::runtime_error("Unknown SCP mode.");
 }
 
-scp_status_t cache::convert_to_scp(cache_line_t& line, uint32_t index) {
+scp_status_t cache::convert_to_scp(uint32_t pos, uint32_t set_base) {
     // first check if there are empty ways for conversion
     uint32_t scp_cnt = 0;
-    for (uint32_t way = 0; way < ways; way++) {
-        if (cache_array[index][way].metadata.scp) scp_cnt++;
-    }
+    for (uint32_t way = 0; way < ways; way++) scp_cnt += scp[set_base + way];
     if (scp_cnt < max_scp_ways) {
-        line.metadata.scp = true;
+        scp[pos] = 1;
         return scp_status_t::success;
     } else {
         return scp_status_t::fail;
     }
 }
 
-scp_status_t cache::release_scp(cache_line_t& line) {
-    if (line.metadata.scp) {
-        line.metadata.scp = false;
+scp_status_t cache::release_scp(uint32_t pos) {
+    if (scp[pos]) {
+        scp[pos] = 0;
         return scp_status_t::success;
     } else {
         return scp_status_t::fail;
@@ -382,9 +405,20 @@ scp_status_t cache::release_scp(cache_line_t& line) {
 void cache::validate_inputs() {
     bool error = false;
 
-    if (re_policy != cache_re_policy_t::lru) {
+    if ((re_policy == cache_re_policy_t::plru_tree) && !is_pow2(ways)) {
         std::cerr << "ERROR: " << cache_name
-                  << ": only LRU re_policy is supported" << std::endl;
+                  << ": number of ways must be a power of 2 for plru_tree "
+                     "re_policy. Specified: " << ways << std::endl;
+        error = true;
+    }
+
+    if (((re_policy == cache_re_policy_t::srrip) ||
+         (re_policy == cache_re_policy_t::brrip)) &&
+        ((rrpv_bits == 0) || (rrpv_bits > cache_cfg::max_rrpv_bits))) {
+        std::cerr << "ERROR: " << cache_name
+                  << ": rrpv bits must be between 1 and "
+                  << cache_cfg::max_rrpv_bits << ". Specified: " << rrpv_bits
+                  << std::endl;
         error = true;
     }
 
@@ -453,27 +487,26 @@ void cache::validate_inputs() {
 void cache::read_from_cache(
     current_cache_line_info ccl_info,
     uint32_t size,
-    cache_line_t& ccl)
+    uint32_t pos)
 {
     rd_buf = 0;
-    for (uint32_t i = 0; i < size; i++) {
-        rd_buf |= ccl.data[ccl_info.byte_addr + i] << (i * 8);
-    }
+    // an access crossing the line end only touches this line's bytes
+    size = std::min(size, cache_cfg::line_size - ccl_info.byte_addr);
+    std::memcpy(&rd_buf, &data[pos][ccl_info.byte_addr], size);
 }
 
 void cache::write_to_cache(
     current_cache_line_info ccl_info,
     uint32_t size,
-    cache_line_t& ccl)
+    uint32_t pos)
 {
-    for (uint32_t i = 0; i < size; i++) {
-        ccl.data[ccl_info.byte_addr + i] = TO_U8(wr_buf >> (i * 8));
-    }
+    size = std::min(size, cache_cfg::line_size - ccl_info.byte_addr);
+    std::memcpy(&data[pos][ccl_info.byte_addr], &wr_buf, size);
     #if CACHE_MODE == CACHE_MODE_FUNC and defined(CACHE_VERIFY)
     if (wr_policy == cache_wr_policy_t::wt) {
         mem->wr_line(
-            norm_address_t{line_base_addr(ccl.tag, ccl_info.index)},
-            ccl.data
+            norm_address_t{line_base_addr(tags[pos], ccl_info.index)},
+            data[pos]
         );
     }
     #endif
@@ -505,7 +538,7 @@ void cache::show_stats(bool show_state) {
         uint64_t n = 0;
         for (uint32_t set = 0; set < sets; set++) {
             for (uint32_t way = 0; way < ways; way++) {
-                uint64_t cnt = cache_array[set][way].get_ref();
+                uint64_t cnt = ref_cnt[set * ways + way];
                 n = std::max(n, TO_U64(std::to_string(cnt).size()));
             }
         }
@@ -516,7 +549,7 @@ void cache::show_stats(bool show_state) {
                       << ": " << std::right;
             for (uint32_t way = 0; way < ways; way++) {
                 std::cout << " w" << way << " [" << std::setw(width)
-                        << cache_array[set][way].get_ref() << "] ";
+                        << ref_cnt[set * ways + way] << "] ";
             }
             std::cout << "\n";
         }
@@ -545,21 +578,22 @@ void cache::dump() const {
     std::cout << "  state:" << "\n";
     for (uint32_t set = 0; set < sets; set++) {
         for (uint32_t way = 0; way < ways; way++) {
-            auto& line = cache_array[set][way];
+            uint32_t pos = set * ways + way;
             std::cout << "    s" << set << " w" << way
-                      << ", tag: " << FHEXZ(line.tag, 4)
-                      << ", lru: " << line.metadata.lru_cnt
-                      << ", scp: " << line.metadata.scp
-                      << ", valid: " << line.metadata.valid
-                      << ", dirty: " << line.metadata.dirty
-                      << ", reference_cnt: " << line.get_ref()
+                      << ", tag: " << FHEXZ(tags[pos], 4)
+                      << ", re: " << std::visit(
+                            [&](auto& r) { return r.way_state(set, way); }, re)
+                      << ", scp: " << TO_U32(scp[pos])
+                      << ", valid: " << TO_U32(valid[pos])
+                      << ", dirty: " << TO_U32(dirty[pos])
+                      << ", reference_cnt: " << ref_cnt[pos]
                       << "\n";
             #if CACHE_MODE == CACHE_MODE_FUNC
             // dump data in the line, byte by byte, all 64 bytes in a line
             std::cout << "     ";
             for (uint32_t i = 0; i < cache_cfg::line_size; i++) {
                 std::cout << " " << std::hex << std::setw(2)
-                          << std::setfill('0') << TO_U32(line.data[i]);
+                          << std::setfill('0') << TO_U32(data[pos][i]);
                 if (i % 4 == 3) std::cout << " ";
                 if (i % 64 == 63) std::cout << "\n";
             }
@@ -569,3 +603,55 @@ void cache::dump() const {
     }
     std::cout << std::dec << "\n";
 }
+
+void cache::save(ckpt_out& out) const {
+    out.put(TO_U32(CACHE_MODE));
+    out.put(sets);
+    out.put(ways);
+    out.put(tag_off);
+    out.put(TO_U32(re_policy));
+    out.put(rrpv_bits);
+    for (uint32_t set = 0; set < sets; set++) {
+        for (uint32_t way = 0; way < ways; way++) {
+            uint32_t pos = set * ways + way;
+            out.put(TO_BOOL(valid[pos]));
+            out.put(TO_BOOL(dirty[pos]));
+            out.put(TO_BOOL(scp[pos]));
+            out.put(tags[pos]);
+            #if CACHE_MODE == CACHE_MODE_FUNC
+            out.put(data[pos]);
+            #endif
+        }
+    }
+    std::visit([&](auto& r) { r.save(out); }, re);
+}
+
+// false and unchanged if the mode or geometry doesn't match
+bool cache::restore(ckpt_in& in) {
+    uint32_t c_mode = in.get<uint32_t>();
+    uint32_t c_sets = in.get<uint32_t>();
+    uint32_t c_ways = in.get<uint32_t>();
+    uint32_t c_tag_off = in.get<uint32_t>();
+    uint32_t c_re_policy = in.get<uint32_t>();
+    uint32_t c_rrpv_bits = in.get<uint32_t>();
+    if ((c_mode != CACHE_MODE) ||
+        (c_sets != sets) || (c_ways != ways) || (c_tag_off != tag_off) ||
+        (c_re_policy != TO_U32(re_policy)) || (c_rrpv_bits != rrpv_bits)) {
+        return false;
+    }
+    for (uint32_t set = 0; set < sets; set++) {
+        for (uint32_t way = 0; way < ways; way++) {
+            uint32_t pos = set * ways + way;
+            valid[pos] = in.get<bool>();
+            dirty[pos] = in.get<bool>();
+            scp[pos] = in.get<bool>();
+            tags[pos] = in.get<uint32_t>();
+            #if CACHE_MODE == CACHE_MODE_FUNC
+            data[pos] = in.get<std::array<uint8_t, cache_cfg::line_size>>();
+            #endif
+        }
+    }
+    std::visit([&](auto& r) { r.restore(in); }, re);
+    mru_line = no_line;
+    return true;
+}
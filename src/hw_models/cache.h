@@ -3,8 +3,10 @@
 #include "defines.h"
 #include "hw_model_types.h"
 #include "cache_stats.h"
+#include "cache_re.h"
 #include "profiler_perf.h"
 #include "types.h"
+#include "checkpoint.h"
 
 class main_memory; // forward declaration
 
@@ -16,52 +18,10 @@ using mem_t = main_memory;
 // #endif
 #endif
 
-struct metadata_t {
-    bool valid;
-    bool dirty;
-    bool scp;
-    //bool speculative; // line brought in during speculative execution
-    uint32_t lru_cnt;
-    metadata_t() : valid(false), dirty(false), scp(false), lru_cnt(0) {}
-    static uint32_t get_bits_num() { return 3; } // update if more flags added
-};
-
-struct cache_line_t {
-    public:
-        metadata_t metadata;
-        uint32_t tag;
-        #if CACHE_MODE == CACHE_MODE_FUNC
-        std::array<uint8_t, cache_cfg::line_size> data;
-        #endif
-    private:
-        uint64_t reference_cnt;
-        //std::array<uint32_t, cache_cfg::line_size> byte_reference_cnt;
-    private:
-        bool prof_active = false;
-    public:
-        cache_line_t() : metadata(), tag(0), reference_cnt(0) {}
-        void profiling(bool enable) { prof_active = enable; }
-        void referenced() {
-            if (!prof_active) return;
-            reference_cnt++;
-            //for (uint32_t i = 0; i < size; i++) {
-            //    byte_reference_cnt[(addr + i) & CACHE_BYTE_ADDR_MASK]++;
-            //}
-        }
-        uint64_t get_ref() const { return reference_cnt; }
-};
-
-struct victim_t {
-    uint32_t way_idx;
-    uint32_t lru_cnt;
-    victim_t() : way_idx(0), lru_cnt(0) {}
-    victim_t(uint32_t way, uint32_t lru_cnt) : way_idx(way), lru_cnt(lru_cnt) {}
-};
-
 struct current_cache_line_info {
     uint32_t index;
     uint32_t tag;
-    victim_t victim;
+    uint32_t victim_way;
     uint32_t byte_addr;
 };
 
@@ -77,9 +37,16 @@ cache parameters (
 - size (D): sets * ways * cache_cfg::line_size [bytes]
 - policies:
     - replacement (P): 1. lru - track with counters, replace largest
+                       2. plru_tree - tree of ways-1 bits per set
+                       3. plru_bit - MRU bit per way
+                       4. srrip - rrpv per way, inserted as long
+                       5. brrip - rrpv per way, mostly inserted as distant
+                       6. fifo - round robin pointer per set
+                       7. random - seeded LFSR
+                       (see cache_re.h)
     - insertion (P): 1. update - on miss, promote line to MRU position
                      2. no_update - on miss, don't change new line's LRU
-    - eviction (S): LRU - on miss, evict/replace LRU line in way
+    - eviction (S): on miss, evict/replace the line picked by re policy
     - write (P): 1. write-back (write on eviction if dirty)
                  2. write-through (write to mem on write)
 - write-allocate (S): yes
@@ -89,11 +56,17 @@ cache parameters (
 - cache coherence (S): not applicable, single core
 */
 class cache {
+    private:
+        static constexpr uint32_t way_chunk = 8;
+        static constexpr uint32_t flag_bits_num = 3; // valid, dirty, scp
+        static constexpr uint32_t no_line = UINT32_MAX;
+
     private:
         cache_type_t type;
         uint32_t sets;
         uint32_t ways;
         cache_re_policy_t re_policy;
+        uint32_t rrpv_bits;
         cache_in_policy_t in_policy;
         cache_wr_policy_t wr_policy;
         bool direct_mapped;
@@ -103,7 +76,20 @@ class cache {
         uint32_t tag_off;
         current_cache_line_info ccl_info;
         uint32_t metadata_bits_num;
-        std::vector<std::vector<cache_line_t>> cache_array;
+        // set-contiguous arrays, a line is at (index * ways + way)
+        std::vector<uint32_t> tags;
+        std::vector<uint8_t> valid;
+        std::vector<uint8_t> dirty;
+        std::vector<uint8_t> scp;
+        cache_re_t re; // replacement state, set up once inputs are validated
+        std::vector<uint64_t> ref_cnt;
+        #if CACHE_MODE == CACHE_MODE_FUNC
+        std::vector<std::array<uint8_t, cache_cfg::line_size>> data;
+        #endif
+        bool prof_active = false; // for ref_cnt
+        // last referenced line, repeated references skip the tag match
+        uint32_t mru_line = no_line;
+        uint32_t mru_pos = 0;
         std::string cache_name;
         #if CACHE_MODE == CACHE_MODE_FUNC
         mem_t* mem;
@@ -117,9 +103,10 @@ class cache {
         scp_status_t scp_status;
         speculative_t smode;
         bool speculative_exec_active; // not used atm
-        hw_status_t* hws;
+        // not attached for sweep caches, stats only
+        hw_status_t* hws = nullptr;
         #ifdef PROFILERS_EN
-        profiler_perf* prof_perf;
+        profiler_perf* prof_perf = nullptr;
         perf_event_t ref_event;
         perf_event_t miss_event;
         perf_event_t ref_r_event;
@@ -127,7 +114,7 @@ class cache {
         perf_event_t writeback_event;
         #endif
         #ifdef DASM_EN
-        hwmi_str* hwmi_ptr;
+        hwmi_str* hwmi_ptr = nullptr;
         #endif
 
     public:
@@ -137,8 +124,11 @@ class cache {
             uint32_t sets,
             uint32_t ways,
             cache_re_policy_t re_policy,
+            uint32_t rrpv_bits,
+            uint32_t seed,
             cache_in_policy_t in_policy,
             cache_wr_policy_t wr_policy,
+            uint32_t addr_bits,
             std::string cache_name
         );
         #if CACHE_MODE == CACHE_MODE_FUNC
@@ -150,14 +140,15 @@ class cache {
         scp_status_t scp_rel(norm_address_t addr);
         void speculative_exec(speculative_t smode);
         void set_hws(hw_status_t* hws) { this->hws = hws; };
+        bool is_direct_mapped() const { return direct_mapped; }
+        void save(ckpt_out& out) const;
+        bool restore(ckpt_in& in);
 
         // prof
         void profiling(bool enable) {
             stats.profiling(enable);
             roi.stats.profiling(enable);
-            for (auto& set : cache_array) {
-                for (auto& line : set) line.profiling(enable);
-            }
+            prof_active = enable;
         }
         #ifdef PROFILERS_EN
         void set_perf_profiler(
@@ -185,6 +176,9 @@ class cache {
         void summarize_stats(uint64_t total_insts);
         void show_stats(bool show_state);
         void log_stats(std::ofstream& hw_ofs);
+        cache_cnt_t get_cnt() const {
+            return {stats.get_references(), stats.get_misses(type)};
+        }
         void dump() const;
 
     private:
@@ -192,11 +186,26 @@ class cache {
             norm_address_t addr, uint32_t size, mem_op_t atype, scp_mode_t scp);
         void miss(
             norm_address_t addr, uint32_t size, mem_op_t atype, scp_mode_t scp);
-        void update_lru(uint32_t index, uint32_t way);
+        uint32_t find_way(uint32_t set_base, uint32_t tag) const;
+        uint32_t find_invalid(uint32_t set_base) const;
+        void re_hit(uint32_t index, uint32_t way) {
+            const uint8_t* s = &scp[index * ways];
+            std::visit([&](auto& r) { r.hit(index, way, s); }, re);
+        }
+        void re_fill(uint32_t index, uint32_t way) {
+            const uint8_t* s = &scp[index * ways];
+            bool update = (in_policy == cache_in_policy_t::update);
+            std::visit([&](auto& r) { r.fill(index, way, update, s); }, re);
+        }
+        uint32_t re_victim(uint32_t index) {
+            const uint8_t* s = &scp[index * ways];
+            return std::visit([&](auto& r) { return r.victim(index, s); }, re);
+        }
+        void referenced(uint32_t pos) { if (prof_active) ref_cnt[pos]++; }
         scp_status_t update_scp(
-            scp_mode_t mode, cache_line_t& line,uint32_t index);
-        scp_status_t convert_to_scp(cache_line_t& line, uint32_t index);
-        scp_status_t release_scp(cache_line_t& line);
+            scp_mode_t mode, uint32_t pos, uint32_t set_base);
+        scp_status_t convert_to_scp(uint32_t pos, uint32_t set_base);
+        scp_status_t release_scp(uint32_t pos);
         uint32_t line_base_addr(uint32_t tag, uint32_t index) const {
             return (tag << tag_off) | (index << cache_cfg::byte_addr_bits);
         }
@@ -205,12 +214,12 @@ class cache {
         void read_from_cache(
             current_cache_line_info ccl_info,
             uint32_t size,
-            cache_line_t& act_line
+            uint32_t pos
         );
         void write_to_cache(
             current_cache_line_info ccl_info,
             uint32_t size,
-            cache_line_t& act_line
+            uint32_t pos
         );
         #endif
 };
@@ -0,0 +1,334 @@
+#pragma once
+
+#include "defines.h"
+#include "hw_model_types.h"
+#include "checkpoint.h"
+#include <variant>
+
+struct cache_re_cfg_t {
+    uint32_t sets;
+    uint32_t ways;
+    uint32_t rrpv_bits; // srrip/brrip only
+    uint32_t seed; // random only
+};
+
+// bits needed to index n entries
+inline uint32_t cache_re_idx_bits(uint32_t n) {
+    return (n > 1) ? TO_U32(32 - __builtin_clz(n - 1)) : 0;
+}
+
+// the way itself if not scp, otherwise the next one that isn't
+inline uint32_t cache_re_skip_scp(
+    const uint8_t* scp, uint32_t ways, uint32_t way)
+{
+    while (scp[way]) way = ((way + 1) == ways) ? 0 : (way + 1);
+    return way;
+}
+
+/*
+Replacement policies, same members in each:
+- hit: line in the way was referenced
+- fill: new line brought into the way, 'update' as the insertion policy
+- victim: way to replace in a full set, never an scp one (there is always
+  one that isn't), invalid ways are filled first by the cache itself
+'scp' points to the scp flags of the set's ways
+- way_state: per way state, for the cache dump
+- bits: size of the replacement state in bits
+The cache holds one of them in a variant, so the loops of each are compiled
+for that policy alone, without per way checks of the policy in use
+*/
+
+// age counter per way, 0 is the most recently used, largest is replaced
+class cache_re_lru {
+    private:
+        uint32_t sets = 0;
+        uint32_t ways = 0;
+        std::vector<uint8_t> cnt;
+
+    public:
+        cache_re_lru() = default;
+        cache_re_lru(const cache_re_cfg_t& cfg) :
+            sets(cfg.sets), ways(cfg.ways), cnt(cfg.sets * cfg.ways)
+        {
+            for (uint32_t i = 0; i < cnt.size(); i++) cnt[i] = TO_U8(i % ways);
+        }
+        void hit(uint32_t set, uint32_t way, const uint8_t*) {
+            touch(set, way);
+        }
+        void fill(uint32_t set, uint32_t way, bool update, const uint8_t*) {
+            if (update) touch(set, way);
+        }
+        uint32_t victim(uint32_t set, const uint8_t* scp) {
+            const uint8_t* c = &cnt[set * ways];
+            uint32_t v = 0;
+            uint8_t v_cnt = 0;
+            for (uint32_t w = 0; w < ways; w++) {
+                // if there are ways-1 scp lines in the set, it can happen
+                // for lru 0 to be victim, hence the >= instead of >
+                if ((c[w] >= v_cnt) && !scp[w]) {
+                    v = w;
+                    v_cnt = c[w];
+                }
+            }
+            return v;
+        }
+        uint32_t way_state(uint32_t set, uint32_t way) const {
+            return cnt[set * ways + way];
+        }
+        uint32_t bits() const { return sets * ways * cache_re_idx_bits(ways); }
+        void save(ckpt_out& out) const { out.put_vec(cnt); }
+        void restore(ckpt_in& in) { in.get_vec(cnt); }
+
+    private:
+        void touch(uint32_t set, uint32_t way) {
+            uint8_t* c = &cnt[set * ways];
+            uint8_t active = c[way];
+            if (active == 0) return; // already the most recently used
+            // increment all counters newer than the current way
+            for (uint32_t w = 0; w < ways; w++) {
+                c[w] = TO_U8(c[w] + (c[w] < active));
+            }
+            c[way] = 0;
+        }
+};
+
+// binary tree of ways-1 bits per set, each node points to the half holding
+// the victim, a reference points the nodes on its path away from it
+// nodes are 1 to ways-1 in heap order, children of n are 2n and 2n+1
+class cache_re_plru_tree {
+    private:
+        uint32_t sets = 0;
+        uint32_t ways = 0;
+        uint32_t levels = 0;
+        std::vector<uint8_t> node;
+
+    public:
+        cache_re_plru_tree(const cache_re_cfg_t& cfg) :
+            sets(cfg.sets), ways(cfg.ways),
+            levels(cache_re_idx_bits(cfg.ways)),
+            node(cfg.sets * cfg.ways, 0) {}
+        void hit(uint32_t set, uint32_t way, const uint8_t*) {
+            touch(set, way);
+        }
+        void fill(uint32_t set, uint32_t way, bool update, const uint8_t*) {
+            if (update) touch(set, way);
+        }
+        uint32_t victim(uint32_t set, const uint8_t* scp) {
+            return cache_re_skip_scp(scp, ways, find(set));
+        }
+        uint32_t way_state(uint32_t set, uint32_t way) const {
+            return (way == find(set)); // 1 for the way the tree points to
+        }
+        uint32_t bits() const { return sets * (ways - 1); }
+        void save(ckpt_out& out) const { out.put_vec(node); }
+        void restore(ckpt_in& in) { in.get_vec(node); }
+
+    private:
+        uint32_t find(uint32_t set) const {
+            const uint8_t* t = &node[set * ways];
+            uint32_t n = 1;
+            for (uint32_t l = 0; l < levels; l++) n = (n << 1) | t[n];
+            return n - ways;
+        }
+        void touch(uint32_t set, uint32_t way) {
+            uint8_t* t = &node[set * ways];
+            // from the leaf up, point the parent to the other child
+            for (uint32_t n = way + ways; n > 1; n >>= 1) {
+                t[n >> 1] = TO_U8((n & 1) ^ 1);
+            }
+        }
+};
+
+// one bit per way, set on reference, the rest are cleared once all would be
+// set, victim is the first way with its bit clear
+// scp ways count as set, they are never victims and would keep the bits set
+class cache_re_plru_bit {
+    private:
+        uint32_t sets = 0;
+        uint32_t ways = 0;
+        std::vector<uint8_t> mru;
+
+    public:
+        cache_re_plru_bit(const cache_re_cfg_t& cfg) :
+            sets(cfg.sets), ways(cfg.ways), mru(cfg.sets * cfg.ways, 0) {}
+        void hit(uint32_t set, uint32_t way, const uint8_t* scp) {
+            touch(set, way, scp);
+        }
+        void fill(uint32_t set, uint32_t way, bool update, const uint8_t* scp) {
+            if (update) touch(set, way, scp);
+        }
+        uint32_t victim(uint32_t set, const uint8_t* scp) {
+            const uint8_t* b = &mru[set * ways];
+            for (uint32_t w = 0; w < ways; w++) {
+                if (!b[w] && !scp[w]) return w;
+            }
+            // only scp ways have their bit clear
+            return cache_re_skip_scp(scp, ways, 0);
+        }
+        uint32_t way_state(uint32_t set, uint32_t way) const {
+            return mru[set * ways + way];
+        }
+        uint32_t bits() const { return sets * ways; }
+        void save(ckpt_out& out) const { out.put_vec(mru); }
+        void restore(ckpt_in& in) { in.get_vec(mru); }
+
+    private:
+        void touch(uint32_t set, uint32_t way, const uint8_t* scp) {
+            uint8_t* b = &mru[set * ways];
+            b[way] = 1;
+            uint8_t all = 1;
+            for (uint32_t w = 0; w < ways; w++) all &= (b[w] | scp[w]);
+            for (uint32_t w = 0; w < ways; w++) {
+                b[w] = TO_U8((b[w] & (all ^ 1)) | (w == way));
+            }
+        }
+};
+
+// re-reference prediction value (rrpv) per way, 0 on hit, a way with the
+// largest value (distant) is replaced, all age until one gets there
+// static (srrip) inserts as long (distant - 1), bimodal (brrip) as distant
+// except for every brrip_long-th fill
+// with no_update insertion, both always insert as distant
+template <bool bimodal>
+class cache_re_rrip {
+    private:
+        static constexpr uint32_t brrip_long = 32; // 5 bit throttle counter
+
+    private:
+        uint32_t sets = 0;
+        uint32_t ways = 0;
+        uint32_t rrpv_bits = 0;
+        uint8_t distant = 0;
+        std::vector<uint8_t> rrpv;
+        uint32_t fills = 0;
+
+    public:
+        cache_re_rrip(const cache_re_cfg_t& cfg) :
+            sets(cfg.sets), ways(cfg.ways), rrpv_bits(cfg.rrpv_bits),
+            distant(TO_U8((1u << cfg.rrpv_bits) - 1)),
+            rrpv(cfg.sets * cfg.ways, distant) {}
+        void hit(uint32_t set, uint32_t way, const uint8_t*) {
+            rrpv[set * ways + way] = 0;
+        }
+        void fill(uint32_t set, uint32_t way, bool update, const uint8_t*) {
+            uint8_t ins = distant;
+            if (update) {
+                if constexpr (bimodal) {
+                    if (fills == 0) ins = TO_U8(distant - 1);
+                    fills = ((fills + 1) == brrip_long) ? 0 : (fills + 1);
+                } else {
+                    ins = TO_U8(distant - 1);
+                }
+            }
+            rrpv[set * ways + way] = ins;
+        }
+        uint32_t victim(uint32_t set, const uint8_t* scp) {
+            uint8_t* r = &rrpv[set * ways];
+            // age by what the oldest non-scp way needs to become distant
+            uint8_t oldest = 0;
+            for (uint32_t w = 0; w < ways; w++) {
+                oldest = std::max(oldest, TO_U8(scp[w] ? 0 : r[w]));
+            }
+            uint32_t age = (distant - oldest);
+            for (uint32_t w = 0; w < ways; w++) {
+                r[w] = TO_U8(std::min(r[w] + age, TO_U32(distant)));
+            }
+            for (uint32_t w = 0; w < ways; w++) {
+                if ((r[w] == distant) && !scp[w]) return w;
+            }
+            return 0; // not reached, the oldest non-scp way is distant now
+        }
+        uint32_t way_state(uint32_t set, uint32_t way) const {
+            return rrpv[set * ways + way];
+        }
+        uint32_t bits() const {
+            return (sets * ways * rrpv_bits) +
+                   (bimodal ? cache_re_idx_bits(brrip_long) : 0);
+        }
+        void save(ckpt_out& out) const {
+            out.put_vec(rrpv);
+            out.put(fills);
+        }
+        void restore(ckpt_in& in) {
+            in.get_vec(rrpv);
+            fills = in.get<uint32_t>();
+        }
+};
+
+// round robin pointer per set, past the last filled way
+// with no_update insertion, the pointer stays on the new line
+class cache_re_fifo {
+    private:
+        uint32_t sets = 0;
+        uint32_t ways = 0;
+        std::vector<uint8_t> next;
+
+    public:
+        cache_re_fifo(const cache_re_cfg_t& cfg) :
+            sets(cfg.sets), ways(cfg.ways), next(cfg.sets, 0) {}
+        void hit(uint32_t, uint32_t, const uint8_t*) {}
+        void fill(uint32_t set, uint32_t way, bool update, const uint8_t*) {
+            if (update) next[set] = TO_U8(((way + 1) == ways) ? 0 : (way + 1));
+        }
+        uint32_t victim(uint32_t set, const uint8_t* scp) {
+            return cache_re_skip_scp(scp, ways, next[set]);
+        }
+        uint32_t way_state(uint32_t set, uint32_t way) const {
+            return (way == next[set]);
+        }
+        uint32_t bits() const { return sets * cache_re_idx_bits(ways); }
+        void save(ckpt_out& out) const { out.put_vec(next); }
+        void restore(ckpt_in& in) { in.get_vec(next); }
+};
+
+// 16 bit lfsr (x^16 + x^14 + x^13 + x^11 + 1), shared by all sets,
+// stepped on every replacement, seeded from the cli
+class cache_re_random {
+    private:
+        static constexpr uint16_t taps = 0xB400;
+
+    private:
+        uint32_t ways = 0;
+        uint16_t lfsr = 1;
+
+    public:
+        cache_re_random(const cache_re_cfg_t& cfg) :
+            ways(cfg.ways),
+            lfsr(TO_U16((cfg.seed % 0xFFFF) + 1)) {} // any seed, never 0
+        void hit(uint32_t, uint32_t, const uint8_t*) {}
+        void fill(uint32_t, uint32_t, bool, const uint8_t*) {}
+        uint32_t victim(uint32_t, const uint8_t* scp) {
+            lfsr = TO_U16((lfsr >> 1) ^ ((lfsr & 1) ? taps : 0));
+            return cache_re_skip_scp(scp, ways, lfsr % ways);
+        }
+        uint32_t way_state(uint32_t, uint32_t) const { return 0; }
+        uint32_t bits() const { return 16; }
+        void save(ckpt_out& out) const { out.put(lfsr); }
+        void restore(ckpt_in& in) { lfsr = in.get<uint16_t>(); }
+};
+
+// same order as cache_re_policy_t
+using cache_re_t = std::variant<
+    cache_re_lru,
+    cache_re_plru_tree,
+    cache_re_plru_bit,
+    cache_re_rrip<false>,
+    cache_re_rrip<true>,
+    cache_re_fifo,
+    cache_re_random
+>;
+
+inline cache_re_t cache_re_make(
+    cache_re_policy_t policy, const cache_re_cfg_t& cfg)
+{
+    switch (policy) {
+        case cache_re_policy_t::lru: return cache_re_lru(cfg);
+        case cache_re_policy_t::plru_tree: return cache_re_plru_tree(cfg);
+        case cache_re_policy_t::plru_bit: return cache_re_plru_bit(cfg);
+        case cache_re_policy_t::srrip: return cache_re_rrip<false>(cfg);
+        case cache_re_policy_t::brrip: return cache_re_rrip<true>(cfg);
+        case cache_re_policy_t::fifo: return cache_re_fifo(cfg);
+        case cache_re_policy_t::random: return cache_re_random(cfg);
+        default: throw std::runtime_error("Unknown cache replacement policy.");
+    }
+}
@@ -28,6 +28,7 @@
     << "\"data\": " << size_struct->data \
     << ", \"tags\": " << size_struct->tags \
     << ", \"metadata\": " << size_struct->metadata \
+    << ", \"re_bits\": " << size_struct->re_bits \
     << ", \"sets\": " << size_struct->sets \
     << ", \"ways\": " << size_struct->ways \
     << ", \"line_size\": " << size_struct->line_size \
@@ -38,21 +39,25 @@ struct cache_size_t {
         uint32_t data;
         uint32_t tags;
         uint32_t metadata;
+        uint32_t re_bits; // replacement policy state, part of metadata
         uint32_t sets;
         uint32_t ways;
         uint32_t line_size;
 
     public:
-        cache_size_t() : data(0), tags(0), metadata(0),
+        cache_size_t() : data(0), tags(0), metadata(0), re_bits(0),
                          sets(0), ways(0), line_size(0) {}
+        // metadata bits are per line, replacement bits for the whole cache
         cache_size_t(uint32_t sets, uint32_t ways, uint32_t line_size,
-                     uint32_t tag_bits_num, uint32_t metadata_bits_num) {
+                     uint32_t tag_bits_num, uint32_t metadata_bits_num,
+                     uint32_t re_bits_num) {
             this->sets = sets;
             this->ways = ways;
             this->line_size = line_size;
             data = sets * ways * line_size;
             tags = ((sets * ways * tag_bits_num) >> 3) + 1;
-            metadata = ((sets * ways * metadata_bits_num) >> 3) + 1;
+            re_bits = re_bits_num;
+            metadata = (((sets * ways * metadata_bits_num) + re_bits) >> 3) + 1;
         }
         void show() const {
             std::cout << " (S/W: " << sets << "/" << ways
@@ -98,6 +103,12 @@ struct ls_pair {
     uint64_t all() const { return ld + st; };
 };
 
+// running totals, e.g. for sampling
+struct cache_cnt_t {
+    uint64_t references;
+    uint64_t misses;
+};
+
 struct cache_stats_t {
     private:
         uint64_t references;
@@ -148,11 +159,14 @@ struct cache_stats_t {
         }
 
     public:
+        uint64_t get_references() const { return references; }
+        uint64_t get_misses(cache_type_t type) const {
+            return (type == cache_type_t::inst) ? misses.ld : misses.all();
+        }
         void summarize(cache_type_t type, uint64_t total_insts) {
             if (total_insts == 0 || references == 0) return;
             hr = (TO_F32(hits.all()) / TO_F32(references) * 100.0f);
-            uint64_t total_misses =
-                (type == cache_type_t::inst) ? misses.ld : misses.all();
+            uint64_t total_misses = get_misses(type);
             mpki = 0;
             if (total_misses == 0) return;
             mpki = (TO_F32(total_misses) / (TO_F32(total_insts) / 1000.0f));
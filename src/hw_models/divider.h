@@ -1,6 +1,7 @@
 #pragma once
 
 #include "defines.h"
+#include "checkpoint.h"
 #include "divider_stats.h"
 
 struct div_result_cache_t {
@@ -64,6 +65,30 @@ class divider {
             }
         }
 
+        void save(ckpt_out& out) const {
+            out.put(div_cache_entries);
+            out.put(div_cache_wr_ptr);
+            for (const auto& e : div_cache) {
+                out.put(e.valid);
+                out.put(e.a);
+                out.put(e.b);
+                out.put(e.op_uns);
+            }
+        }
+
+        // false and unchanged if the number of entries doesn't match
+        bool restore(ckpt_in& in) {
+            if (in.get<uint32_t>() != div_cache_entries) return false;
+            div_cache_wr_ptr = in.get<uint32_t>();
+            for (auto& e : div_cache) {
+                e.valid = in.get<bool>();
+                e.a = in.get<uint32_t>();
+                e.b = in.get<uint32_t>();
+                e.op_uns = in.get<bool>();
+            }
+            return true;
+        }
+
         void log_stats(std::string name, std::ofstream& file) {
             file << "\n\"" << name << "\"" << ": {";
             stats.log(file);
@@ -5,7 +5,8 @@
 // caches
 enum class hw_status_t { miss, hit, none };
 enum class cache_type_t { inst, data, _count };
-enum class cache_re_policy_t { lru, _count };
+enum class cache_re_policy_t {
+    lru, plru_tree, plru_bit, srrip, brrip, fifo, random, _count };
 enum class cache_wr_policy_t { none, wb, wt, _count }; // i$: none, d$: wb, wt
 enum class cache_in_policy_t { update, no_update, _count };
 enum class cache_ref_t { hit, miss, ignore, _count };
@@ -56,6 +57,17 @@ struct bp_cfg_t {
         const char* type_name;
 };
 
+// one grid of predictors of the same type, all combinations of the lists
+struct bp_grid_cfg_t {
+    bp_t type;
+    std::vector<bp_sttc_t> static_method;
+    std::vector<uint8_t> pc_bits;
+    std::vector<uint8_t> cnt_bits;
+    std::vector<uint8_t> lhist_bits;
+    std::vector<uint8_t> ghr_bits;
+    std::vector<bp_pc_folds_t> fold_pc;
+};
+
 // common
 struct hw_running_stats_t {
     hw_status_t ic_hm;
@@ -107,20 +119,36 @@ struct hwmi_str { // hardware model info
         }
 };
 
+// additional cache simulated on the same accesses, stats only
+struct cache_sweep_cfg_t {
+    uint32_t sets;
+    uint32_t ways;
+    cache_re_policy_t re_policy;
+    cache_in_policy_t in_policy;
+    cache_wr_policy_t wr_policy;
+    std::string name;
+};
+
 struct hw_cfg_t {
     // caches
     uint32_t icache_sets;
     uint32_t icache_ways;
     cache_re_policy_t icache_re_policy;
+    uint32_t icache_rrpv_bits;
     cache_in_policy_t icache_in_policy;
     uint32_t dcache_sets;
     uint32_t dcache_ways;
     cache_re_policy_t dcache_re_policy;
+    uint32_t dcache_rrpv_bits;
     cache_in_policy_t dcache_in_policy;
     cache_wr_policy_t dcache_wr_policy;
+    uint32_t cache_seed;
     uint32_t roi_start;
     uint32_t roi_size;
     bool show_cache_state;
+    std::vector<cache_sweep_cfg_t> icache_sweep;
+    std::vector<cache_sweep_cfg_t> dcache_sweep;
+    bool cache_stack_dist;
     uint32_t div_cache_entries;
     // branch predictors
     bp_t bp;
@@ -146,4 +174,8 @@ struct hw_cfg_t {
     // bp other configs
     bool bp_run_all; // optionally, run all predefined predictors
     bool bp_dump_csv;
+    std::vector<bp_grid_cfg_t> bp_grid;
+    // trace
+    std::string hw_trace_save;
+    std::string hw_trace_replay;
 };
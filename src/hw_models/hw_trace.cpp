@@ -0,0 +1,111 @@
+#include "hw_trace.h"
+
+hw_trace_out::hw_trace_out(std::string path, uint32_t mem_size) :
+    path(path),
+    en(!path.empty())
+{
+    if (!en) return;
+    ofs.open(path, std::ios::binary | std::ios::trunc);
+    if (!ofs.is_open()) {
+        std::cerr << "ERROR: Failed to open HW trace file for writing: "
+                  << path << std::endl;
+        throw std::runtime_error("Failed to open HW trace file.");
+    }
+    buf.reserve(hw_trace_cfg::buf_size + 64);
+    for (uint32_t v : {hw_trace_cfg::magic, hw_trace_cfg::version, mem_size}) {
+        for (uint32_t i = 0; i < 4; i++) buf.push_back(TO_U8(v >> (8 * i)));
+    }
+}
+
+void hw_trace_out::flush() {
+    ofs.write(reinterpret_cast<const char*>(buf.data()), TO_I64(buf.size()));
+    buf.clear();
+}
+
+void hw_trace_out::finish(uint64_t profiled_insts) {
+    tag(hw_trace_ev_t::end, 0);
+    varint(profiled_insts);
+    flush();
+    ofs.close();
+    if (ofs.fail()) {
+        std::cerr << "ERROR: Failed to write HW trace file: " << path
+                  << std::endl;
+        throw std::runtime_error("Failed to write HW trace file.");
+    }
+    en = false;
+}
+
+hw_trace_in::hw_trace_in(std::string path, uint32_t mem_size) :
+    ifs(path, std::ios::binary),
+    path(path),
+    buf(hw_trace_cfg::buf_size)
+{
+    if (!ifs.is_open()) {
+        std::cerr << "ERROR: Failed to open HW trace file: " << path
+                  << std::endl;
+        throw std::runtime_error("Failed to open HW trace file.");
+    }
+    std::array<uint32_t, 3> hdr;
+    for (auto& v : hdr) {
+        v = 0;
+        for (uint32_t i = 0; i < 4; i++) v |= (TO_U32(byte()) << (8 * i));
+    }
+    if (hdr[0] != hw_trace_cfg::magic) error("not a HW trace file");
+    if (hdr[1] != hw_trace_cfg::version) {
+        error("unsupported version " + std::to_string(hdr[1]));
+    }
+    if (hdr[2] != mem_size) {
+        std::cerr << "ERROR: HW trace memory size " << hdr[2]
+                  << "B doesn't match --mem_size " << mem_size << "B"
+                  << std::endl;
+        error("memory size mismatch");
+    }
+}
+
+void hw_trace_in::refill() {
+    ifs.read(reinterpret_cast<char*>(buf.data()), TO_I64(buf.size()));
+    len = TO_U64(ifs.gcount());
+    pos = 0;
+    if (len == 0) error("unexpected end of file");
+}
+
+void hw_trace_in::error(const std::string& msg) {
+    std::cerr << "ERROR: HW trace " << path << ": " << msg << std::endl;
+    throw std::runtime_error("Invalid HW trace file.");
+}
+
+bool hw_trace_in::next(hw_trace_rec_t& r) {
+    uint8_t t = byte();
+    r.ev = static_cast<hw_trace_ev_t>(t >> 4);
+    r.aux = TO_U8(t & 0xf);
+    switch (r.ev) {
+        case hw_trace_ev_t::fetch:
+            if (r.aux) last_pc += (TO_U32(r.aux) << 1);
+            else delta(last_pc);
+            r.a = last_pc;
+            break;
+        case hw_trace_ev_t::rd:
+        case hw_trace_ev_t::wr:
+        case hw_trace_ev_t::scp:
+            r.a = delta(last_data);
+            break;
+        case hw_trace_ev_t::branch:
+            r.a = delta(last_pc);
+            r.b = zigzag();
+            r.c = delta(last_pc);
+            break;
+        case hw_trace_ev_t::div:
+            r.a = TO_U32(varint());
+            r.b = TO_U32(varint());
+            break;
+        case hw_trace_ev_t::prof:
+        case hw_trace_ev_t::bypass:
+            break;
+        case hw_trace_ev_t::end:
+            profiled_insts = varint();
+            return false;
+        default: error("unknown event " + std::to_string(t >> 4));
+    }
+    events++;
+    return true;
+}
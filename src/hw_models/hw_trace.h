@@ -0,0 +1,165 @@
+#pragma once
+
+#include "defines.h"
+#include "hw_model_types.h"
+#include "async_out.h"
+
+namespace hw_trace_cfg {
+    constexpr uint32_t magic = 0x54574841; // "AHWT"
+    constexpr uint32_t version = 1;
+    constexpr size_t buf_size = (1u << 20);
+}
+
+// high nibble of the tag byte, low nibble is event specific
+enum class hw_trace_ev_t : uint8_t {
+    fetch, // 1: +2, 2: +4, 0: delta follows
+    rd, // size, delta follows
+    wr, // size, delta follows
+    scp, // mode, delta follows
+    branch, // funct3, pc delta, offset and next pc delta follow
+    div, // unsigned, a and b follow
+    prof, // enable
+    bypass, // enable
+    end = 0xf // profiled instructions follow
+};
+
+struct hw_trace_rec_t {
+    hw_trace_ev_t ev;
+    uint8_t aux;
+    uint32_t a; // address, pc or dividend
+    uint32_t b; // branch offset or divisor
+    uint32_t c; // branch next pc
+};
+
+/*
+HW models trace, references and events as seen by the caches, branch
+predictor and divider, replayed without executing the program
+- addresses are as in main memory, deltas from the previous fetch or branch
+  for instructions and from the previous data access for data, zigzag
+  LEB128 encoded, so a sequential fetch is one byte
+- branches keep pc, offset and outcome, fetches on a branch depend on the
+  prediction and are not recorded, replay issues them for its own predictor
+- profiling and cache bypass changes are recorded as they happen, so stats
+  are collected over the same windows
+*/
+class hw_trace_out {
+    private:
+        async_ofstream ofs;
+        std::string path;
+        std::vector<uint8_t> buf;
+        bool en;
+        bool held = false;
+        uint32_t last_pc = 0;
+        uint32_t last_data = 0;
+
+    private:
+        void tag(hw_trace_ev_t ev, uint32_t aux) {
+            buf.push_back(TO_U8((TO_U32(ev) << 4) | aux));
+        }
+        void varint(uint64_t v) {
+            while (v >= 0x80) {
+                buf.push_back(TO_U8(v | 0x80));
+                v >>= 7;
+            }
+            buf.push_back(TO_U8(v));
+        }
+        void zigzag(uint32_t v) {
+            varint((v << 1) ^ TO_U32(TO_I32(v) >> 31));
+        }
+        void delta(uint32_t v, uint32_t& last) {
+            zigzag(v - last);
+            last = v;
+        }
+        void flush_if_full() {
+            if (buf.size() >= hw_trace_cfg::buf_size) flush();
+        }
+        void flush();
+
+    public:
+        hw_trace_out() = delete;
+        hw_trace_out(std::string path, uint32_t mem_size);
+        bool is_en() const { return en; }
+        // fetches on a branch are redone by the replay
+        void hold(bool enable) { held = enable; }
+        void fetch(norm_address_t addr) {
+            if (held) return;
+            uint32_t d = (addr.v - last_pc);
+            if ((d == 2) || (d == 4)) {
+                tag(hw_trace_ev_t::fetch, d >> 1);
+                last_pc = addr.v;
+            } else {
+                tag(hw_trace_ev_t::fetch, 0);
+                delta(addr.v, last_pc);
+            }
+            flush_if_full();
+        }
+        void data(hw_trace_ev_t ev, norm_address_t addr, uint32_t aux) {
+            tag(ev, aux);
+            delta(addr.v, last_data);
+            flush_if_full();
+        }
+        void branch(
+            norm_address_t pc, int32_t offset, uint32_t funct3,
+            norm_address_t next_pc) {
+            tag(hw_trace_ev_t::branch, funct3);
+            delta(pc.v, last_pc);
+            zigzag(TO_U32(offset));
+            // next fetch follows the resolved pc
+            delta(next_pc.v, last_pc);
+            flush_if_full();
+        }
+        void div(uint32_t a, uint32_t b, bool op_uns) {
+            tag(hw_trace_ev_t::div, op_uns);
+            varint(a);
+            varint(b);
+            flush_if_full();
+        }
+        void state(hw_trace_ev_t ev, bool enable) { tag(ev, enable); }
+        void finish(uint64_t profiled_insts);
+};
+
+class hw_trace_in {
+    private:
+        std::ifstream ifs;
+        std::string path;
+        std::vector<uint8_t> buf;
+        size_t pos = 0;
+        size_t len = 0;
+        uint32_t last_pc = 0;
+        uint32_t last_data = 0;
+        uint64_t profiled_insts = 0;
+        uint64_t events = 0;
+
+    private:
+        uint8_t byte() {
+            if (pos == len) refill();
+            return buf[pos++];
+        }
+        uint64_t varint() {
+            uint64_t v = 0;
+            for (uint32_t s = 0; s < 64; s += 7) {
+                uint8_t b = byte();
+                v |= (TO_U64(b & 0x7f) << s);
+                if (!(b & 0x80)) return v;
+            }
+            error("invalid varint");
+        }
+        uint32_t zigzag() {
+            uint32_t z = TO_U32(varint());
+            return ((z >> 1) ^ (~(z & 1) + 1));
+        }
+        uint32_t delta(uint32_t& last) {
+            last += zigzag();
+            return last;
+        }
+        void refill();
+        [[noreturn]] void error(const std::string& msg);
+
+    public:
+        hw_trace_in() = delete;
+        hw_trace_in(std::string path, uint32_t mem_size);
+        // false at the end of the trace
+        bool next(hw_trace_rec_t& r);
+        uint64_t get_profiled_insts() const { return profiled_insts; }
+        uint64_t get_events() const { return events; }
+};
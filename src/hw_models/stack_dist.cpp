@@ -0,0 +1,61 @@
+#include "stack_dist.h"
+
+stack_dist::stack_dist(std::string name, bool en) : name(name), en(en) {
+    if (!en) return;
+    for (size_t l = 0; l < levels.size(); l++) {
+        auto& lvl = levels[l];
+        lvl.set_mask = ((1u << l) - 1);
+        lvl.sets.resize(1u << l);
+        lvl.hist.resize(cache_cfg::max_ways + 1, 0);
+    }
+}
+
+void stack_dist::reference(norm_address_t addr) {
+    uint32_t line = (addr.v >> cache_cfg::byte_addr_bits);
+    auto [it, is_cold] = last.try_emplace(line);
+    auto& times = it->second;
+    for (size_t l = 0; l < levels.size(); l++) {
+        auto& lvl = levels[l];
+        auto& set = lvl.sets[line & lvl.set_mask];
+        uint32_t d = cache_cfg::max_ways; // cold or too far for any ways
+        if (!is_cold && set.is_mru(times[l])) {
+            // same line again, e.g. sequential fetch, order doesn't change
+            if (prof_active) lvl.hist[0]++;
+            continue;
+        }
+        if (!is_cold) {
+            d = std::min(set.dist(times[l]), d);
+            set.remove(times[l]);
+        }
+        if (set.full()) {
+            // only updates existing entries, 'it' stays valid
+            set.compact([this, l](uint32_t ln, uint32_t t) {
+                last[ln][l] = t;
+            });
+        }
+        times[l] = set.insert(line);
+        if (prof_active) lvl.hist[d]++;
+    }
+    if (!prof_active) return;
+    references++;
+    if (is_cold) cold++;
+}
+
+// misses for each ways, from 1 to max ways, per set count
+void stack_dist::log(std::ofstream& ofs) const {
+    ofs << "\"" << name << "\": {"
+        << JSON_N << "\"references\": " << references << ","
+        << JSON_N << "\"cold\": " << cold << ","
+        << JSON_N << "\"misses\": {";
+    for (size_t l = 0; l < levels.size(); l++) {
+        const auto& lvl = levels[l];
+        ofs << (l ? "," : "") << JSON_N << "\"" << (1u << l) << "\": [";
+        uint64_t hits = 0;
+        for (uint32_t w = 0; w < cache_cfg::max_ways; w++) {
+            hits += lvl.hist[w];
+            ofs << (w ? ", " : "") << (references - hits);
+        }
+        ofs << "]";
+    }
+    ofs << JSON_N << "}" << JSON_N << "}";
+}
@@ -0,0 +1,111 @@
+#pragma once
+
+#include "defines.h"
+#include "types.h"
+
+/*
+LRU stack distance (Mattson) profiler
+- one pass gives the misses of every LRU cache with the same line size, for
+  all power of 2 set counts and associativities supported by the cache model
+- stack distance is the number of other lines in the same set referenced
+  since the last reference to the line, it's a hit for any ways > distance
+- per set count, each set keeps the last reference time of its lines in a
+  Fenwick tree, so the distance is a prefix sum, O(log n) per reference
+- times are renumbered when a set runs out of them, trees are bound by the
+  number of lines in the set, not by the length of the run
+- equivalent to lru replacement with update insertion, write policy doesn't
+  change hits since caches write-allocate, scp hints are not modeled
+*/
+
+// lines of one set, ordered by their last reference
+class stack_dist_set {
+    private:
+        static constexpr uint32_t min_cap = 16;
+        static constexpr uint32_t empty = UINT32_MAX;
+        std::vector<uint32_t> tree; // Fenwick over times, 1-based
+        std::vector<uint32_t> line_at; // by time, empty if not the last ref
+        uint32_t now = 0; // next time
+        uint32_t live = 0; // lines in the set
+
+    private:
+        static uint32_t lsb(uint32_t i) { return (i & (~i + 1)); }
+        void add(uint32_t t, bool inc) {
+            for (uint32_t i = t + 1; i < tree.size(); i += lsb(i)) {
+                if (inc) tree[i]++;
+                else tree[i]--;
+            }
+        }
+        uint32_t prefix(uint32_t t) const { // lines at times <= t
+            uint32_t sum = 0;
+            for (uint32_t i = t + 1; i > 0; i -= lsb(i)) sum += tree[i];
+            return sum;
+        }
+
+    public:
+        stack_dist_set() : tree(min_cap + 1, 0), line_at(min_cap, empty) {}
+        bool full() const { return (now == line_at.size()); }
+        bool is_mru(uint32_t t) const { return ((t + 1) == now); }
+        // lines referenced after time t
+        uint32_t dist(uint32_t t) const { return (live - prefix(t)); }
+        void remove(uint32_t t) {
+            add(t, false);
+            line_at[t] = empty;
+            live--;
+        }
+        uint32_t insert(uint32_t line) {
+            add(now, true);
+            line_at[now] = line;
+            live++;
+            return now++;
+        }
+        // renumber live lines from 0 in the same order, call on_move for each
+        template <typename F>
+        void compact(F on_move) {
+            uint32_t cap = min_cap;
+            while (cap < (2 * (live + 1))) cap <<= 1;
+            std::vector<uint32_t> old_line_at(cap, empty);
+            std::swap(line_at, old_line_at);
+            tree.assign(cap + 1, 0);
+            now = 0;
+            for (uint32_t line : old_line_at) {
+                if (line == empty) continue;
+                line_at[now] = line;
+                tree[now + 1] = 1;
+                on_move(line, now++);
+            }
+            // linear Fenwick build
+            for (uint32_t i = 1; i <= cap; i++) {
+                uint32_t parent = (i + lsb(i));
+                if (parent <= cap) tree[parent] += tree[i];
+            }
+        }
+};
+
+class stack_dist {
+    private:
+        // one level per set count, 1, 2, 4 ... cache_cfg::max_sets
+        static constexpr size_t levels_num =
+            (__builtin_ctz(cache_cfg::max_sets) + 1);
+        struct level_t {
+            uint32_t set_mask;
+            std::vector<stack_dist_set> sets;
+            // by distance, last one is max_ways or more, and cold
+            std::vector<uint64_t> hist;
+        };
+        std::string name;
+        bool en;
+        bool prof_active = false;
+        std::array<level_t, levels_num> levels;
+        // line to its last reference time in each level
+        std::unordered_map<uint32_t, std::array<uint32_t, levels_num>> last;
+        uint64_t references = 0;
+        uint64_t cold = 0;
+
+    public:
+        stack_dist() = delete;
+        stack_dist(std::string name, bool en);
+        bool is_en() const { return en; }
+        void profiling(bool enable) { prof_active = enable; }
+        void reference(norm_address_t addr);
+        void log(std::ofstream& ofs) const;
+};
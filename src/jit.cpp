@@ -0,0 +1,407 @@
+#include "jit.h"
+
+#ifdef JIT_EN
+#include <cstring>
+#include <sys/mman.h>
+
+// host registers, only the low 3 bits of r12 are encoded in modrm
+namespace {
+    constexpr uint8_t eax = 0;
+    constexpr uint8_t ecx = 1;
+    constexpr uint8_t edx = 2;
+    constexpr uint8_t esi = 6;
+    constexpr uint8_t exit_sz = 20; // emit_exit
+    static_assert(offsetof(jit_exit_t, pc) == 0);
+    static_assert(offsetof(jit_exit_t, retired) == 4);
+    static_assert(offsetof(jit_exit_t, status) == 8);
+
+    // condition codes for jcc, setcc and cmovcc
+    constexpr uint8_t cc_b = 0x2;
+    constexpr uint8_t cc_ae = 0x3;
+    constexpr uint8_t cc_e = 0x4;
+    constexpr uint8_t cc_ne = 0x5;
+    constexpr uint8_t cc_a = 0x7;
+    constexpr uint8_t cc_l = 0xc;
+    constexpr uint8_t cc_ge = 0xd;
+    constexpr uint8_t cc_g = 0xf;
+
+    // position within a run of related ops, e.g. lb to lhu
+    uint32_t nth(pd_op_t op, pd_op_t first) {
+        return (TO_U32(op) - TO_U32(first));
+    }
+
+    // add, sub, xor, or, and with a register operand: op r32, r/m32
+    uint8_t alu_opc(pd_op_t op) {
+        switch (op) {
+            case pd_op_t::op_add: return 0x03;
+            case pd_op_t::op_sub: return 0x2b;
+            case pd_op_t::op_xor: return 0x33;
+            case pd_op_t::op_or: return 0x0b;
+            default: return 0x23;
+        }
+    }
+
+    // addi, xori, ori, andi: op r/m32, imm32 with the opcode extension
+    uint8_t alu_ext(pd_op_t op) {
+        switch (op) {
+            case pd_op_t::op_addi: return 0;
+            case pd_op_t::op_xori: return 6;
+            case pd_op_t::op_ori: return 1;
+            default: return 4;
+        }
+    }
+
+    // the interpreter raises the trap, translated code stops before the jump
+    bool misaligned([[maybe_unused]] uint32_t target) {
+        #ifdef RV32C_EN
+        return false;
+        #else
+        return ((target % 4) != 0);
+        #endif
+    }
+}
+
+jit_x64::jit_x64(const jit_helpers_t& h) : h(h) {
+    void* p = mmap(nullptr, jit_cfg::arena_size,
+                   PROT_READ | PROT_WRITE | PROT_EXEC,
+                   MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (p == MAP_FAILED) {
+        SIM_WARNING << "Can't map memory for host code, JIT disabled\n";
+        return;
+    }
+    arena = static_cast<uint8_t*>(p);
+}
+
+jit_x64::~jit_x64() {
+    if (arena != nullptr) munmap(arena, jit_cfg::arena_size);
+}
+
+// called as jit_block_fn: rdi = ex, rsi = rf, rdx = core
+// rbx, rbp and r12 keep rf, ex and core across helper calls
+void* jit_x64::compile(const pd_block_t& blk) {
+    if ((used + jit_cfg::block_max) > jit_cfg::arena_size) return nullptr;
+    code = arena + used;
+    pos = 0;
+    stubs.clear();
+    to_epilogue.clear();
+
+    // push rbx, rbp, r12, keeps the stack 16-byte aligned for calls
+    bytes({0x53, 0x55, 0x41, 0x54});
+    bytes({0x48, 0x89, 0xfd}); // mov rbp, rdi
+    bytes({0x48, 0x89, 0xf3}); // mov rbx, rsi
+    bytes({0x49, 0x89, 0xd4}); // mov r12, rdx
+
+    uint32_t pc = blk.pc;
+    bool ended = false;
+    for (uint32_t i = 0; (i < blk.len) && !ended; i++) {
+        ended = emit(blk.insts[i], pc, i);
+        pc += blk.insts[i].isz;
+    }
+    if (!ended) emit_exit(pc, blk.len, jit_status_t::next);
+    for (const auto& s : stubs) emit_stub(s);
+
+    // ex->pc = eax, ex->retired = edx, ex->status = ecx
+    size_t epilogue = pos;
+    bytes({0x89, 0x45, 0x00, 0x89, 0x55, 0x04, 0x89, 0x4d, 0x08});
+    bytes({0x41, 0x5c, 0x5d, 0x5b, 0xc3}); // pop r12, rbp, rbx, ret
+    for (size_t at : to_epilogue) patch32(at, epilogue);
+
+    used += ((pos + 15) & ~size_t(15));
+    return code;
+}
+
+// true if the instruction ends the block
+bool jit_x64::emit(const pd_inst_t& d, uint32_t pc, uint32_t i) {
+    // results to x0 are dropped, only memory ops and control flow matter
+    bool rd0 = (d.rd == 0);
+    switch (d.op) {
+        // rv32i
+        case pd_op_t::op_add:
+        case pd_op_t::op_sub:
+        case pd_op_t::op_xor:
+        case pd_op_t::op_or:
+        case pd_op_t::op_and:
+            if (rd0) break;
+            ld(eax, d.rs1);
+            op_rm(alu_opc(d.op), eax, d.rs2);
+            st(d.rd, eax);
+            break;
+        case pd_op_t::op_sll:
+        case pd_op_t::op_srl:
+        case pd_op_t::op_sra: {
+            if (rd0) break;
+            static constexpr uint8_t ext[] = {4, 5, 7}; // shl, shr, sar
+            ld(eax, d.rs1);
+            ld(ecx, d.rs2);
+            b(0xd3); // by cl, masked to 5 bits like the interpreter
+            b(TO_U8(0xc0 | (ext[nth(d.op, pd_op_t::op_sll)] << 3)));
+            st(d.rd, eax);
+            break;
+        }
+        case pd_op_t::op_slt:
+        case pd_op_t::op_sltu:
+            if (rd0) break;
+            ld(ecx, d.rs1);
+            bytes({0x31, 0xc0}); // xor eax, eax
+            op_rm(0x3b, ecx, d.rs2);
+            setcc((d.op == pd_op_t::op_slt) ? cc_l : cc_b);
+            st(d.rd, eax);
+            break;
+        case pd_op_t::op_addi:
+        case pd_op_t::op_xori:
+        case pd_op_t::op_ori:
+        case pd_op_t::op_andi:
+            if (rd0) break;
+            ld(eax, d.rs1);
+            op_ri(alu_ext(d.op), eax, d.imm);
+            st(d.rd, eax);
+            break;
+        case pd_op_t::op_slli:
+        case pd_op_t::op_srli:
+        case pd_op_t::op_srai: {
+            if (rd0) break;
+            static constexpr uint8_t ext[] = {4, 5, 7};
+            ld(eax, d.rs1);
+            b(0xc1);
+            b(TO_U8(0xc0 | (ext[nth(d.op, pd_op_t::op_slli)] << 3)));
+            b(TO_U8(d.imm & 0x1f)); // srai keeps funct7 in imm
+            st(d.rd, eax);
+            break;
+        }
+        case pd_op_t::op_slti:
+        case pd_op_t::op_sltiu:
+            if (rd0) break;
+            ld(ecx, d.rs1);
+            bytes({0x31, 0xc0}); // xor eax, eax
+            op_ri(7, ecx, d.imm);
+            setcc((d.op == pd_op_t::op_slti) ? cc_l : cc_b);
+            st(d.rd, eax);
+            break;
+        case pd_op_t::op_lb:
+        case pd_op_t::op_lh:
+        case pd_op_t::op_lw:
+        case pd_op_t::op_lbu:
+        case pd_op_t::op_lhu:
+            bytes({0x4c, 0x89, 0xe7}); // mov rdi, r12
+            ld(esi, d.rs1);
+            op_ri(0, esi, d.imm);
+            mov_ri(edx, pc);
+            mov_ri(ecx, d.inst);
+            emit_call(reinterpret_cast<uint64_t>(
+                h.load[nth(d.op, pd_op_t::op_lb)]));
+            bytes({0x48, 0x0f, 0xba, 0xe0, 0x20}); // bt rax, 32
+            stubs.push_back({jcc32(cc_b), pc, d.isz, i, false});
+            st(d.rd, eax);
+            break;
+        case pd_op_t::op_sb:
+        case pd_op_t::op_sh:
+        case pd_op_t::op_sw:
+            bytes({0x4c, 0x89, 0xe7}); // mov rdi, r12
+            ld(esi, d.rs1);
+            op_ri(0, esi, d.imm);
+            ld(edx, d.rs2);
+            mov_ri(ecx, pc);
+            bytes({0x41, 0xb8}); // mov r8d, imm32
+            d32(d.inst);
+            emit_call(reinterpret_cast<uint64_t>(
+                h.store[nth(d.op, pd_op_t::op_sb)]));
+            bytes({0x85, 0xc0}); // test eax, eax
+            stubs.push_back({jcc32(cc_ne), pc, d.isz, i, true});
+            break;
+        case pd_op_t::op_beq:
+        case pd_op_t::op_bne:
+        case pd_op_t::op_blt:
+        case pd_op_t::op_bge:
+        case pd_op_t::op_bltu:
+        case pd_op_t::op_bgeu: {
+            static constexpr uint8_t cc[] = {
+                cc_e, cc_ne, cc_l, cc_ge, cc_b, cc_ae};
+            uint32_t target = (pc + d.imm);
+            ld(eax, d.rs1);
+            op_rm(0x3b, eax, d.rs2);
+            size_t taken = jcc32(cc[nth(d.op, pd_op_t::op_beq)]);
+            emit_exit(pc + d.isz, i + 1, jit_status_t::next);
+            patch32(taken, pos);
+            if (misaligned(target)) emit_exit(pc, i, jit_status_t::leave);
+            else emit_exit(target, i + 1, jit_status_t::next);
+            return true;
+        }
+        case pd_op_t::op_jal: {
+            uint32_t target = (pc + d.imm);
+            if (misaligned(target)) {
+                emit_exit(pc, i, jit_status_t::leave);
+                return true;
+            }
+            mov_mi(d.rd, pc + d.isz);
+            emit_exit(target, i + 1, jit_status_t::next);
+            return true;
+        }
+        case pd_op_t::op_jalr:
+            ld(eax, d.rs1);
+            op_ri(0, eax, d.imm);
+            op_ri(4, eax, 0xfffffffe);
+            #ifndef RV32C_EN
+            {
+                bytes({0xa8, 0x03}); // test al, 3
+                size_t aligned = jcc32(cc_e);
+                emit_exit(pc, i, jit_status_t::leave);
+                patch32(aligned, pos);
+            }
+            #endif
+            mov_mi(d.rd, pc + d.isz); // after rs1 is read, rd may be rs1
+            emit_exit_dyn(i + 1, jit_status_t::next);
+            return true;
+        case pd_op_t::op_lui:
+            mov_mi(d.rd, d.imm);
+            break;
+        case pd_op_t::op_auipc:
+            mov_mi(d.rd, d.imm + pc);
+            break;
+
+        // rv32m
+        case pd_op_t::op_mul:
+            if (rd0) break;
+            ld(eax, d.rs1);
+            b(0x0f);
+            op_rm(0xaf, eax, d.rs2); // imul eax, rs2
+            st(d.rd, eax);
+            break;
+        case pd_op_t::op_mulh:
+        case pd_op_t::op_mulhsu:
+        case pd_op_t::op_mulhu:
+            // 64-bit product of the sign or zero extended operands
+            if (rd0) break;
+            if (d.op == pd_op_t::op_mulhu) {
+                ld(eax, d.rs1);
+            } else {
+                b(0x48);
+                op_rm(0x63, eax, d.rs1); // movsxd rax, rs1
+            }
+            if (d.op == pd_op_t::op_mulh) {
+                b(0x48);
+                op_rm(0x63, ecx, d.rs2); // movsxd rcx, rs2
+            } else {
+                ld(ecx, d.rs2);
+            }
+            bytes({0x48, 0x0f, 0xaf, 0xc1}); // imul rax, rcx
+            bytes({0x48, 0xc1, 0xe8, 0x20}); // shr rax, 32
+            st(d.rd, eax);
+            break;
+        case pd_op_t::op_div:
+        case pd_op_t::op_divu:
+        case pd_op_t::op_rem:
+        case pd_op_t::op_remu:
+            if (rd0) break;
+            bytes({0x4c, 0x89, 0xe7}); // mov rdi, r12
+            ld(esi, d.rs1);
+            ld(edx, d.rs2);
+            emit_call(reinterpret_cast<uint64_t>(
+                h.div[nth(d.op, pd_op_t::op_div)]));
+            st(d.rd, eax);
+            break;
+
+        // zbb
+        case pd_op_t::op_max:
+        case pd_op_t::op_maxu:
+        case pd_op_t::op_min:
+        case pd_op_t::op_minu: {
+            // rs1 unless rs2 wins the compare
+            if (rd0) break;
+            static constexpr uint8_t cc[] = {cc_l, cc_b, cc_g, cc_a};
+            ld(eax, d.rs1);
+            ld(ecx, d.rs2);
+            bytes({0x39, 0xc8}); // cmp eax, ecx
+            bytes({0x0f, TO_U8(0x40 | cc[nth(d.op, pd_op_t::op_max)]),
+                   0xc1}); // cmovcc eax, ecx
+            st(d.rd, eax);
+            break;
+        }
+
+        default: // fallback
+            emit_exit(pc, i, jit_status_t::leave);
+            return true;
+    }
+    return false;
+}
+
+// load traps, store traps and stores that have to leave the block
+void jit_x64::emit_stub(const stub_t& s) {
+    patch32(s.at, pos);
+    if (s.store) {
+        // cmp eax, trapped; jne over the trapped exit
+        bytes({0x83, 0xf8, TO_U8(jit_status_t::trapped), 0x75, exit_sz});
+    }
+    emit_exit(s.pc, s.idx, jit_status_t::trapped);
+    if (s.store) emit_exit(s.pc + s.isz, s.idx + 1, jit_status_t::leave);
+}
+
+void jit_x64::emit_exit(uint32_t pc, uint32_t retired, jit_status_t status) {
+    mov_ri(eax, pc);
+    emit_exit_dyn(retired, status);
+}
+
+void jit_x64::emit_exit_dyn(uint32_t retired, jit_status_t status) {
+    mov_ri(edx, retired);
+    mov_ri(ecx, TO_U32(status));
+    b(0xe9); // jmp epilogue
+    to_epilogue.push_back(pos);
+    d32(0);
+}
+
+void jit_x64::emit_call(uint64_t fn) {
+    bytes({0x48, 0xb8}); // mov rax, imm64
+    q64(fn);
+    bytes({0xff, 0xd0}); // call rax
+}
+
+void jit_x64::d32(uint32_t v) {
+    std::memcpy(code + pos, &v, 4);
+    pos += 4;
+}
+
+void jit_x64::q64(uint64_t v) {
+    std::memcpy(code + pos, &v, 8);
+    pos += 8;
+}
+
+size_t jit_x64::jcc32(uint8_t cc) {
+    bytes({0x0f, TO_U8(0x80 | cc)});
+    size_t at = pos;
+    d32(0);
+    return at;
+}
+
+void jit_x64::patch32(size_t at, size_t target) {
+    int32_t rel = TO_I32(TO_I64(target) - TO_I64(at + 4));
+    std::memcpy(code + at, &rel, 4);
+}
+
+// guest register x at [rbx + 4 * x], disp8
+void jit_x64::ld(uint8_t r, uint8_t x) {
+    op_rm(0x8b, r, x);
+}
+
+void jit_x64::st(uint8_t x, uint8_t r) {
+    if (x == 0) return;
+    op_rm(0x89, r, x);
+}
+
+void jit_x64::setcc(uint8_t cc) {
+    bytes({0x0f, TO_U8(0x90 | cc), 0xc0}); // setcc al
+}
+
+void jit_x64::op_rm(uint8_t opc, uint8_t r, uint8_t x) {
+    bytes({opc, TO_U8(0x43 | (r << 3)), TO_U8(x * 4)});
+}
+
+void jit_x64::op_ri(uint8_t ext, uint8_t r, uint32_t imm) {
+    bytes({0x81, TO_U8(0xc0 | (ext << 3) | r)});
+    d32(imm);
+}
+
+void jit_x64::mov_mi(uint8_t x, uint32_t imm) {
+    if (x == 0) return;
+    bytes({0xc7, 0x43, TO_U8(x * 4)});
+    d32(imm);
+}
+#endif
@@ -0,0 +1,103 @@
+#pragma once
+
+#include "defines.h"
+#include "decode_cache.h"
+
+#ifdef JIT_EN
+namespace jit_cfg {
+    constexpr size_t arena_size = (16u << 20); // host code of all blocks
+    constexpr size_t block_max = 8192; // worst case host code of one block
+}
+
+// how a translated block was left
+enum class jit_status_t : uint32_t {
+    next, // block done, continue at pc
+    trapped, // load or store trapped, the trap is already taken
+    leave, // pc goes through single_step, or a store hit mmio or decoded code
+};
+
+struct jit_exit_t {
+    uint32_t pc; // next pc, not set when trapped
+    uint32_t retired; // instructions retired by the block
+    jit_status_t status;
+};
+
+class core;
+using jit_block_fn = void (*)(jit_exit_t* ex, int32_t* rf, core* c);
+
+// called from translated code for what isn't inlined
+// loads return the value in the low word and trapped in bit 32
+// stores return jit_status_t, next if the block can go on
+struct jit_helpers_t {
+    using load_fn = uint64_t (*)(
+        core* c, uint32_t addr, uint32_t pc, uint32_t inst);
+    using store_fn = uint32_t (*)(
+        core* c, uint32_t addr, uint32_t data, uint32_t pc, uint32_t inst);
+    using alu_fn = uint32_t (*)(core* c, uint32_t a, uint32_t b);
+    std::array<load_fn, 5> load; // lb, lh, lw, lbu, lhu
+    std::array<store_fn, 3> store; // sb, sh, sw
+    std::array<alu_fn, 4> div; // div, divu, rem, remu
+};
+
+/*
+Translates complete predecoded blocks to x86-64 host code
+- guest registers stay in the register file, eax, ecx and edx are scratch
+- loads, stores and division call back into the core
+- control flow ends the block and returns the next pc, so the caller can
+  keep the event horizon and look up the next block
+- fallback instructions and misaligned jump targets end the block before
+  them, the interpreter runs them
+*/
+class jit_x64 {
+    private:
+        jit_helpers_t h;
+        uint8_t* arena = nullptr;
+        size_t used = 0;
+        uint8_t* code; // block being emitted
+        size_t pos;
+        struct stub_t {
+            size_t at; // rel32 field of the jump to the stub
+            uint32_t pc;
+            uint32_t isz;
+            uint32_t idx; // instruction within the block
+            bool store; // store result, may also leave the block
+        };
+        std::vector<stub_t> stubs; // out of line exits, after the block
+        std::vector<size_t> to_epilogue; // rel32 fields to patch
+
+    public:
+        jit_x64() = delete;
+        jit_x64(const jit_helpers_t& h);
+        ~jit_x64();
+        jit_x64(const jit_x64&) = delete;
+        jit_x64& operator=(const jit_x64&) = delete;
+
+        bool is_en() const { return (arena != nullptr); }
+        // nullptr if the arena is full, reset it and flush the blocks
+        void* compile(const pd_block_t& b);
+        void reset() { used = 0; }
+
+    private:
+        bool emit(const pd_inst_t& d, uint32_t pc, uint32_t i);
+        void emit_stub(const stub_t& s);
+        void emit_exit(uint32_t pc, uint32_t retired, jit_status_t status);
+        // pc in eax
+        void emit_exit_dyn(uint32_t retired, jit_status_t status);
+        void emit_call(uint64_t fn);
+        // raw encoding
+        void b(uint8_t v) { code[pos++] = v; }
+        void bytes(std::initializer_list<uint8_t> v) { for (auto x : v) b(x); }
+        void d32(uint32_t v);
+        void q64(uint64_t v);
+        size_t jcc32(uint8_t cc); // returns the rel32 field
+        void patch32(size_t at, size_t target);
+        // 32-bit ops on scratch registers and guest registers in rf
+        void ld(uint8_t r, uint8_t x);
+        void st(uint8_t x, uint8_t r);
+        void op_rm(uint8_t opc, uint8_t r, uint8_t x);
+        void op_ri(uint8_t ext, uint8_t r, uint32_t imm);
+        void mov_ri(uint8_t r, uint32_t imm) { b(0xb8 + r); d32(imm); }
+        void mov_mi(uint8_t x, uint32_t imm);
+        void setcc(uint8_t cc);
+};
+#endif
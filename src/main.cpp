@@ -92,7 +92,13 @@ const ordered_map<perf_event_t> perf_event_map = {
 
 #ifdef HW_MODELS_EN
 const ordered_map<cache_re_policy_t> cache_re_policy_map = {
-    {"lru", cache_re_policy_t::lru}
+    {"lru", cache_re_policy_t::lru},
+    {"plru_tree", cache_re_policy_t::plru_tree},
+    {"plru_bit", cache_re_policy_t::plru_bit},
+    {"srrip", cache_re_policy_t::srrip},
+    {"brrip", cache_re_policy_t::brrip},
+    {"fifo", cache_re_policy_t::fifo},
+    {"random", cache_re_policy_t::random}
 };
 
 const ordered_map<cache_in_policy_t> cache_in_policy_map = {
@@ -138,6 +144,8 @@ struct defs_t {
     static constexpr char mem_dump_size[] = "0";
     static constexpr char run_insts[] = "0";
     static constexpr char run_steps[] = "0";
+    static constexpr char mem_size[] = "128K";
+    static constexpr char bbv_interval[] = "0";
     #ifdef UART_EN
     static constexpr char uart_show[] = "false";
     #ifdef UART_INPUT_EN
@@ -148,20 +156,37 @@ struct defs_t {
     static constexpr char prof_pc_start[] = "0";
     static constexpr char prof_pc_stop[] = "0";
     static constexpr char prof_pc_sm[] = "0";
+    static constexpr char prof_inst_start[] = "0";
     static constexpr char exit_on_prof_stop[] = "false";
     static constexpr char prof_trace[] = "false";
     static constexpr char perf_event[] = "ret_inst";
     static constexpr char rf_usage[] = "false";
     static constexpr char no_callstack[] = "false";
+    static constexpr char perf_sample[] = "0";
     static constexpr char prof_show[] = "false";
+    #ifdef HW_MODELS_EN
+    static constexpr char smarts_period[] = "0";
+    static constexpr char smarts_unit[] = "1000";
+    #endif
+    #ifdef DECODE_CACHE_EN
+    static constexpr char fast_forward[] = "false";
+    static constexpr char ff_warmup[] = "0";
+    #endif
     #endif
     #ifdef DASM_EN
     static constexpr char log[] = "false";
+    #endif
+    #ifdef EXEC_LOG_BIN_EN
+    static constexpr char log_bin[] = "false";
+    #endif
+    #ifdef EXEC_LOG_EN
     #ifdef PROFILERS_EN
     static constexpr char log_always[] = "false";
     #endif
-    static constexpr char log_state[] = "false";
     static constexpr char rf_names[] = "x";
+    #endif
+    #ifdef DASM_EN
+    static constexpr char log_state[] = "false";
     static constexpr char log_hw_models[] = "false";
     #endif
 };
@@ -172,17 +197,23 @@ struct hw_defs_t {
     static constexpr char icache_sets[] = "32";
     static constexpr char icache_ways[] = "2";
     static constexpr char icache_re_policy[] = "lru";
+    static constexpr char icache_rrpv_bits[] = "2";
     static constexpr char icache_in_policy[] = "update";
     // dcache
     static constexpr char dcache_sets[] = "16";
     static constexpr char dcache_ways[] = "4";
     static constexpr char dcache_re_policy[] = "lru";
+    static constexpr char dcache_rrpv_bits[] = "2";
     static constexpr char dcache_in_policy[] = "update";
     static constexpr char dcache_wr_policy[] = "wb";
     // caches other configs
+    static constexpr char cache_seed[] = "1";
     static constexpr char roi_start[] = "0";
     static constexpr char roi_size[] = "0";
     static constexpr char show_cache_state[] = "false";
+    static constexpr char icache_sweep[] = "";
+    static constexpr char dcache_sweep[] = "";
+    static constexpr char stack_dist[] = "false";
     static constexpr char div_cache_entries[] = "1";
     // branch predictors
     static constexpr char bp[] = "bimodal";
@@ -206,9 +237,168 @@ struct hw_defs_t {
     // bp other configs
     static constexpr char bp_run_all[] = "false";
     static constexpr char bp_dump_csv[] = "false";
+    static constexpr char bp_grid[] = "";
 };
+
+// sets:ways[:re_policy[:in_policy[:wr_policy]]] per config
+// omitted policies are taken from the main cache, given as policies
+std::vector<cache_sweep_cfg_t> resolve_cache_sweep(
+    const std::string& cache_name,
+    const std::vector<std::string>& args,
+    const std::vector<std::string>& policies,
+    const cache_sweep_cfg_t& main_cfg)
+{
+    const std::string name = (cache_name + "_sweep");
+    const bool is_data = (policies.size() == 3);
+    std::vector<cache_sweep_cfg_t> cfgs;
+    auto same = [](const cache_sweep_cfg_t& a, const cache_sweep_cfg_t& b) {
+        return (a.sets == b.sets) && (a.ways == b.ways) &&
+               (a.re_policy == b.re_policy) && (a.in_policy == b.in_policy) &&
+               (a.wr_policy == b.wr_policy);
+    };
+    for (const auto& arg : args) {
+        if (arg.empty()) continue;
+        std::vector<std::string> f = split_arg(arg, ':');
+        if ((f.size() < 2) || (f.size() > (policies.size() + 2))) {
+            std::cout << "Invalid value for " << name << ": " << arg
+                      << ". Expected sets:ways[:re_policy[:in_policy"
+                      << (is_data ? "[:wr_policy]]]" : "]]") << std::endl;
+            throw std::invalid_argument("");
+        }
+        for (size_t i = f.size(); i < (policies.size() + 2); i++) {
+            f.push_back(policies[i - 2]);
+        }
+        cache_sweep_cfg_t c;
+        c.sets = TO_U32(std::stoul(f[0], nullptr, 10));
+        c.ways = TO_U32(std::stoul(f[1], nullptr, 10));
+        c.re_policy = resolve_arg(name, f[2], cache_re_policy_map);
+        c.in_policy = resolve_arg(name, f[3], cache_in_policy_map);
+        c.wr_policy = is_data ?
+            resolve_arg(name, f[4], cache_wr_policy_map) :
+            cache_wr_policy_t::none;
+        // e.g. dcache_64x2_lru_update_wb
+        c.name = (cache_name + "_" + f[0] + "x" + f[1]);
+        for (size_t i = 2; i < f.size(); i++) c.name += ("_" + f[i]);
+        // each config would only log the same stats again
+        if (same(c, main_cfg)) {
+            std::cout << "Invalid value for " << name << ": " << arg
+                      << ". Same as the main " << cache_name << std::endl;
+            throw std::invalid_argument("");
+        }
+        for (const auto& o : cfgs) {
+            if (!same(c, o)) continue;
+            std::cout << "Invalid value for " << name << ": " << arg
+                      << ". Same as " << o.name << std::endl;
+            throw std::invalid_argument("");
+        }
+        cfgs.push_back(c);
+    }
+    return cfgs;
+}
+
+// type[:param=values]... per grid, values as e.g. 1-8, 2/4/8 or 1-3/6
+// omitted params are taken from the bp_* options, given as defaults
+std::vector<bp_grid_cfg_t> resolve_bp_grid(
+    const std::vector<std::string>& args, const hw_cfg_t& defaults)
+{
+    const std::string name = "bp_grid";
+    auto invalid = [&name](const std::string& arg, const std::string& msg) {
+        std::cout << "Invalid value for " << name << ": " << arg << ". "
+                  << msg << std::endl;
+        throw std::invalid_argument("");
+    };
+    auto bits_list = [&](const std::string& arg, const std::string& vals) {
+        std::vector<uint8_t> out;
+        for (const auto& v : split_arg(vals, '/')) {
+            std::vector<std::string> r = split_arg(v, '-');
+            uint32_t lo = 0, hi = 0;
+            try {
+                lo = TO_U32(std::stoul(r.at(0), nullptr, 10));
+                hi = (r.size() == 2) ? TO_U32(std::stoul(r[1], nullptr, 10)) :
+                                       lo;
+            } catch (const std::exception&) {
+                invalid(arg, "Expected bits as e.g. 1-8, 2/4/8 or 1-3/6");
+            }
+            if ((r.size() > 2) || (lo > hi) || (hi > 30)) {
+                invalid(arg, "Expected bits from 0 to 30, as e.g. 1-8");
+            }
+            for (uint32_t b = lo; b <= hi; b++) out.push_back(TO_U8(b));
+        }
+        return out;
+    };
+
+    std::vector<bp_grid_cfg_t> cfgs;
+    for (const auto& arg : args) {
+        if (arg.empty()) continue;
+        std::vector<std::string> f = split_arg(arg, ':');
+        bp_grid_cfg_t c;
+        c.type = resolve_arg(name, f[0], bp_names_map);
+        if ((c.type == bp_t::ideal) || (c.type == bp_t::none)) {
+            invalid(arg, "Grid is not supported for " + f[0]);
+        }
+        // params not used by the type stay as a single placeholder
+        const bool is_static = (c.type == bp_t::sttc);
+        const bool has_pc = (!is_static && (c.type != bp_t::global));
+        const bool has_ghr = ((c.type == bp_t::global) ||
+                              (c.type == bp_t::gselect) ||
+                              (c.type == bp_t::gshare));
+        c.static_method = {is_static ? defaults.bp_static_method :
+                                       bp_sttc_t::at};
+        c.pc_bits = {TO_U8(has_pc ? defaults.bp_pc_bits : 0)};
+        c.cnt_bits = {TO_U8(is_static ? 0 : defaults.bp_cnt_bits)};
+        c.lhist_bits = {TO_U8((c.type == bp_t::local) ?
+                              defaults.bp_lhist_bits : 0)};
+        c.ghr_bits = {TO_U8(has_ghr ? defaults.bp_ghr_bits : 0)};
+        c.fold_pc = {has_pc ? defaults.bp_fold_pc : bp_pc_folds_t::none};
+        for (size_t i = 1; i < f.size(); i++) {
+            size_t eq = f[i].find('=');
+            if (eq == std::string::npos) {
+                invalid(arg, "Expected param=values, e.g. pc=4-8");
+            }
+            std::string key = f[i].substr(0, eq);
+            std::string vals = f[i].substr(eq + 1);
+            bool used = true;
+            if (key == "method") {
+                used = is_static;
+                c.static_method = resolve_arg_list(
+                    name, split_arg(vals, '/'), bp_sttc_map);
+            } else if (key == "pc") {
+                used = has_pc;
+                c.pc_bits = bits_list(arg, vals);
+            } else if (key == "cnt") {
+                used = !is_static;
+                c.cnt_bits = bits_list(arg, vals);
+            } else if (key == "lhist") {
+                used = (c.type == bp_t::local);
+                c.lhist_bits = bits_list(arg, vals);
+            } else if (key == "ghr") {
+                used = has_ghr;
+                c.ghr_bits = bits_list(arg, vals);
+            } else if (key == "fold") {
+                used = has_pc;
+                c.fold_pc = resolve_arg_list(
+                    name, split_arg(vals, '/'), bp_pc_folds_map);
+            } else {
+                invalid(arg, "Params: method, pc, cnt, lhist, ghr, fold");
+            }
+            if (!used) invalid(arg, "'" + key + "' not used by " + f[0]);
+        }
+        cfgs.push_back(c);
+    }
+    return cfgs;
+}
 #endif
 
+// simulate, or only run the HW models on a recorded trace
+uint64_t run_core(core& rv32, [[maybe_unused]] const hw_cfg_t& hw_cfg) {
+    #ifdef HW_MODELS_EN
+    if (!hw_cfg.hw_trace_replay.empty()) {
+        return rv32.replay(hw_cfg.hw_trace_replay);
+    }
+    #endif
+    return rv32.run();
+}
+
 void show_help(const cxxopts::Options& options) {
     std::cout << options.help() << std::endl;
 }
@@ -242,6 +432,23 @@ int main(int argc, char* argv[]) {
         ("run_steps",
          "Number of steps (inst & wfi period) to run. Set to 0 for no limit",
          CXXOPTS_VAL_STR->default_value(defs_t::run_steps))
+        ("mem_size",
+         "Main memory size in bytes, power of 2, with optional K/M/G suffix. "
+         "Allocated on first write, so large sizes are cheap until used",
+         CXXOPTS_VAL_STR->default_value(defs_t::mem_size))
+        ("ckpt_save",
+         "Save a checkpoint to the given file when the simulation stops "
+         "(e.g. on run_insts or exit_on_prof_stop)",
+         CXXOPTS_VAL_STR->default_value(""))
+        ("ckpt_restore",
+         "Continue from a checkpoint saved with the same ELF, mem_size and "
+         "build. run_insts and run_steps still count from the program start",
+         CXXOPTS_VAL_STR->default_value(""))
+        ("bbv_interval",
+         "Collect SimPoint basic block vectors over intervals of the given "
+         "number of instructions. Set to 0 to disable. " +
+         saved_as("bbv.bb/bbv_blocks.json"),
+         CXXOPTS_VAL_STR->default_value(defs_t::bbv_interval))
         #ifdef UART_EN
         ("uart_show",
          "Print UART output to stdout. UART still fully operational. "
@@ -265,6 +472,10 @@ int main(int argc, char* argv[]) {
         ("prof_pc_single_match",
          "Run profiling only for match number (0 for all matches)",
          CXXOPTS_VAL_STR->default_value(defs_t::prof_pc_sm))
+        ("prof_inst_start",
+         "Start profiling once the given number of instructions has executed "
+         "(e.g. after a checkpoint restore). Set to 0 to disable",
+         CXXOPTS_VAL_STR->default_value(defs_t::prof_inst_start))
         ("exit_on_prof_stop",
          "Exit simulation immediately after profiling finishes. "
          "Exits on the first 'prof_pc_stop' if 'prof_pc_single_match' is not "
@@ -284,32 +495,71 @@ int main(int argc, char* argv[]) {
          CXXOPTS_VAL_BOOL->default_value(defs_t::rf_usage))
         ("no_callstack", "Disable callstack tracing",
          CXXOPTS_VAL_BOOL->default_value(defs_t::no_callstack))
+        ("perf_sample",
+         "Sample every Nth occurrence of each 'perf_event' with its PC, data "
+         "address and callstack, instead of counting all of them. Set to 0 "
+         "to disable. Saved as 'callstack_sampled_<event>.txt', "
+         "'pc_hist_<event>.csv' and 'dmem_hist_<event>.csv' under run "
+         "directory",
+         CXXOPTS_VAL_STR->default_value(defs_t::perf_sample))
         ("prof_show",
          "Show profiler stats to stdout at the end of sim. "
          "Logs and traces always saved",
-         CXXOPTS_VAL_BOOL->default_value(defs_t::prof_show));
+         CXXOPTS_VAL_BOOL->default_value(defs_t::prof_show))
+        #ifdef HW_MODELS_EN
+        ("smarts_period",
+         "Sample the run, SMARTS style: profile the last 'smarts_unit' "
+         "instructions of every period, only warm up the HW models for the "
+         "rest. Reports confidence intervals for miss rates, MPKI and perf "
+         "event rates. Set to 0 to disable. " + saved_as("smarts.json"),
+         CXXOPTS_VAL_STR->default_value(defs_t::smarts_period))
+        ("smarts_unit", "Instructions profiled at the end of 'smarts_period'",
+         CXXOPTS_VAL_STR->default_value(defs_t::smarts_unit))
+        #endif
+        #ifdef DECODE_CACHE_EN
+        ("fast_forward",
+         "Run on the predecoded path, without HW models and profilers, until "
+         "'prof_pc_start' is reached. Without it, for the whole run, e.g. for "
+         "'ckpt_save' or 'bbv_interval'",
+         CXXOPTS_VAL_BOOL->default_value(defs_t::fast_forward))
+        ("ff_warmup",
+         "Instructions after the end of 'fast_forward' that only warm up the "
+         "HW models, profiling starts after them",
+         CXXOPTS_VAL_STR->default_value(defs_t::ff_warmup))
+        #endif
+        ;
     #endif
 
-    #ifdef DASM_EN
+    #ifdef EXEC_LOG_EN
     options.add_options("Logging")
+        #ifdef DASM_EN
         ("l,log",
          "Enable logging of each executed instrucion. " + saved_as("exec.log"),
          CXXOPTS_VAL_BOOL->default_value(defs_t::log))
+        #endif
+        #ifdef EXEC_LOG_BIN_EN
+        ("log_bin",
+         "Enable binary logging of each executed instruction, rendered as "
+         "text by script/exec_log.py. " + saved_as("exec.bin"),
+         CXXOPTS_VAL_BOOL->default_value(defs_t::log_bin))
+        #endif
         #ifdef PROFILERS_EN
         ("log_always",
          "Always log execution. Otherwise, log during profiling only",
          CXXOPTS_VAL_BOOL->default_value(defs_t::log_always))
         #endif
-        ("log_state", "Log state after each executed instruction",
-         CXXOPTS_VAL_BOOL->default_value(defs_t::log_state))
         ("rf_names",
          "Register file names used for output. Options: " +
          gen_help_list(rf_names_map),
          CXXOPTS_VAL_STR->default_value(defs_t::rf_names))
+        #ifdef DASM_EN
+        ("log_state", "Log state after each executed instruction",
+         CXXOPTS_VAL_BOOL->default_value(defs_t::log_state))
         #ifdef HW_MODELS_EN
         ("log_hw_models", "Log HW model stats for each executed instruction",
          CXXOPTS_VAL_BOOL->default_value(defs_t::log_hw_models))
         #endif
+        #endif
         ;
     #endif
 
@@ -323,6 +573,10 @@ int main(int argc, char* argv[]) {
         ("icache_re_policy", "I$ replacement policy. \nOptions: " +
          gen_help_list(cache_re_policy_map),
          CXXOPTS_VAL_STR->default_value(hw_defs_t::icache_re_policy))
+        ("icache_rrpv_bits",
+         "Width of re-reference prediction values in I$ and its sweep "
+         "configs, for srrip and brrip re_policy",
+         CXXOPTS_VAL_STR->default_value(hw_defs_t::icache_rrpv_bits))
         ("icache_in_policy", "I$ insertion policy. \nOptions: " +
          gen_help_list(cache_in_policy_map),
          CXXOPTS_VAL_STR->default_value(hw_defs_t::icache_in_policy))
@@ -334,6 +588,10 @@ int main(int argc, char* argv[]) {
         ("dcache_re_policy", "D$ replacement policy. \nOptions: " +
          gen_help_list(cache_re_policy_map),
          CXXOPTS_VAL_STR->default_value(hw_defs_t::dcache_re_policy))
+        ("dcache_rrpv_bits",
+         "Width of re-reference prediction values in D$ and its sweep "
+         "configs, for srrip and brrip re_policy",
+         CXXOPTS_VAL_STR->default_value(hw_defs_t::dcache_rrpv_bits))
         ("dcache_in_policy", "D$ insertion policy. \nOptions: " +
          gen_help_list(cache_in_policy_map),
          CXXOPTS_VAL_STR->default_value(hw_defs_t::dcache_in_policy))
@@ -341,13 +599,33 @@ int main(int argc, char* argv[]) {
          gen_help_list(cache_wr_policy_map),
          CXXOPTS_VAL_STR->default_value(hw_defs_t::dcache_wr_policy))
         // caches other configs
+        ("cache_seed", "Seed for random re_policy, same for all caches",
+         CXXOPTS_VAL_STR->default_value(hw_defs_t::cache_seed))
         ("roi_start", "Region of interest start address (hex)",
          CXXOPTS_VAL_STR->default_value(hw_defs_t::roi_start))
         ("roi_size", "Region of interest size",
          CXXOPTS_VAL_STR->default_value(hw_defs_t::roi_size))
         ("show_cache_state",
          "Show per cache line references at the end of simulation",
-         CXXOPTS_VAL_BOOL->default_value(hw_defs_t::show_cache_state));
+         CXXOPTS_VAL_BOOL->default_value(hw_defs_t::show_cache_state))
+        ("icache_sweep",
+         "Additional I$ configs simulated in the same run, stats only, "
+         "comma-separated. Each as sets:ways[:re_policy[:in_policy]], "
+         "omitted policies as in the I$. Logged in 'hw_stats.json' as e.g. "
+         "'icache_64x2_lru_update'",
+         cxxopts::value<std::vector<std::string>>()
+            ->default_value(hw_defs_t::icache_sweep))
+        ("dcache_sweep",
+         "Additional D$ configs simulated in the same run, stats only, "
+         "comma-separated. Each as sets:ways[:re_policy[:in_policy"
+         "[:wr_policy]]], omitted policies as in the D$",
+         cxxopts::value<std::vector<std::string>>()
+            ->default_value(hw_defs_t::dcache_sweep))
+        ("stack_dist",
+         "Profile LRU stack distances of I$ and D$ references. Gives misses "
+         "for all sets and ways, with lru replacement and update insertion, "
+         "in one run. " + saved_as("stack_dist.json"),
+         CXXOPTS_VAL_BOOL->default_value(hw_defs_t::stack_dist));
 
     options.add_options("HW model - Branch Predictor")
         ("bp",
@@ -413,13 +691,33 @@ int main(int argc, char* argv[]) {
         ("bp_run_all", "Run all branch predictors",
          CXXOPTS_VAL_BOOL->default_value(hw_defs_t::bp_run_all))
         ("bp_dump_csv", "Dump branch predictor stats to CSV",
-         CXXOPTS_VAL_BOOL->default_value(hw_defs_t::bp_dump_csv));
+         CXXOPTS_VAL_BOOL->default_value(hw_defs_t::bp_dump_csv))
+        ("bp_grid",
+         "Grids of predictors simulated in the same run, stats only, "
+         "comma-separated. Each as type[:param=values]..., with params "
+         "method, pc, cnt, lhist, ghr, fold and values as e.g. 1-8, 2/4/8 "
+         "or at/btfn, all combinations are simulated. Omitted params as in "
+         "the bp_* options. Logged in 'hw_stats.json' as e.g. "
+         "'bp_gshare_pc8_ghr8_cnt3_fold_none'",
+         cxxopts::value<std::vector<std::string>>()
+            ->default_value(hw_defs_t::bp_grid));
 
     options.add_options("HW model - Divider")
         ("div_cache_entries",
          "Number of entries in divider result cache",
          CXXOPTS_VAL_STR->default_value(hw_defs_t::div_cache_entries));
 
+    options.add_options("HW model - Trace")
+        ("hw_trace_save",
+         "Record cache references, branches and divisions to the given file, "
+         "for 'hw_trace_replay'",
+         CXXOPTS_VAL_STR->default_value(""))
+        ("hw_trace_replay",
+         "Run only the HW models, on a trace recorded with the same ELF and "
+         "mem_size, instead of simulating. HW model options can differ from "
+         "the recording run",
+         CXXOPTS_VAL_STR->default_value(""));
+
     #endif
 
     options.add_options("Help")
@@ -461,6 +759,21 @@ int main(int argc, char* argv[]) {
         cfg.mem_dump_size = ARG_U32(result["mem_dump_size"]);
         cfg.run_insts = ARG_U64(result["run_insts"]);
         cfg.run_steps = ARG_U64(result["run_steps"]);
+        uint64_t mem_size = resolve_size_arg(
+            "mem_size", result["mem_size"].as<std::string>());
+        if ((mem_size < mem_map::page_size) ||
+            (mem_size > mem_map::mem_size_max) ||
+            !is_pow2(TO_U32(mem_size))) {
+            std::cout << "Invalid value for mem_size: " << mem_size
+                      << ". Must be a power of 2, between "
+                      << mem_map::page_size << " and " << mem_map::mem_size_max
+                      << std::endl;
+            throw std::invalid_argument("");
+        }
+        cfg.mem_size = TO_U32(mem_size);
+        cfg.ckpt_save = result["ckpt_save"].as<std::string>();
+        cfg.ckpt_restore = result["ckpt_restore"].as<std::string>();
+        cfg.bbv_interval = ARG_U64(result["bbv_interval"]);
         out_dir_tag = result["out_dir_tag"].as<std::string>();
         #ifdef UART_EN
         cfg.uart_show = ARG_BOOL(result["uart_show"]);
@@ -473,23 +786,76 @@ int main(int argc, char* argv[]) {
         cfg.prof_pc.start = ARG_U32H(result["prof_pc_start"]);
         cfg.prof_pc.stop = ARG_U32H(result["prof_pc_stop"]);
         cfg.prof_pc.single_match_num = ARG_U32(result["prof_pc_single_match"]);
+        cfg.prof_inst_start = ARG_U64(result["prof_inst_start"]);
         cfg.prof_pc.exit_on_prof_stop = ARG_BOOL(result["exit_on_prof_stop"]);
         cfg.prof_trace = ARG_BOOL(result["prof_trace"]);
         cfg.perf_events = RESOLVE_ARG_LIST("perf_event", perf_event_map);
         cfg.rf_usage = ARG_BOOL(result["rf_usage"]);
         cfg.no_callstack = ARG_BOOL(result["no_callstack"]);
+        cfg.perf_sample = ARG_U64(result["perf_sample"]);
+        if (cfg.perf_sample && cfg.no_callstack) {
+            std::cout << "Option 'perf_sample' can't be used with "
+                      << "'no_callstack'" << std::endl;
+            throw std::invalid_argument("");
+        }
         cfg.prof_show = ARG_BOOL(result["prof_show"]);
+        #ifdef HW_MODELS_EN
+        cfg.smarts_period = ARG_U64(result["smarts_period"]);
+        cfg.smarts_unit = ARG_U64(result["smarts_unit"]);
+        if (cfg.smarts_period &&
+            ((cfg.smarts_unit == 0) ||
+             (cfg.smarts_unit >= cfg.smarts_period))) {
+            std::cout << "Option 'smarts_unit' has to be non-zero and less "
+                      << "than 'smarts_period'" << std::endl;
+            throw std::invalid_argument("");
+        }
+        if (cfg.smarts_period &&
+            (cfg.prof_pc.start || cfg.prof_pc.stop || cfg.prof_inst_start)) {
+            std::cout << "Option 'smarts_period' can't be used with "
+                      << "'prof_pc_start', 'prof_pc_stop' or 'prof_inst_start'"
+                      << std::endl;
+            throw std::invalid_argument("");
+        }
+        #endif
+        #ifdef DECODE_CACHE_EN
+        cfg.fast_forward = ARG_BOOL(result["fast_forward"]);
+        cfg.ff_warmup = ARG_U64(result["ff_warmup"]);
+        if (cfg.fast_forward && cfg.prof_inst_start) {
+            std::cout << "Option 'prof_inst_start' can't be used with "
+                      << "'fast_forward'" << std::endl;
+            throw std::invalid_argument("");
+        }
+        if (cfg.fast_forward && cfg.smarts_period) {
+            std::cout << "Option 'smarts_period' can't be used with "
+                      << "'fast_forward'" << std::endl;
+            throw std::invalid_argument("");
+        }
+        #endif
         #endif
 
+        #ifdef EXEC_LOG_EN
         #ifdef DASM_EN
         cfg.log = ARG_BOOL(result["log"]);
+        #endif
+        #ifdef EXEC_LOG_BIN_EN
+        cfg.log_bin = ARG_BOOL(result["log_bin"]);
+        #endif
         #ifdef PROFILERS_EN
         cfg.log_always = ARG_BOOL(result["log_always"]);
+        #ifdef DECODE_CACHE_EN
+        if (cfg.fast_forward && cfg.log_always) {
+            std::cout << "Option 'log_always' can't be used with 'fast_forward'"
+                      << std::endl;
+            throw std::invalid_argument("");
+        }
+        #endif
         #else
         cfg.log_always = true;
         #endif
-        cfg.log_state = ARG_BOOL(result["log_state"]);
         cfg.rf_names = RESOLVE_ARG("rf_names", rf_names_map);
+        #endif
+        #ifdef DASM_EN
+        cfg.log_state = ARG_BOOL(result["log_state"]);
         #ifdef HW_MODELS_EN
         cfg.log_hw_models = ARG_BOOL(result["log_hw_models"]);
         #endif
@@ -501,6 +867,7 @@ int main(int argc, char* argv[]) {
         hw_cfg.icache_ways = ARG_U32(result["icache_ways"]);
         hw_cfg.icache_re_policy =
             RESOLVE_ARG("icache_re_policy", cache_re_policy_map);
+        hw_cfg.icache_rrpv_bits = ARG_U32(result["icache_rrpv_bits"]);
         hw_cfg.icache_in_policy =
             RESOLVE_ARG("icache_in_policy", cache_in_policy_map);
         // dcache
@@ -508,14 +875,32 @@ int main(int argc, char* argv[]) {
         hw_cfg.dcache_ways = ARG_U32(result["dcache_ways"]);
         hw_cfg.dcache_re_policy =
             RESOLVE_ARG("dcache_re_policy", cache_re_policy_map);
+        hw_cfg.dcache_rrpv_bits = ARG_U32(result["dcache_rrpv_bits"]);
         hw_cfg.dcache_in_policy =
             RESOLVE_ARG("dcache_in_policy", cache_in_policy_map);
         hw_cfg.dcache_wr_policy =
             RESOLVE_ARG("dcache_wr_policy", cache_wr_policy_map);
         // caches other configs
+        hw_cfg.cache_seed = ARG_U32(result["cache_seed"]);
         hw_cfg.roi_start = ARG_U32H(result["roi_start"]);
         hw_cfg.roi_size = ARG_U32(result["roi_size"]);
         hw_cfg.show_cache_state = ARG_BOOL(result["show_cache_state"]);
+        hw_cfg.icache_sweep = resolve_cache_sweep(
+            "icache",
+            result["icache_sweep"].as<std::vector<std::string>>(),
+            {result["icache_re_policy"].as<std::string>(),
+             result["icache_in_policy"].as<std::string>()},
+            {hw_cfg.icache_sets, hw_cfg.icache_ways, hw_cfg.icache_re_policy,
+             hw_cfg.icache_in_policy, cache_wr_policy_t::none, "icache"});
+        hw_cfg.dcache_sweep = resolve_cache_sweep(
+            "dcache",
+            result["dcache_sweep"].as<std::vector<std::string>>(),
+            {result["dcache_re_policy"].as<std::string>(),
+             result["dcache_in_policy"].as<std::string>(),
+             result["dcache_wr_policy"].as<std::string>()},
+            {hw_cfg.dcache_sets, hw_cfg.dcache_ways, hw_cfg.dcache_re_policy,
+             hw_cfg.dcache_in_policy, hw_cfg.dcache_wr_policy, "dcache"});
+        hw_cfg.cache_stack_dist = ARG_BOOL(result["stack_dist"]);
         hw_cfg.div_cache_entries = ARG_U32(result["div_cache_entries"]);
 
         // branch predictors
@@ -551,6 +936,24 @@ int main(int argc, char* argv[]) {
         // bp other configs
         hw_cfg.bp_run_all = ARG_BOOL(result["bp_run_all"]);
         hw_cfg.bp_dump_csv = ARG_BOOL(result["bp_dump_csv"]);
+        hw_cfg.bp_grid = resolve_bp_grid(
+            result["bp_grid"].as<std::vector<std::string>>(), hw_cfg);
+
+        // trace
+        hw_cfg.hw_trace_save = result["hw_trace_save"].as<std::string>();
+        hw_cfg.hw_trace_replay = result["hw_trace_replay"].as<std::string>();
+        if (!hw_cfg.hw_trace_save.empty() && !hw_cfg.hw_trace_replay.empty()) {
+            std::cout << "hw_trace_save and hw_trace_replay can't be used "
+                      << "together" << std::endl;
+            throw std::invalid_argument("");
+        }
+        #if CACHE_MODE == CACHE_MODE_FUNC and defined(CACHE_VERIFY)
+        if (!hw_cfg.hw_trace_replay.empty()) {
+            std::cout << "hw_trace_replay is not supported with CACHE_VERIFY, "
+                      << "trace has no data" << std::endl;
+            throw std::invalid_argument("");
+        }
+        #endif
         #endif
 
     } catch (const cxxopts::exceptions::option_has_no_value& e) {
@@ -577,11 +980,28 @@ int main(int argc, char* argv[]) {
         std::cout << "Profiling only match number: "
                   << cfg.prof_pc.single_match_num << "\n";
     }
+    #ifdef DECODE_CACHE_EN
+    if (cfg.fast_forward) {
+        std::cout << "Fast-forward to profiling start";
+        if (cfg.ff_warmup) {
+            std::cout << ", warmup: " << cfg.ff_warmup << " instructions";
+        }
+        std::cout << "\n";
+    }
+    #endif
+    #ifdef HW_MODELS_EN
+    if (cfg.smarts_period) {
+        std::cout << "SMARTS sampling: " << cfg.smarts_unit
+                  << " instructions every " << cfg.smarts_period << "\n";
+    }
+    #endif
     #endif
 
-    #ifdef DASM_EN
-    if (cfg.log) {
-        std::cout << "Logging enabled";
+    #ifdef EXEC_LOG_EN
+    if (cfg.log || cfg.log_bin) {
+        if (cfg.log) std::cout << "Logging enabled";
+        if (cfg.log && cfg.log_bin) std::cout << ", ";
+        if (cfg.log_bin) std::cout << "Binary logging enabled";
         #ifdef PROFILERS_EN
         if (cfg.log_always) std::cout << ", Logging always";
         #endif
@@ -597,7 +1017,7 @@ int main(int argc, char* argv[]) {
         memory mem(test_elf, cfg, hw_cfg);
         core rv32(&mem, cfg, hw_cfg);
         auto t_start = std::chrono::steady_clock::now();
-        sim_inst_cnt = rv32.run();
+        sim_inst_cnt = run_core(rv32, hw_cfg);
         auto t_end = std::chrono::steady_clock::now();
         sim_elapsed_s = std::chrono::duration<double>(t_end - t_start).count();
     });
@@ -2,17 +2,17 @@
 
 memory::memory(
     std::string test_elf,
-    [[maybe_unused]] cfg_t cfg,
+    cfg_t cfg,
     [[maybe_unused]] hw_cfg_t hw_cfg) :
         // create devices
-        mm(mem_map::mem_size, test_elf, hw_cfg),
+        mm(cfg.mem_size, test_elf, hw_cfg),
         #ifdef UART_EN
         uart0(cfg),
         #endif
         clint0(),
         // put devices in memory map
         mem_map {{
-            {mem_map::base_addr, mem_map::mem_size, &mm},
+            {mem_map::base_addr, cfg.mem_size, &mm},
             #ifdef UART_EN
             {mem_map::uart0_addr, mem_map::uart_size, &uart0},
             #endif
@@ -87,16 +87,60 @@ uint32_t memory::just_inst(uint32_t address) {
     return TO_U32(mm_ptr->just_inst(to_norm(address)));
 }
 
-uint32_t memory::rd(uint32_t address, uint32_t size) {
-    address = set_addr(address, mem_op_t::read, size);
+uint32_t memory::rd_dev(uint32_t address, uint32_t size) {
+    uint32_t dev_addr = set_addr(address, mem_op_t::read, size);
     if (tu->is_trapped()) return 0;
-    return dev_ptr->rd(address, size);
+    uint32_t data = dev_ptr->rd(dev_addr, size);
+    #ifdef SOFT_TLB_EN
+    if (dev_ptr == &mm) tlb_fill(rd_tlb, address, false);
+    #endif
+    return data;
 }
 
-void memory::wr(uint32_t address, uint32_t data, uint32_t size) {
-    address = set_addr(address, mem_op_t::write, size);
+void memory::wr_dev(uint32_t address, uint32_t data, uint32_t size) {
+    uint32_t dev_addr = set_addr(address, mem_op_t::write, size);
     if (tu->is_trapped()) return;
-    dev_ptr->wr(address, data, size);
+    #ifdef DECODE_CACHE_EN
+    if (dev_ptr != &mm) mmio_wr_cnt++;
+    #endif
+    dev_ptr->wr(dev_addr, data, size);
+    #ifdef SOFT_TLB_EN
+    if (dev_ptr == &mm) tlb_fill(wr_tlb, address, true);
+    #endif
+}
+
+#ifdef SOFT_TLB_EN
+// only called after a successful main memory access to the page
+void memory::tlb_fill(soft_tlb_t& tlb, uint32_t address, bool is_w) {
+    uint32_t page = (address >> mem_map::page_bits);
+    uint32_t off = ((address - mem_map::base_addr) & ~mem_map::page_mask);
+    uint8_t* host = mm.page_ptr(off, is_w);
+    if (host == nullptr) return; // not uniformly accessible, stays on dev path
+    tlb_entry_t& e = tlb[page & (soft_tlb_cfg::entries - 1)];
+    e.tag = page;
+    e.host = host;
+}
+#endif
+
+void memory::save(ckpt_out& out) {
+    for (auto &entry : mem_map) {
+        out.begin(dev_tag(entry));
+        entry.ptr->save(out);
+        out.end();
+    }
+}
+
+void memory::restore(ckpt_in& in) {
+    for (auto &entry : mem_map) {
+        in.enter(dev_tag(entry));
+        entry.ptr->restore(in);
+        in.leave();
+    }
+    #ifdef SOFT_TLB_EN
+    // main memory pages were reallocated
+    rd_tlb.fill(tlb_entry_t());
+    wr_tlb.fill(tlb_entry_t());
+    #endif
 }
 
 // xxd style byte dump
@@ -18,6 +18,24 @@ struct mem_entry {
     dev* ptr;
 };
 
+#ifdef SOFT_TLB_EN
+// host loads and stores are used as is
+static_assert (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__);
+
+// same pages as main memory
+namespace soft_tlb_cfg {
+    constexpr uint32_t entries = 64; // direct-mapped, indexed by page number
+    static_assert (is_pow2(entries));
+}
+
+struct tlb_entry_t {
+    uint32_t tag = UINT32_MAX; // guest page number, never matches if unset
+    uint8_t* host = nullptr; // same page in main memory
+};
+
+using soft_tlb_t = std::array<tlb_entry_t, soft_tlb_cfg::entries>;
+#endif
+
 class memory {
     private:
         main_memory mm;
@@ -28,16 +46,49 @@ class memory {
         dev *dev_ptr;
         std::array<mem_entry, MEM_MAP_SIZE> mem_map;
         trap *tu;
+        #ifdef DECODE_CACHE_EN
+        uint64_t mmio_wr_cnt = 0; // writes to anything but main memory
+        #endif
+        #ifdef SOFT_TLB_EN
+        // main memory pages that passed permission checks, per access type
+        soft_tlb_t rd_tlb;
+        soft_tlb_t wr_tlb;
+        #endif
 
     private:
+        static std::string dev_tag(const mem_entry& entry) {
+            std::ostringstream tag;
+            tag << "dev@" << std::hex << entry.base;
+            return tag.str();
+        }
         uint32_t set_addr(uint32_t address, mem_op_t access, uint32_t size);
+        uint32_t rd_dev(uint32_t address, uint32_t size);
+        void wr_dev(uint32_t address, uint32_t data, uint32_t size);
+        #ifdef SOFT_TLB_EN
+        // host pointer on hit, misaligned accesses always miss and trap later
+        static uint8_t* tlb_lookup(
+            const soft_tlb_t& tlb, uint32_t address, uint32_t size) {
+            const tlb_entry_t& e = tlb[
+                (address >> mem_map::page_bits) & (soft_tlb_cfg::entries - 1)];
+            bool hit = (
+                (e.tag == (address >> mem_map::page_bits)) &&
+                !(address & (size - 1))
+            );
+            if (!hit) return nullptr;
+            return (e.host + (address & mem_map::page_mask));
+        }
+        void tlb_fill(soft_tlb_t& tlb, uint32_t address, bool is_w);
+        #endif
 
     public:
         memory() = delete;
         memory(std::string test_elf, cfg_t cfg, hw_cfg_t hw_cfg);
-        std::map<uint32_t, symbol_map_entry_t> get_symbol_map() {
+        const std::map<uint32_t, symbol_map_entry_t>& get_symbol_map() const {
             return mm.get_symbol_map();
         }
+        const std::vector<symbol_pc_lut_t>& get_symbol_pc_lut() const {
+            return mm.get_symbol_pc_lut();
+        }
         void trap_setup(trap* tu) {
             this->tu = tu;
             clint0.trap_setup(tu);
@@ -52,17 +103,45 @@ class memory {
             #endif
         }
         void update_mtime() { clint0.update_mtime(); }
+        void update_mtime(uint64_t elapsed) { clint0.update_mtime(elapsed); }
+        uint64_t steps_to_mtip() { return clint0.steps_to_mtip(); }
+        #ifdef DECODE_CACHE_EN
+        uint64_t steps_to_mtime_inc() { return clint0.steps_to_mtime_inc(); }
+        uint64_t get_mmio_wr_cnt() { return mmio_wr_cnt; }
+        #endif
         #ifndef DPI
         #ifdef UART_INPUT_EN
         void update_uart_input(uint64_t instr_cnt) {
             uart0.update_input(instr_cnt);
         }
+        uint64_t get_next_rx_time() { return uart0.get_next_rx_time(); }
         #endif
         #endif
         uint32_t rd_inst(uint32_t address);
         uint32_t just_inst(uint32_t address);
-        uint32_t rd(uint32_t address, uint32_t size);
-        void wr(uint32_t address, uint32_t data, uint32_t size);
+        uint32_t rd(uint32_t address, uint32_t size) {
+            #ifdef SOFT_TLB_EN
+            uint8_t* host = tlb_lookup(rd_tlb, address, size);
+            if (host != nullptr) {
+                uint32_t data = 0;
+                std::memcpy(&data, host, size);
+                return data;
+            }
+            #endif
+            return rd_dev(address, size);
+        }
+        void wr(uint32_t address, uint32_t data, uint32_t size) {
+            #ifdef SOFT_TLB_EN
+            uint8_t* host = tlb_lookup(wr_tlb, address, size);
+            if (host != nullptr) {
+                std::memcpy(host, &data, size);
+                return;
+            }
+            #endif
+            wr_dev(address, data, size);
+        }
+        void save(ckpt_out& out);
+        void restore(ckpt_in& in);
         void dump_as_bytes(uint32_t start, uint32_t size);
         void dump_as_words(uint32_t start, uint32_t size, std::string out_dir);
         scp_status_t cache_hint(uint32_t address, scp_mode_t scp_mode);
@@ -71,9 +150,14 @@ class memory {
         void log_cache_stats(std::ofstream& hw_ofs, uint64_t profiled_insts) {
             mm.log_cache_stats(hw_ofs, profiled_insts);
         }
+        void log_stack_dist(std::string out_dir) {
+            mm.log_stack_dist(out_dir);
+        }
         void set_cache_hws(hw_status_t* ic, hw_status_t* dc) {
             mm.set_cache_hws(ic, dc);
         }
+        void save_caches(ckpt_out& out) { mm.save_caches(out); }
+        void restore_caches(ckpt_in& in) { mm.restore_caches(in); }
         void cache_finish(bool show, uint64_t profiled_insts) {
             if (!show) return;
             mm.finish(profiled_insts);
@@ -81,9 +165,23 @@ class memory {
         void cache_profiling(bool enable) {
             mm.cache_profiling(enable);
         }
+        void set_cache_bypass(bool bypass) { mm.set_cache_bypass(bypass); }
+        void set_hw_trace(hw_trace_out* t) { mm.set_hw_trace(t); }
+        void replay_inst(norm_address_t addr) { mm.replay_inst(addr); }
+        void replay_rd(norm_address_t addr, uint32_t size) {
+            mm.replay_rd(addr, size);
+        }
+        void replay_wr(norm_address_t addr, uint32_t size) {
+            mm.replay_wr(addr, size);
+        }
+        void replay_scp(norm_address_t addr, scp_mode_t scp_mode) {
+            mm.scp(addr, scp_mode);
+        }
         void speculative_exec(speculative_t smode) {
             mm.speculative_exec(smode);
         }
+        cache_cnt_t icache_cnt() const { return mm.icache_cnt(); }
+        cache_cnt_t dcache_cnt() const { return mm.dcache_cnt(); }
         #ifdef PROFILERS_EN
         void set_perf_profiler(profiler_perf* prof_perf) {
             mm.set_perf_profiler(prof_perf);
@@ -1,9 +1,11 @@
 #include "profiler.h"
 
-profiler::profiler(std::string out_dir, profiler_source_t prof_src) {
+profiler::profiler(
+    std::string out_dir, profiler_source_t prof_src, uint32_t mem_size) {
     inst = 0;
+    stack_top = (mem_map::base_addr + mem_size);
+    min_sp = stack_top;
     inst_cnt_prof = 0;
-    trace.reserve(1<<14); // reserve 16K entries to start with
     te.rst();
     this->out_dir = out_dir;
     this->prof_src = prof_src;
@@ -236,9 +238,60 @@ profiler::profiler(std::string out_dir, profiler_source_t prof_src) {
     #undef P_INIT_D
 }
 
+void profiler::set_trace_en(bool trace_en) {
+    this->trace_en = trace_en;
+    if (trace_en && !trace.is_en()) {
+        trace.open(out_dir + "trace" + prof_src_tag(prof_src) + ".bin",
+                   trace_stream_t::trace, TO_U32(te_col_t::_count));
+    }
+}
+
+void profiler::encode_te() {
+    if (trace.chunk_start()) {
+        te_last.sample_cnt = 0;
+        te_last.next_pc = 0;
+        te_last.dmem = 0;
+        te_last.sp = 0;
+    }
+    #define TE_COL(c) TO_U32(te_col_t::c)
+    trace.begin(te.sample_cnt);
+    trace.varint(TE_COL(sample_cnt), te.sample_cnt - te_last.sample_cnt);
+    trace.u32(TE_COL(inst), te.inst);
+    trace.zigzag(TE_COL(pc), te.pc - te_last.next_pc);
+    trace.zigzag(TE_COL(next_pc), te.next_pc - te.pc);
+    if (te.dmem == 0) {
+        trace.varint(TE_COL(dmem), 0);
+    } else {
+        // no access is 0, deltas are between accesses
+        trace.varint(
+            TE_COL(dmem), TO_U64(trace.zz(te.dmem - te_last.dmem)) + 1);
+        te_last.dmem = te.dmem;
+    }
+    trace.zigzag(TE_COL(sp), te.sp - te_last.sp);
+    trace.u8(TE_COL(taken), te.taken);
+    trace.u8(TE_COL(inst_size), te.inst_size);
+    trace.u8(TE_COL(dmem_size), te.dmem_size);
+    trace.u8(TE_COL(ic_hm), te.ic_hm);
+    trace.u8(TE_COL(dc_hm), te.dc_hm);
+    trace.u8(TE_COL(bp_hm), te.bp_hm);
+    #ifdef DPI
+    trace.u8(TE_COL(ct_imem_core), te.ct_imem_core);
+    trace.u8(TE_COL(ct_imem_mem), te.ct_imem_mem);
+    trace.u8(TE_COL(ct_dmem_core_r), te.ct_dmem_core_r);
+    trace.u8(TE_COL(ct_dmem_core_w), te.ct_dmem_core_w);
+    trace.u8(TE_COL(ct_dmem_mem_r), te.ct_dmem_mem_r);
+    trace.u8(TE_COL(ct_dmem_mem_w), te.ct_dmem_mem_w);
+    #endif
+    #undef TE_COL
+    trace.end();
+    te_last.sample_cnt = te.sample_cnt;
+    te_last.next_pc = te.next_pc;
+    te_last.sp = te.sp;
+}
+
 void profiler::add_te() {
     if (active && trace_en) {
-        trace.push_back(te);
+        encode_te();
         #ifndef DPI
         // in case next instruction doesn't update all fields
         // DPI te is copied from cosim, no point in resetting
@@ -287,6 +340,7 @@ void profiler::track_sp(const uint32_t sp) {
     // rf[32] all initialized with 0xc0ffee by the isa sim
     // rf[32] all initialized to 0x0 by the crt0.S
     // sp is then initialized to stack top `base_addr + mem_size` by the crt0.S
+    // (with mem_size from the linker script, matching --mem_size)
     // if the rest of the application respects the abi
     // sp will grow downwards and therefore this will collect peak stack usage
     if ((sp > mem_map::base_addr) && (sp < min_sp)) min_sp = sp;
@@ -325,7 +379,7 @@ void profiler::log_to_file_and_print(bool show) {
         }
     }
 
-    min_sp = (mem_map::base_addr + mem_map::mem_size - min_sp); // remove stack_top offset
+    min_sp = (stack_top - min_sp); // remove stack_top offset
     ofs << INDENT << "\"_max_sp_usage\": " << min_sp << ",\n" << INDENT;
     if (prof_src == profiler_source_t::clock) {
         ofs << "\"_profiled_cycles\": " << cnt.tot;
@@ -335,12 +389,7 @@ void profiler::log_to_file_and_print(bool show) {
     ofs << "\n}\n";
     ofs.close();
 
-    if (trace_en) {
-        ofs.open(out_dir + "trace" + pt + ".bin", std::ios::binary);
-        ofs.write(reinterpret_cast<const char*>(trace.data()),
-                trace.size() * sizeof(trace_entry));
-        ofs.close();
-    }
+    if (trace_en) trace.finish();
 
     #ifdef RV32C_EN
     // compressed inst cnt
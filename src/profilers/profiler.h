@@ -3,6 +3,7 @@
 #include "defines.h"
 #include "utils.h"
 #include "hw_model_types.h"
+#include "trace_stream.h"
 
 #include <cassert>
 
@@ -194,6 +195,22 @@ struct trace_entry {
         }
 };
 
+// trace.bin columns, see profiler::encode_te
+enum class te_col_t : uint32_t {
+    sample_cnt, // varint delta from the previous entry
+    inst, // raw
+    pc, // zigzag delta from the previous next_pc
+    next_pc, // zigzag delta from pc
+    dmem, // 0 if 0, else zigzag delta from the previous non-zero dmem + 1
+    sp, // zigzag delta from the previous sp
+    taken, inst_size, dmem_size, ic_hm, dc_hm, bp_hm, // raw
+    #ifdef DPI
+    ct_imem_core, ct_imem_mem, ct_dmem_core_r, ct_dmem_core_w,
+    ct_dmem_mem_r, ct_dmem_mem_w, // raw
+    #endif
+    _count
+};
+
 struct cnt_t {
     public:
         uint64_t tot = 0;
@@ -305,22 +322,20 @@ class profiler {
         uint64_t inst_cnt_prof;
         stack_access_t stack_access;
         uint32_t inst;
-        #ifdef PROF_MEM_USAGE
-        logging_resource logres;
-        std::pmr::vector<trace_entry> trace{ &logres };
-        #else
-        std::vector<trace_entry> trace;
-        #endif
+        trace_stream_out trace;
+        trace_entry te_last; // delta base, only the encoded fields
         std::array<inst_prof_g, TO_U32(opc_g::_count)> prof_g_arr;
         std::array<inst_prof_b, TO_U32(opc_b::_count)> prof_b_arr;
         std::array<sparsity_cnt_t, TO_U32(sparsity_t::_count)> sparsity_cnt;
         bool trace_en;
         // stack top on boot
-        uint32_t min_sp = (mem_map::base_addr + mem_map::mem_size);
+        uint32_t stack_top;
+        uint32_t min_sp;
 
     public:
         profiler() = delete;
-        profiler(std::string out_dir, profiler_source_t prof_src);
+        profiler(
+            std::string out_dir, profiler_source_t prof_src, uint32_t mem_size);
         void new_inst(uint32_t inst) { this->inst = inst; }
         void add_te();
         void track_sp(const uint32_t sp);
@@ -338,10 +353,11 @@ class profiler {
             if (active) stack_access.storing(in_range);
         }
         void set_active(bool active) { this->active = active; }
-        void set_trace_en(bool trace_en) { this->trace_en = trace_en; }
+        void set_trace_en(bool trace_en);
         void finish(bool show) { log_to_file_and_print(show); }
 
     private:
+        void encode_te();
         void log_to_file_and_print(bool show);
 
     private:
@@ -1,13 +1,16 @@
 #include "profiler_perf.h"
+#include "str_utils.h"
 
 profiler_perf::profiler_perf(
     std::string out_dir,
-    std::map<uint32_t, symbol_map_entry_t> symbol_map,
+    const std::map<uint32_t, symbol_map_entry_t>& symbol_map,
+    const std::vector<symbol_pc_lut_t>& symbol_pc_lut,
     std::vector<perf_event_t> perf_events,
-    profiler_source_t prof_src)
+    profiler_source_t prof_src) :
+    symbol_map(symbol_map),
+    symbol_pc_lut(symbol_pc_lut)
 {
     this->out_dir = out_dir;
-    this->symbol_map = symbol_map;
     this->perf_events = perf_events;
     this->prof_src = prof_src;
     // set up symbol tracking
@@ -16,27 +19,37 @@ profiler_perf::profiler_perf(
         symbol_lut[s.second.idx] = {s.first, s.second.name};
     }
     // set up beginning of callstack
-    st.idx_callstack.push_back(symbol_map.at(mem_map::base_addr).idx);
-    st.idx_callstack_prev = st.idx_callstack;
+    cs_nodes.push_back({cs_root, 0, false});
+    cs_nodes_cnt.emplace_back();
+    cs_nodes_cnt.back().fill(0);
+    st.node = cs_child(cs_root, symbol_map.at(mem_map::base_addr).idx);
+    st.node_prev = st.node;
     st.fallthrough_valid = false;
     set_fallthrough_symbol(mem_map::base_addr);
     st.updated = false;
     perf_event_flags.fill(0);
     callstack_cnt.fill(0);
+    event_total.fill(0);
+    sample_cnt.fill(0);
 }
 
 bool profiler_perf::finish_inst(uint32_t next_pc) {
     if (!callstack_en) return false;
+    if (sample_period) {
+        // only count towards the samples, callstack is not followed per inst
+        inc_callstack_cnt();
+        return false;
+    }
     // function symbols can be contiguous without a branch between them
     // track that exact fallthrough separately from range-based lookup
     bool fallthrough = (
         st.fallthrough_valid && (next_pc == st.fallthrough_pc) && !st.updated
     );
     if (fallthrough) {
-        auto it = symbol_map.find(next_pc);
-        if (it != symbol_map.end()) {
+        uint16_t idx = find_symbol(next_pc);
+        if (idx) {
             update_callstack(next_pc);
-            st.idx_callstack.back() = it->second.idx;
+            cs_replace_top(idx);
         } else {
             st.fallthrough_valid = false;
         }
@@ -50,27 +63,22 @@ bool profiler_perf::finish_inst(uint32_t next_pc) {
         //std::cout << "diverged at next_pc: " << MEM_ADDR_FORMAT(next_pc)
         //          << std::flush;
 
-        auto temp_cs = st.idx_callstack;
-        while (!temp_cs.empty() && !match_symbol(next_pc, temp_cs.back())) {
-            temp_cs.pop_back();
+        uint32_t node = st.node;
+        while ((node != cs_root) &&
+               !match_symbol(next_pc, cs_nodes[node].idx)) {
+            node = cs_nodes[node].parent;
         }
 
-        // if pop_back resolves the diverged callstack, use it
+        // if popping resolves the diverged callstack, use it
         // else, symbol change likely due to assembly labels, just replace top
-        if (!temp_cs.empty()) {
-            st.idx_callstack = temp_cs;
+        if (node != cs_root) {
+            st.node = node;
         } else {
-            auto found_sym = find_symbol_in_range(next_pc);
-            if (found_sym) {
-                if (st.idx_callstack.empty()) {
-                    st.idx_callstack.push_back(found_sym->second.idx);
-                } else {
-                    st.idx_callstack.back() = found_sym->second.idx;
-                }
-            }
+            uint16_t idx = find_symbol_in_range(next_pc);
+            if (idx) cs_replace_top(idx);
         }
 
-        //if (temp_cs.empty()) {
+        //if (node == cs_root) {
         //    std::cout << "    was empty\n" << std::flush;
         //}
     }
@@ -81,24 +89,24 @@ bool profiler_perf::finish_inst(uint32_t next_pc) {
     st.updated = false;
 
     // ret
-    if (st.idx_callstack != st.idx_callstack_prev) {
-        st.idx_callstack_prev = st.idx_callstack;
+    if (st.node != st.node_prev) {
+        st.node_prev = st.node;
         return true;
     }
     return false;
 }
 
 void profiler_perf::update_branch(uint32_t next_pc, bool taken) {
-    if (!callstack_en) return;
+    if (!callstack_en || sample_period) return;
     if (!taken) return;
     // branches can jump to labels inside a function, range lookup is enough
     // unknown targets leave the stack untouched
-    auto found_sym = find_symbol_in_range(next_pc);
-    if (!found_sym || st.idx_callstack.empty()) return;
-    bool sym_chg = (found_sym->second.idx != st.idx_callstack.back());
+    uint16_t idx = find_symbol_in_range(next_pc);
+    if (!idx || (st.node == cs_root)) return;
+    bool sym_chg = (idx != cs_nodes[st.node].idx);
     if (sym_chg) {
-        update_callstack(found_sym->first);
-        st.idx_callstack.back() = found_sym->second.idx;
+        update_callstack(symbol_lut[idx].pc);
+        cs_replace_top(idx);
     }
 }
 
@@ -106,62 +114,53 @@ void profiler_perf::update_jalr(
     uint32_t next_pc, bool ret_inst, bool tail_call, uint32_t ra)
 {
     if (!callstack_en) return;
+    if (sample_period) {
+        if (ret_inst) sample_ret(next_pc);
+        else if (!tail_call) sample_call(next_pc, ra);
+        return;
+    }
     // also not ret if it doesn't change the symbol
     ret_inst &= symbol_change_on_jump(next_pc);
-    auto target_sym = symbol_map.find(next_pc);
+    uint16_t target_idx = find_symbol(next_pc);
     if (ret_inst) {
         update_callstack(next_pc);
         // catch_empty_callstack("jalr (ret)", next_pc);
-        if (st.idx_callstack.size() > 1) st.idx_callstack.pop_back();
-        if (target_sym != symbol_map.end()) {
+        cs_pop();
+        if (target_idx) {
             // returns to the next symbol (mostly-assembly thing)
-            if (st.idx_callstack.empty()) {
-                st.idx_callstack.push_back(target_sym->second.idx);
-            } else {
-                st.idx_callstack.back() = target_sym->second.idx;
-            }
+            cs_replace_top(target_idx);
         }
-    } else if (target_sym != symbol_map.end()) {
+    } else if (target_idx) {
         update_callstack(next_pc);
-        bool noreturn_call = symbol_map.find(ra) != symbol_map.end();
+        bool noreturn_call = find_symbol(ra);
         if (tail_call || noreturn_call) {
             // tail/noreturn calls replace the current frame
             // keep one frame alive so profiling never produces empty callstack
             // catch_empty_callstack("jalr", next_pc);
-            if (st.idx_callstack.size() > 1) {
-                st.idx_callstack.pop_back();
-                st.idx_callstack.push_back(target_sym->second.idx);
-            } else if (st.idx_callstack.empty()) {
-                st.idx_callstack.push_back(target_sym->second.idx);
-            } else {
-                st.idx_callstack.back() = target_sym->second.idx;
-            }
+            cs_replace_top(target_idx);
         } else {
-            st.idx_callstack.push_back(target_sym->second.idx);
+            cs_push(target_idx);
         }
     }
 }
 
 void profiler_perf::update_jal(uint32_t next_pc, bool tail_call, uint32_t ra) {
     if (!callstack_en) return;
-    bool noreturn_call = symbol_map.find(ra) != symbol_map.end();
-    auto target_sym = symbol_map.find(next_pc);
-    if (target_sym != symbol_map.end()) {
+    if (sample_period) {
+        if (!tail_call) sample_call(next_pc, ra);
+        return;
+    }
+    bool noreturn_call = find_symbol(ra);
+    uint16_t target_idx = find_symbol(next_pc);
+    if (target_idx) {
         update_callstack(next_pc);
         if (tail_call || noreturn_call) {
             // tail/noreturn calls replace the current frame
             // keep one frame alive so profiling never produces empty callstack
             // catch_empty_callstack("jal", next_pc);
-            if (st.idx_callstack.size() > 1) {
-                st.idx_callstack.pop_back();
-                st.idx_callstack.push_back(target_sym->second.idx);
-            } else if (st.idx_callstack.empty()) {
-                st.idx_callstack.push_back(target_sym->second.idx);
-            } else {
-                st.idx_callstack.back() = target_sym->second.idx;
-            }
+            cs_replace_top(target_idx);
         } else {
-            st.idx_callstack.push_back(target_sym->second.idx);
+            cs_push(target_idx);
         }
     }
 }
@@ -174,25 +173,95 @@ void profiler_perf::inc_callstack_cnt() {
     }
     for (const auto &e : perf_events) {
         uint32_t i = TO_U32(e);
-        callstack_cnt[i] += perf_event_flags[i];
+        uint64_t cnt = perf_event_flags[i];
         perf_event_flags[i] = 0;
         #ifdef DPI
-        if (e == perf_event_t::cycle) callstack_cnt[i] += clk_src->get_diff();
+        if (e == perf_event_t::cycle) cnt += clk_src->get_diff();
         #endif
+        event_total[i] += cnt;
+        if (sample_period) take_samples(i, cnt);
+        else callstack_cnt[i] += cnt;
+    }
+}
+
+void profiler_perf::take_samples(uint32_t event, uint64_t cnt) {
+    sample_cnt[event] += cnt;
+    if (sample_cnt[event] < sample_period) return;
+    uint64_t taken = (sample_cnt[event] / sample_period);
+    sample_cnt[event] %= sample_period;
+    uint32_t node = sample_node();
+    cs_nodes_cnt[node][event] += taken;
+    pc_hist[event][inst_pc] += taken;
+    if (inst_has_dmem) dmem_hist[event][inst_dmem] += taken;
+}
+
+// callstack of the sample, a frame per call in flight and one for the pc
+uint32_t profiler_perf::sample_node() {
+    uint32_t node = cs_root;
+    auto push_sym = [this, &node](uint32_t pc) {
+        uint16_t idx = find_symbol_in_range(pc);
+        if (idx) node = cs_child(node, idx);
+    };
+    for (const auto &pc : call_sites) push_sym(pc);
+    push_sym(inst_pc);
+    if (node == cs_root) {
+        node = cs_child(cs_root, symbol_map.at(mem_map::base_addr).idx);
+    }
+    return node;
+}
+
+// same calls as followed when counting, to a symbol and expected to return
+// noreturn calls leave the caller, its frame is then replaced by the callee
+void profiler_perf::sample_call(uint32_t next_pc, uint32_t ra) {
+    if (!find_symbol(next_pc) || find_symbol(ra)) return;
+    if (call_sites.size() < max_call_sites) call_sites.push_back(inst_pc);
+}
+
+// returns to the innermost call it follows, unmatched returns are ignored
+void profiler_perf::sample_ret(uint32_t next_pc) {
+    for (size_t i = call_sites.size(); i > 0; i--) {
+        if ((next_pc - call_sites[i - 1]) <= 4) {
+            call_sites.resize(i - 1);
+            return;
+        }
     }
 }
 
 void profiler_perf::save_callstack_cnt() {
-    auto &dst = callstack_cnt_map[callstack_to_key()];
+    if (sample_period) return; // samples count on their own nodes
+    cs_nodes[st.node].saved = true;
+    auto &dst = cs_nodes_cnt[st.node];
     for (const auto &e : perf_events) {
         uint32_t i = TO_U32(e);
         dst[i] += callstack_cnt[i];
     }
 }
 
+// callstack is not followed while fast-forwarding, restart it at pc
+// on a function entry, ra gives the direct caller, deeper ones are not known
+void profiler_perf::resync_callstack(uint32_t pc, uint32_t ra) {
+    perf_event_flags.fill(0);
+    if (!callstack_en) return;
+    if (sample_period) {
+        call_sites.clear();
+        if (find_symbol(pc)) call_sites.push_back(ra);
+        return;
+    }
+    st.node = cs_child(cs_root, symbol_map.at(mem_map::base_addr).idx);
+    auto push_sym = [this](uint32_t addr) {
+        uint16_t idx = find_symbol_in_range(addr);
+        if (idx && (idx != cs_nodes[st.node].idx)) cs_push(idx);
+    };
+    if (find_symbol(pc)) push_sym(ra);
+    push_sym(pc);
+    st.node_prev = st.node;
+    set_fallthrough_symbol(pc);
+    st.updated = false;
+}
+
 void profiler_perf::catch_empty_callstack(
     const std::string& inst, uint32_t next_pc) {
-    if (st.idx_callstack.empty()) {
+    if (st.node == cs_root) {
         std::cerr << "ERROR: " << inst << ": callstack underflow at "
                   << std::hex << next_pc << std::dec << std::endl;
         throw std::runtime_error("callstack underflow");
@@ -213,51 +282,65 @@ void profiler_perf::set_fallthrough_symbol(uint32_t pc) {
     // clear first so a function without a following symbol cannot reuse
     // stale target
     st.fallthrough_valid = false;
-    auto it = symbol_map.find(pc);
-    if (it == symbol_map.end()) return;
-    it++;
-    if (it == symbol_map.end()) return;
-    st.fallthrough_pc = it->first;
+    // indices follow symbol addresses, the next one is the next symbol
+    uint16_t idx = find_symbol(pc);
+    if (!idx || ((idx + 1u) >= symbol_lut.size())) return;
+    st.fallthrough_pc = symbol_lut[idx + 1].pc;
     st.fallthrough_valid = true;
 }
 
 bool profiler_perf::symbol_change_on_jump(uint32_t next_pc) {
-    if (st.idx_callstack.empty()) return false;
-    auto found_sym = find_symbol_in_range(next_pc);
-    return found_sym && (found_sym->second.idx != st.idx_callstack.back());
+    if (st.node == cs_root) return false;
+    uint16_t idx = find_symbol_in_range(next_pc);
+    return idx && (idx != cs_nodes[st.node].idx);
 }
 
-std::optional<std::pair<uint32_t, symbol_map_entry_t>>
-profiler_perf::find_symbol_in_range(uint32_t next_pc)
-{
+uint16_t profiler_perf::find_symbol_in_range(uint32_t pc) {
     // map arbitrary PCs to the nearest preceding symbol
     // PCs before the first symbol
     // (e.g. mtvec=0 during bad boot code) have no valid symbol range
-    if (symbol_map.empty()) return std::nullopt;
-    auto it = symbol_map.upper_bound(next_pc);
-    if (it == symbol_map.begin()) return std::nullopt;
+    for (const auto& lut : symbol_pc_lut) {
+        uint32_t off = (pc - lut.base);
+        if (off < lut.size) return lut.idx[off >> 1];
+    }
+    // outside of executable regions
+    auto it = symbol_map.upper_bound(pc);
+    if (it == symbol_map.begin()) return 0;
     it--;
-    return *it;
+    return it->second.idx;
 }
 
-std::string profiler_perf::get_callstack_str(
-    const std::vector<uint16_t>& idx_stack)
-{
-    std::string stack_str = "";
-    if (idx_stack.empty()) return "<unknown>;";
-    for (const auto &idx : idx_stack) {
-        if ((idx < symbol_lut.size()) && !symbol_lut[idx].name.empty()) {
-            stack_str += symbol_lut[idx].name + ";";
-        } else {
-            stack_str += "<unknown>;";
-        }
+uint32_t profiler_perf::cs_child(uint32_t node, uint16_t idx) {
+    uint64_t key = ((TO_U64(node) << 16) | idx);
+    auto it = cs_children.find(key);
+    if (it != cs_children.end()) return it->second;
+    uint32_t child = TO_U32(cs_nodes.size());
+    cs_nodes.push_back({node, idx, false});
+    cs_nodes_cnt.emplace_back();
+    cs_nodes_cnt.back().fill(0);
+    cs_children.emplace(key, child);
+    return child;
+}
+
+std::string profiler_perf::get_symbol_str(uint16_t idx) {
+    if ((idx < symbol_lut.size()) && !symbol_lut[idx].name.empty()) {
+        return symbol_lut[idx].name + ";";
     }
-    return stack_str;
+    return "<unknown>;";
 }
 
-std::u16string profiler_perf::callstack_to_key() {
-  auto p = reinterpret_cast<const char16_t*>(st.idx_callstack.data());
-  return std::u16string(p, st.idx_callstack.size());
+std::string profiler_perf::get_callstack_str(uint32_t node) {
+    if (node == cs_root) return "<unknown>;";
+    // walk up to the root, callers first
+    std::vector<uint16_t> idx_stack;
+    for (; node != cs_root; node = cs_nodes[node].parent) {
+        idx_stack.push_back(cs_nodes[node].idx);
+    }
+    std::string stack_str = "";
+    for (auto it = idx_stack.rbegin(); it != idx_stack.rend(); it++) {
+        stack_str += get_symbol_str(*it);
+    }
+    return stack_str;
 }
 
 void profiler_perf::log_to_file_and_print(bool show) {
@@ -270,21 +353,29 @@ void profiler_perf::log_to_file_and_print(bool show) {
     // one folded file per tracked event; totals kept for the stdout summary
     std::array<uint64_t, TO_U32(perf_event_t::_count)> totals;
     totals.fill(0);
-    std::vector<uint16_t> callstack_ids;
-    for (const auto &e : perf_events) {
-        uint32_t ei = TO_U32(e);
-        std::string out = (
-            out_dir + "callstack_folded_" + perf_event_names[ei] + tag + ".txt"
-        );
-        std::ofstream out_file(out);
-        for (const auto &c : callstack_cnt_map) {
-            callstack_ids.clear();
-            callstack_ids.reserve(c.first.size());
-            // demangle the key string
-            for (const auto &id : c.first) callstack_ids.push_back(TO_U16(id));
-            out_file << get_callstack_str(callstack_ids) << " "
-                     << c.second[ei] << "\n";
-            totals[ei] += c.second[ei];
+    log_speedscope(tag);
+    if (sample_period) {
+        log_samples(tag);
+        totals = event_total;
+    } else {
+        // stack strings are built once, shared by all events
+        std::vector<std::pair<std::string, uint32_t>> callstacks;
+        for (uint32_t n = 0; n < cs_nodes.size(); n++) {
+            if (!cs_nodes[n].saved) continue;
+            callstacks.push_back({get_callstack_str(n), n});
+        }
+        for (const auto &e : perf_events) {
+            uint32_t ei = TO_U32(e);
+            std::string out = (
+                out_dir + "callstack_folded_" + perf_event_names[ei] + tag +
+                ".txt"
+            );
+            std::ofstream out_file(out);
+            for (const auto &c : callstacks) {
+                uint64_t cnt = cs_nodes_cnt[c.second][ei];
+                out_file << c.first << " " << cnt << "\n";
+                totals[ei] += cnt;
+            }
         }
     }
 
@@ -297,7 +388,12 @@ void profiler_perf::log_to_file_and_print(bool show) {
     std::cout << "Profiler - Perf:\n";
     for (const auto &e : perf_events) {
         std::cout << INDENT << "Event: " << perf_event_names[TO_U32(e)]
-                  << ", Samples: " << totals[TO_U32(e)] << "\n";
+                  << ", Samples: " << totals[TO_U32(e)];
+        if (sample_period) {
+            std::cout << ", Sampled: " << (totals[TO_U32(e)] / sample_period)
+                      << " (every " << sample_period << ")";
+        }
+        std::cout << "\n";
     }
     if (diverged_cnt) {
             std::cout << INDENT << "Warning: Stacktop divergence detected "
@@ -305,12 +401,129 @@ void profiler_perf::log_to_file_and_print(bool show) {
     }
 }
 
-bool profiler_perf::match_symbol(uint32_t pc, uint16_t idx) {
-    auto found_sym = find_symbol_in_range(pc);
-    return found_sym && (found_sym->second.idx == idx);
+std::vector<uint64_t> profiler_perf::get_node_cnt(uint32_t event) {
+    std::vector<uint64_t> cnt(cs_nodes.size(), 0);
+    for (uint32_t n = 0; n < cs_nodes.size(); n++) {
+        cnt[n] = cs_nodes_cnt[n][event];
+    }
+    return cnt;
+}
+
+// speedscope file format, sampled profile per event, one sample per callstack
+// inclusive and exclusive counts per frame are added to each profile
+void profiler_perf::log_speedscope(const std::string& tag) {
+    // symbols found on callstacks are the frames
+    std::vector<int32_t> frame_idx(symbol_lut.size(), -1);
+    std::vector<uint16_t> frames;
+    for (uint32_t n = 0; n < cs_nodes.size(); n++) {
+        if (n == cs_root) continue;
+        uint16_t idx = cs_nodes[n].idx;
+        if (frame_idx[idx] >= 0) continue;
+        frame_idx[idx] = TO_I32(frames.size());
+        frames.push_back(idx);
+    }
+
+    std::ofstream ofs(out_dir + "callstack" + tag + ".speedscope.json");
+    ofs << "{\n"
+        << INDENT << "\"$schema\": "
+        << "\"https://www.speedscope.app/file-format-schema.json\",\n"
+        << INDENT << "\"exporter\": \"ama-riscv-sim\",\n"
+        << INDENT << "\"activeProfileIndex\": 0,\n"
+        << INDENT << "\"shared\": {\"frames\": [";
+    for (uint32_t f = 0; f < frames.size(); f++) {
+        if (f) ofs << ", ";
+        ofs << "{\"name\": \""
+            << str_utils::json_escape(symbol_lut[frames[f]].name) << "\"}";
+    }
+    ofs << "]},\n" << INDENT << "\"profiles\": [";
+
+    std::vector<uint64_t> incl(frames.size());
+    std::vector<uint64_t> excl(frames.size());
+    // last callstack that counted the frame, recursion counts only once
+    std::vector<uint32_t> seen(frames.size());
+    std::vector<int32_t> stack;
+    for (uint32_t i = 0; i < perf_events.size(); i++) {
+        uint32_t ei = TO_U32(perf_events[i]);
+        std::vector<uint64_t> cnt = get_node_cnt(ei);
+        std::fill(incl.begin(), incl.end(), 0);
+        std::fill(excl.begin(), excl.end(), 0);
+        std::fill(seen.begin(), seen.end(), cs_root);
+        std::ostringstream weights;
+        uint64_t total = 0;
+        ofs << (i ? "," : "") << "\n" << INDENT << INDENT << "{"
+            << "\"type\": \"sampled\", "
+            << "\"name\": \"" << perf_event_names[ei] << "\", "
+            << "\"unit\": \"none\",\n"
+            << INDENT << INDENT << " \"samples\": [";
+        for (uint32_t n = 0; n < cs_nodes.size(); n++) {
+            if ((n == cs_root) || !cnt[n]) continue;
+            stack.clear();
+            for (uint32_t m = n; m != cs_root; m = cs_nodes[m].parent) {
+                stack.push_back(frame_idx[cs_nodes[m].idx]);
+            }
+            excl[TO_U32(stack.front())] += cnt[n];
+            for (const auto &f : stack) {
+                if (seen[TO_U32(f)] == n) continue;
+                seen[TO_U32(f)] = n;
+                incl[TO_U32(f)] += cnt[n];
+            }
+            ofs << (total ? ", " : "") << "[";
+            for (auto it = stack.rbegin(); it != stack.rend(); it++) {
+                ofs << ((it != stack.rbegin()) ? "," : "") << *it;
+            }
+            ofs << "]";
+            weights << (total ? ", " : "") << cnt[n];
+            total += cnt[n];
+        }
+        ofs << "],\n"
+            << INDENT << INDENT << " \"weights\": [" << weights.str() << "],\n"
+            << INDENT << INDENT << " \"startValue\": 0, "
+            << "\"endValue\": " << total << ",\n"
+            << INDENT << INDENT << " \"inclusive\": [";
+        for (uint32_t f = 0; f < frames.size(); f++) {
+            ofs << (f ? ", " : "") << incl[f];
+        }
+        ofs << "],\n" << INDENT << INDENT << " \"exclusive\": [";
+        for (uint32_t f = 0; f < frames.size(); f++) {
+            ofs << (f ? ", " : "") << excl[f];
+        }
+        ofs << "]}";
+    }
+    ofs << "\n" << INDENT << "]\n}\n";
+}
+
+void profiler_perf::log_samples(const std::string& tag) {
+    // samples per callstack, pc and data address, for each event
+    for (const auto &e : perf_events) {
+        uint32_t ei = TO_U32(e);
+        std::vector<uint64_t> node_cnt = get_node_cnt(ei);
+
+        std::string name = perf_event_names[ei] + tag;
+        std::ofstream folded(out_dir + "callstack_sampled_" + name + ".txt");
+        for (uint32_t n = 0; n < cs_nodes.size(); n++) {
+            if (!node_cnt[n]) continue;
+            folded << get_callstack_str(n) << " " << node_cnt[n] << "\n";
+        }
+
+        std::ofstream pc_csv(out_dir + "pc_hist_" + name + ".csv");
+        pc_csv << "PC,Samples,Symbol\n";
+        for (const auto &[pc, cnt] : pc_hist[ei]) {
+            const std::string& sym = symbol_lut[find_symbol_in_range(pc)].name;
+            pc_csv << std::hex << pc << std::dec << "," << cnt << ","
+                   << (sym.empty() ? "<unknown>" : sym) << "\n";
+        }
+
+        // only for events that come from loads and stores
+        if (dmem_hist[ei].empty()) continue;
+        std::ofstream dmem_csv(out_dir + "dmem_hist_" + name + ".csv");
+        dmem_csv << "Address,Samples\n";
+        for (const auto &[addr, cnt] : dmem_hist[ei]) {
+            dmem_csv << std::hex << addr << std::dec << "," << cnt << "\n";
+        }
+    }
 }
 
 bool profiler_perf::match_top(uint32_t next_pc) {
-    if (st.idx_callstack.empty()) return false;
-    return match_symbol(next_pc, st.idx_callstack.back());
+    if (st.node == cs_root) return false;
+    return match_symbol(next_pc, cs_nodes[st.node].idx);
 }
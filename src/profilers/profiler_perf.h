@@ -4,10 +4,13 @@
 
 class profiler_perf {
     private:
+        static constexpr uint32_t cs_root = 0;
         bool active;
         std::string out_dir;
         symbol_tracking_t st;
-        std::map<uint32_t, symbol_map_entry_t> symbol_map;
+        // owned by memory, shared for the lifetime of the sim
+        const std::map<uint32_t, symbol_map_entry_t>& symbol_map;
+        const std::vector<symbol_pc_lut_t>& symbol_pc_lut;
         std::vector<symbol_lut_entry_t> symbol_lut;
         std::vector<perf_event_t> perf_events;
         profiler_source_t prof_src;
@@ -15,21 +18,41 @@ class profiler_perf {
         // uint16_t for insurance; today's max is div at 34 stall cycles
         std::array<uint16_t, TO_U32(perf_event_t::_count)> perf_event_flags;
         std::array<uint64_t, TO_U32(perf_event_t::_count)> callstack_cnt;
-        std::unordered_map<
-            std::u16string,
-            std::array<uint64_t, TO_U32(perf_event_t::_count)>
-        > callstack_cnt_map;
+        // running totals while active, across all callstacks
+        std::array<uint64_t, TO_U32(perf_event_t::_count)> event_total;
+        // calling context tree, counts accumulate on the node of the stack
+        std::vector<callstack_node_t> cs_nodes;
+        std::vector<std::array<uint64_t, TO_U32(perf_event_t::_count)>>
+            cs_nodes_cnt;
+        // (parent << 16 | symbol) -> child node
+        std::unordered_map<uint64_t, uint32_t> cs_children;
         #ifdef DPI
         clock_source_t* clk_src;
         #endif
         uint32_t diverged_cnt = 0;
         bool callstack_en = true;
+        // sampling mode, every Nth event is sampled instead of counted
+        // samples go straight into the node counts and the histograms
+        uint64_t sample_period = 0;
+        std::array<uint64_t, TO_U32(perf_event_t::_count)> sample_cnt;
+        std::array<std::map<uint32_t, uint64_t>, TO_U32(perf_event_t::_count)>
+            pc_hist;
+        std::array<std::map<uint32_t, uint64_t>, TO_U32(perf_event_t::_count)>
+            dmem_hist;
+        // sampling mode, pc of each call in flight, the callstack is built
+        // from them only when a sample is taken
+        static constexpr size_t max_call_sites = 1024;
+        std::vector<uint32_t> call_sites;
+        uint32_t inst_pc = 0;
+        uint32_t inst_dmem = 0;
+        bool inst_has_dmem = false;
 
     public:
         profiler_perf() = delete;
         profiler_perf(
             std::string out_dir,
-            std::map<uint32_t, symbol_map_entry_t> symbol_map,
+            const std::map<uint32_t, symbol_map_entry_t>& symbol_map,
+            const std::vector<symbol_pc_lut_t>& symbol_pc_lut,
             std::vector<perf_event_t> perf_events,
             profiler_source_t prof_src);
         #ifdef DPI
@@ -38,37 +61,75 @@ class profiler_perf {
         void set_active(bool active) { this->active = active; }
         void set_callstack_en(bool en) { callstack_en = en; }
         bool is_callstack_en() const { return callstack_en; }
-        bool finish_inst(uint32_t next_pc);
-        std::string get_callstack_str() {
-            return get_callstack_str(st.idx_callstack);
+        void set_sample_period(uint64_t period) { sample_period = period; }
+        // pc and data address attached to samples taken for this inst
+        void new_inst(uint32_t pc) {
+            inst_pc = pc;
+            inst_has_dmem = false;
+        }
+        void set_dmem(uint32_t addr) {
+            inst_dmem = addr;
+            inst_has_dmem = true;
         }
+        bool finish_inst(uint32_t next_pc);
+        std::string get_callstack_str() { return get_callstack_str(st.node); }
         std::string get_callstack_top_str() {
-            return get_callstack_str({st.idx_callstack.back()});
+            return get_symbol_str(cs_nodes[st.node].idx);
         }
         void update_branch(uint32_t next_pc, bool taken);
         void update_jalr(
             uint32_t next_pc, bool inst_ret, bool tail_call, uint32_t ra);
         void update_jal(uint32_t next_pc, bool tail_call, uint32_t ra);
+        void resync_callstack(uint32_t pc, uint32_t ra);
         void set_perf_event_flag(perf_event_t perf_event) {
             perf_event_flags[TO_U32(perf_event)] += 1;
         }
         void set_perf_event_flag(perf_event_t perf_event, bool set) {
             perf_event_flags[TO_U32(perf_event)] += TO_U32(set);
         }
+        uint64_t get_event_total(perf_event_t perf_event) const {
+            return event_total[TO_U32(perf_event)];
+        }
         void finish(bool show) { log_to_file_and_print(show); }
         bool match_top(uint32_t next_pc);
 
     private:
         void inc_callstack_cnt();
         void save_callstack_cnt();
+        void take_samples(uint32_t event, uint64_t cnt);
+        uint32_t sample_node();
+        void sample_call(uint32_t next_pc, uint32_t ra);
+        void sample_ret(uint32_t next_pc);
         void catch_empty_callstack(const std::string& inst, uint32_t next_pc);
         void update_callstack(uint32_t next_pc);
         void set_fallthrough_symbol(uint32_t pc);
         bool symbol_change_on_jump(uint32_t next_pc);
-        bool match_symbol(uint32_t pc, uint16_t idx);
-        std::optional<std::pair<uint32_t, symbol_map_entry_t>>
-            find_symbol_in_range(uint32_t next_pc);
-        std::string get_callstack_str(const std::vector<uint16_t>& idx_stack);
-        std::u16string callstack_to_key();
+        bool match_symbol(uint32_t pc, uint16_t idx) {
+            uint16_t found_idx = find_symbol_in_range(pc);
+            return found_idx && (found_idx == idx);
+        }
+        // symbol index, 0 if none
+        uint16_t find_symbol_in_range(uint32_t pc);
+        uint16_t find_symbol(uint32_t pc) {
+            uint16_t idx = find_symbol_in_range(pc);
+            return (idx && (symbol_lut[idx].pc == pc)) ? idx : 0;
+        }
+        uint32_t cs_child(uint32_t node, uint16_t idx);
+        void cs_push(uint16_t idx) { st.node = cs_child(st.node, idx); }
+        // pop only while a caller is left, never empties the stack
+        void cs_pop() {
+            if (cs_nodes[st.node].parent != cs_root) {
+                st.node = cs_nodes[st.node].parent;
+            }
+        }
+        void cs_replace_top(uint16_t idx) {
+            if (st.node == cs_root) cs_push(idx);
+            else st.node = cs_child(cs_nodes[st.node].parent, idx);
+        }
+        std::string get_symbol_str(uint16_t idx);
+        std::string get_callstack_str(uint32_t node);
+        std::vector<uint64_t> get_node_cnt(uint32_t event);
+        void log_speedscope(const std::string& tag);
+        void log_samples(const std::string& tag);
         void log_to_file_and_print(bool show);
 };
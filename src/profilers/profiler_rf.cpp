@@ -3,9 +3,23 @@
 
 #include "profiler_rf.h"
 
+void profiler_rf::set_trace_en(bool trace_en, const std::string& out_dir) {
+    this->trace_en = trace_en;
+    if (trace_en && !trace.is_en()) {
+        trace.open(out_dir + "rf_trace.bin", trace_stream_t::rf_trace,
+                   rf_trace_cols);
+    }
+}
+
 void profiler_rf::add_te() {
-    if (!active) return;
-    trace.push_back(te);
+    if (!active || !trace_en) return;
+    trace.begin(trace_cnt++);
+    uint32_t col = 0;
+    for (uint8_t v : {te.opc_g_val, te.opc_b_val, te.rd, te.rs1, te.rs2,
+                      te.rd_val_zero, te.rdp_val_zero}) {
+        trace.u8(col++, v);
+    }
+    trace.end();
     te.rst();
 }
 
@@ -14,11 +28,7 @@ void profiler_rf::log_reg_use(reg_use_t reg_use, uint8_t reg) {
 }
 
 void profiler_rf::finish(const std::string& out_dir) {
-    if (trace_en) {
-        std::ofstream ofs(out_dir + "rf_trace.bin", std::ios::binary);
-        ofs.write(reinterpret_cast<const char*>(trace.data()),
-                  static_cast<std::streamsize>(trace.size() * sizeof(rf_trace_entry)));
-    }
+    if (trace_en) trace.finish();
     if (rf_usage_en) {
         std::ofstream ofs(out_dir + "rf_usage.bin", std::ios::binary);
         ofs.write(
@@ -30,6 +30,9 @@ struct rf_trace_entry {
 };
 static_assert(sizeof(rf_trace_entry) == 7, "rf_trace_entry layout changed");
 
+// rf_trace.bin columns, one raw byte each, in rf_trace_entry order
+constexpr uint32_t rf_trace_cols = sizeof(rf_trace_entry);
+
 class profiler_rf {
 public:
     rf_trace_entry te;
@@ -45,11 +48,12 @@ public:
     void log_reg_use(reg_use_t reg_use, uint8_t reg);
     void finish(const std::string& out_dir);
     void set_active(bool active) { this->active = active; te.rst(); }
-    void set_trace_en(bool trace_en) { this->trace_en = trace_en; }
+    void set_trace_en(bool trace_en, const std::string& out_dir);
     void set_rf_usage_en(bool rf_usage_en) { this->rf_usage_en = rf_usage_en; }
 
 private:
-    std::vector<rf_trace_entry> trace;
+    trace_stream_out trace;
+    uint64_t trace_cnt = 0;
     std::array<std::array<uint64_t, TO_U32(reg_use_t::_count)>, 32>
         prof_rf_usage = {{}};
 };
@@ -0,0 +1,101 @@
+#include "trace_stream.h"
+
+#ifdef TRACE_ZLIB_EN
+#include <zlib.h>
+#endif
+
+void trace_stream_out::open(
+    std::string path, trace_stream_t kind, uint32_t n_cols) {
+    this->path = path;
+    ofs.open(path, std::ios::binary | std::ios::trunc);
+    if (!ofs.is_open()) {
+        std::cerr << "ERROR: Failed to open trace file for writing: "
+                  << path << std::endl;
+        throw std::runtime_error("Failed to open trace file.");
+    }
+    #ifdef TRACE_ZLIB_EN
+    deflate = true;
+    #endif
+    cols.resize(n_cols);
+    for (auto& c : cols) c.reserve(trace_stream_cfg::chunk_entries);
+    en = true;
+    uint32_t flags = deflate ? trace_stream_cfg::flag_deflate : 0;
+    for (uint32_t v : {trace_stream_cfg::magic, trace_stream_cfg::version,
+                       TO_U32(kind), n_cols, trace_stream_cfg::chunk_entries,
+                       flags}) {
+        write_u32(v);
+    }
+}
+
+void trace_stream_out::write(const uint8_t* data, size_t size) {
+    ofs.write(reinterpret_cast<const char*>(data), TO_I64(size));
+    offset += size;
+}
+
+void trace_stream_out::write_u32(uint32_t v) {
+    std::array<uint8_t, 4> b;
+    for (uint32_t i = 0; i < 4; i++) b[i] = TO_U8(v >> (8 * i));
+    write(b.data(), b.size());
+}
+
+void trace_stream_out::write_u64(uint64_t v) {
+    write_u32(TO_U32(v));
+    write_u32(TO_U32(v >> 32));
+}
+
+void trace_stream_out::flush_chunk() {
+    if (entries == 0) return;
+    payload.clear();
+    for (const auto& c : cols) {
+        for (uint32_t i = 0; i < 4; i++) {
+            payload.push_back(TO_U8(c.size() >> (8 * i)));
+        }
+    }
+    for (const auto& c : cols) {
+        payload.insert(payload.end(), c.begin(), c.end());
+    }
+
+    const uint8_t* stored = payload.data();
+    size_t stored_size = payload.size();
+    #ifdef TRACE_ZLIB_EN
+    uLongf packed_size = compressBound(payload.size());
+    packed.resize(packed_size);
+    int rc = compress2(packed.data(), &packed_size, payload.data(),
+                       payload.size(), Z_BEST_SPEED);
+    // keep it raw if it doesn't shrink
+    if ((rc == Z_OK) && (packed_size < payload.size())) {
+        stored = packed.data();
+        stored_size = packed_size;
+    }
+    #endif
+
+    index.push_back({first_key, last_key, offset, entries});
+    write_u32(entries);
+    write_u32(TO_U32(payload.size()));
+    write_u32(TO_U32(stored_size));
+    write(stored, stored_size);
+    for (auto& c : cols) c.clear();
+    entries = 0;
+}
+
+void trace_stream_out::finish() {
+    if (!en) return;
+    flush_chunk();
+    uint64_t index_offset = offset;
+    for (const auto& ci : index) {
+        write_u64(ci.first_key);
+        write_u64(ci.last_key);
+        write_u64(ci.offset);
+        write_u32(ci.entries);
+    }
+    write_u64(index_offset);
+    write_u32(TO_U32(index.size()));
+    write_u32(trace_stream_cfg::index_magic);
+    ofs.close();
+    if (ofs.fail()) {
+        std::cerr << "ERROR: Failed to write trace file: " << path
+                  << std::endl;
+        throw std::runtime_error("Failed to write trace file.");
+    }
+    en = false;
+}
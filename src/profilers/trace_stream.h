@@ -0,0 +1,92 @@
+#pragma once
+
+#include "defines.h"
+#include "async_out.h"
+
+namespace trace_stream_cfg {
+    constexpr uint32_t magic = 0x53525441; // "ATRS"
+    constexpr uint32_t index_magic = 0x58525441; // "ATRX"
+    constexpr uint32_t version = 1;
+    constexpr uint32_t chunk_entries = (1u << 16);
+    constexpr uint32_t flag_deflate = (1u << 0);
+}
+
+enum class trace_stream_t : uint32_t { trace, rf_trace, exec_log };
+
+/*
+Chunked columnar trace, written as entries come in, only the current chunk
+and the chunk index are kept in memory
+- header: magic, version, kind, columns, entries per chunk, flags (u32)
+- chunk: entries, raw size, stored size (u32), then the payload: column
+  sizes (u32 each), then the columns back to back
+    - stored size smaller than raw size means the payload is deflated
+    - each chunk decodes on its own, encoder deltas restart at chunk start
+- index: first key, last key, file offset (u64) and entries (u32) per chunk,
+  followed by the index offset (u64), chunk count and index magic (u32)
+- key is the sample count for trace, entry number for rf_trace, instruction
+  count for exec_log, so a range maps to chunks without decoding anything
+- all values little endian, varints are LEB128
+*/
+class trace_stream_out {
+    private:
+        struct chunk_info_t {
+            uint64_t first_key;
+            uint64_t last_key;
+            uint64_t offset;
+            uint32_t entries;
+        };
+
+    private:
+        async_ofstream ofs;
+        std::string path;
+        bool en = false;
+        bool deflate = false;
+        std::vector<std::vector<uint8_t>> cols;
+        std::vector<uint8_t> payload;
+        #ifdef TRACE_ZLIB_EN
+        std::vector<uint8_t> packed;
+        #endif
+        std::vector<chunk_info_t> index;
+        uint64_t offset = 0;
+        uint64_t first_key = 0;
+        uint64_t last_key = 0;
+        uint32_t entries = 0;
+
+    private:
+        void flush_chunk();
+        void write(const uint8_t* data, size_t size);
+        void write_u32(uint32_t v);
+        void write_u64(uint64_t v);
+
+    public:
+        trace_stream_out() = default;
+        void open(std::string path, trace_stream_t kind, uint32_t n_cols);
+        bool is_en() const { return en; }
+        // encoders reset their delta state when this is true
+        bool chunk_start() const { return entries == 0; }
+        void begin(uint64_t key) {
+            if (entries == 0) first_key = key;
+            last_key = key;
+        }
+        void u8(uint32_t col, uint8_t v) { cols[col].push_back(v); }
+        void u32(uint32_t col, uint32_t v) {
+            for (uint32_t i = 0; i < 4; i++) {
+                cols[col].push_back(TO_U8(v >> (8 * i)));
+            }
+        }
+        void varint(uint32_t col, uint64_t v) {
+            while (v >= 0x80) {
+                cols[col].push_back(TO_U8(v | 0x80));
+                v >>= 7;
+            }
+            cols[col].push_back(TO_U8(v));
+        }
+        static uint32_t zz(uint32_t v) {
+            return ((v << 1) ^ TO_U32(TO_I32(v) >> 31));
+        }
+        void zigzag(uint32_t col, uint32_t v) { varint(col, zz(v)); }
+        void end() {
+            if (++entries == trace_stream_cfg::chunk_entries) flush_chunk();
+        }
+        void finish();
+};
@@ -0,0 +1,103 @@
+#include "smarts.h"
+
+void smarts_sampler::init(
+    uint64_t period, uint64_t unit, std::string out_dir, uint64_t inst_cnt) {
+    this->period = period;
+    this->unit = unit;
+    this->out_dir = out_dir;
+    next_toggle = (inst_cnt + period - unit);
+}
+
+size_t smarts_sampler::add_counter(std::string name) {
+    cnt_names.push_back(name);
+    return (cnt_names.size() - 1);
+}
+
+void smarts_sampler::add_metric(
+    std::string name, size_t num, size_t den, double scale) {
+    metrics.push_back({name, num, den, scale});
+}
+
+void smarts_sampler::begin_unit(const std::vector<uint64_t>& cnt) {
+    unit_start = cnt;
+    in_unit = true;
+    next_toggle += unit;
+}
+
+void smarts_sampler::end_unit(const std::vector<uint64_t>& cnt) {
+    std::vector<uint64_t> diff(cnt.size());
+    for (size_t i = 0; i < cnt.size(); i++) diff[i] = cnt[i] - unit_start[i];
+    samples.push_back(diff);
+    in_unit = false;
+    next_toggle += (period - unit);
+}
+
+void smarts_sampler::finish() {
+    if (!period) return;
+    // partial unit at the end of the run isn't measured
+    const size_t n = samples.size();
+    std::cout << "SMARTS: " << n << " units of " << unit
+              << " instructions, every " << period
+              << " instructions, 99.7% confidence\n";
+    if (n < 2) {
+        SIM_WARNING << "Not enough units for confidence intervals, "
+                    << "use a shorter 'smarts_period'\n";
+    }
+
+    std::ofstream ofs(out_dir + "smarts.json");
+    ofs << "{\n\"period\": " << period
+        << ",\n\"unit\": " << unit
+        << ",\n\"units\": " << n
+        << ",\n\"z\": " << z
+        << ",\n\"metrics\": {";
+
+    bool first = true;
+    for (const auto& m : metrics) {
+        double sum_num = 0.0, sum_den = 0.0;
+        for (const auto& s : samples) {
+            sum_num += TO_F64(s[m.num]);
+            sum_den += TO_F64(s[m.den]);
+        }
+        if (sum_den == 0.0) continue; // e.g. no branches
+        // ratio estimator, variance from the residuals around it
+        const double est = (sum_num / sum_den);
+        double ci = -1.0, rel_err = -1.0;
+        uint64_t units_needed = 0;
+        if (n > 1) {
+            double ss = 0.0;
+            for (const auto& s : samples) {
+                double r = (TO_F64(s[m.num]) - est * TO_F64(s[m.den]));
+                ss += (r * r);
+            }
+            const double d_mean = (sum_den / TO_F64(n));
+            const double se =
+                (std::sqrt(ss / TO_F64(n - 1) / TO_F64(n)) / d_mean);
+            ci = (z * se * m.scale);
+            if (est > 0.0) {
+                rel_err = (z * se / est);
+                units_needed = TO_U64(std::ceil(
+                    TO_F64(n) * std::pow(rel_err / target_err, 2)));
+            }
+        }
+
+        std::cout << INDENT << std::left << std::setw(22) << m.name
+                  << std::right << std::fixed << std::setprecision(4)
+                  << (est * m.scale) << " +- " << ci;
+        if (rel_err >= 0.0) {
+            std::cout << std::setprecision(2) << " (" << (rel_err * 100.0)
+                      << "%), " << units_needed << " units for +-"
+                      << (target_err * 100.0) << "%";
+        }
+        std::cout << "\n";
+
+        ofs << (first ? "" : ",") << "\n\"" << m.name << "\": {"
+            << "\"mean\": " << (est * m.scale)
+            << ", \"ci\": " << ci
+            << ", \"rel_err\": " << rel_err
+            << ", \"units_needed\": " << units_needed << "}";
+        first = false;
+    }
+    ofs << "\n}\n}\n";
+    std::cout << std::defaultfloat << "SMARTS estimates saved as '"
+              << out_dir << "smarts.json'\n";
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include "defines.h"
+
+/*
+SMARTS style statistical sampling
+- every period ends with a measurement unit of detailed simulation, the rest
+  of the period is functional warming, i.e. HW models are updated but stats,
+  profilers, logs and traces are off
+- no detailed warming ahead of the unit, there is no pipeline state to warm
+- counters are running totals snapshotted at the unit boundaries, a metric is
+  the ratio of two of them, estimated over all units with a ratio estimator
+*/
+class smarts_sampler {
+    private:
+        // 99.7% confidence, as in SMARTS
+        static constexpr double z = 3.0;
+        static constexpr double target_err = 0.03; // for units needed
+        struct metric_t {
+            std::string name;
+            size_t num;
+            size_t den;
+            double scale;
+        };
+        uint64_t period = 0; // instructions, 0 if not sampling
+        uint64_t unit = 0;
+        uint64_t next_toggle = 0; // inst count of the next unit start/end
+        bool in_unit = false;
+        std::vector<std::string> cnt_names;
+        std::vector<metric_t> metrics;
+        std::vector<uint64_t> unit_start; // counters at the unit start
+        std::vector<std::vector<uint64_t>> samples; // per unit, per counter
+        std::string out_dir;
+
+    public:
+        smarts_sampler() = default;
+        // first unit ends one period after inst_cnt
+        void init(
+            uint64_t period, uint64_t unit, std::string out_dir,
+            uint64_t inst_cnt);
+        size_t add_counter(std::string name);
+        void add_metric(std::string name, size_t num, size_t den, double scale);
+        bool is_en() const { return (period != 0); }
+        bool should_toggle(uint64_t inst_cnt) const {
+            return (inst_cnt >= next_toggle);
+        }
+        bool unit_active() const { return in_unit; }
+        // counters in order they were added
+        void begin_unit(const std::vector<uint64_t>& cnt);
+        void end_unit(const std::vector<uint64_t>& cnt);
+        void finish();
+};
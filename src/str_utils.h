@@ -96,4 +96,24 @@ namespace str_utils {
         return s;
     }
 
+    // escapes quotes, backslashes and control chars for a JSON string value
+    inline std::string json_escape(const std::string& s) {
+        std::string result;
+        result.reserve(s.size());
+        for (unsigned char c : s) {
+            if (c == '"' || c == '\\') {
+                result += '\\';
+                result += static_cast<char>(c);
+            } else if (c < 0x20) {
+                static constexpr char hex[] = "0123456789abcdef";
+                result += "\\u00";
+                result += hex[c >> 4];
+                result += hex[c & 0xf];
+            } else {
+                result += static_cast<char>(c);
+            }
+        }
+        return result;
+    }
+
 }
@@ -1,9 +1,5 @@
 #include "trap.h"
 
-#define DASM_PTR_TRAP \
-    dasm->asm_ss.str(""); \
-    dasm->asm_ss << "Instruction trapped: "
-
 #define FMT_P(x) msg << "> @ " << FORMAT_INST(pc, inst, x)
 #define FMT FMT_P(8)
 
@@ -17,9 +13,18 @@
     << ", pc="  << pc << std::dec
 
 
+#ifdef EXEC_LOG_EN
+// restarts the instruction text with the trap message, dasm must be set
+std::ostringstream& trap::trap_msg() {
+    dasm->asm_ss.str("");
+    dasm->asm_ss << "Instruction trapped: ";
+    return dasm->asm_ss;
+}
+#endif
+
 void trap::trap_inst(uint32_t cause, uint32_t tval) {
-    #ifdef DASM_EN
-    dasm->asm_ss << TRAP_CAUSE;
+    #ifdef EXEC_LOG_EN
+    if (dasm) dasm->asm_ss << TRAP_CAUSE;
     #endif
     inst_trapped = true;
     fn_ptr_trap_state_update(trap_state_update_ctx, cause, tval);
@@ -27,8 +32,8 @@ void trap::trap_inst(uint32_t cause, uint32_t tval) {
 
 // exception handling
 void trap::e_unsupported_inst([[maybe_unused]] const std::string &msg) {
-    #ifdef DASM_EN
-    DASM_PTR_TRAP << "Unsupported instruction <" << FMT;
+    #ifdef EXEC_LOG_EN
+    if (dasm) trap_msg() << "Unsupported instruction <" << FMT;
     #endif
     trap_inst(csr_map::mcause::illegal_inst, inst);
 }
@@ -36,15 +41,15 @@ void trap::e_unsupported_inst([[maybe_unused]] const std::string &msg) {
 void trap::e_illegal_inst(
     [[maybe_unused]] const std::string &msg, [[maybe_unused]] uint32_t memw)
 {
-    #ifdef DASM_EN
-    DASM_PTR_TRAP << "Illegal instruction <" << FMT_P(memw);
+    #ifdef EXEC_LOG_EN
+    if (dasm) trap_msg() << "Illegal instruction <" << FMT_P(memw);
     #endif
     trap_inst(csr_map::mcause::illegal_inst, inst);
 }
 
 void trap::e_env([[maybe_unused]] const std::string &msg, uint32_t code) {
-    #ifdef DASM_EN
-    DASM_PTR_TRAP << msg;
+    #ifdef EXEC_LOG_EN
+    if (dasm) trap_msg() << msg;
     #endif
     trap_inst(code, inst);
 }
@@ -52,8 +57,8 @@ void trap::e_env([[maybe_unused]] const std::string &msg, uint32_t code) {
 void trap::e_dmem_access_fault(
     uint32_t address, [[maybe_unused]] const std::string &msg, mem_op_t mem_op)
 {
-    #ifdef DASM_EN
-    DASM_PTR_TRAP << "Memory access fault at address <" << FMT_ADDR;
+    #ifdef EXEC_LOG_EN
+    if (dasm) trap_msg() << "Memory access fault at address <" << FMT_ADDR;
     #endif
     if (mem_op == mem_op_t::read) {
         trap_inst(csr_map::mcause::load_access_fault, address);
@@ -65,8 +70,8 @@ void trap::e_dmem_access_fault(
 void trap::e_dmem_addr_misaligned(
     uint32_t address, [[maybe_unused]] const std::string &msg, mem_op_t mem_op)
 {
-    #ifdef DASM_EN
-    DASM_PTR_TRAP << "Memory misaligned access at address <" << FMT_ADDR;
+    #ifdef EXEC_LOG_EN
+    if (dasm) trap_msg() << "Memory misaligned access at address <" << FMT_ADDR;
     #endif
     if (mem_op == mem_op_t::read) {
         trap_inst(csr_map::mcause::load_addr_misaligned, address);
@@ -78,8 +83,8 @@ void trap::e_dmem_addr_misaligned(
 void trap::e_inst_access_fault(
     uint32_t address, [[maybe_unused]] const std::string &msg)
 {
-    #ifdef DASM_EN
-    DASM_PTR_TRAP << "Fetch access fault at address <" << FMT_ADDR;
+    #ifdef EXEC_LOG_EN
+    if (dasm) trap_msg() << "Fetch access fault at address <" << FMT_ADDR;
     #endif
     trap_inst(csr_map::mcause::inst_access_fault, address);
 }
@@ -87,30 +92,30 @@ void trap::e_inst_access_fault(
 void trap::e_inst_addr_misaligned(
     uint32_t address, [[maybe_unused]] const std::string &msg)
 {
-    #ifdef DASM_EN
-    DASM_PTR_TRAP << "Fetch misaligned access at " << FMT_ADDR;
+    #ifdef EXEC_LOG_EN
+    if (dasm) trap_msg() << "Fetch misaligned access at " << FMT_ADDR;
     #endif
     trap_inst(csr_map::mcause::inst_addr_misaligned, address);
 }
 
 void trap::e_hardware_error([[maybe_unused]] const std::string &msg) {
-    #ifdef DASM_EN
-    DASM_PTR_TRAP << "Hardware Error <" << FMT;
+    #ifdef EXEC_LOG_EN
+    if (dasm) trap_msg() << "Hardware Error <" << FMT;
     #endif
     trap_inst(csr_map::mcause::hardware_error, inst);
 }
 
 // interrupt handling
 void trap::e_timer_interrupt() {
-    #ifdef DASM_EN
-    DASM_PTR_TRAP << "Timer interrupt";
+    #ifdef EXEC_LOG_EN
+    if (dasm) trap_msg() << "Timer interrupt";
     #endif
     trap_inst(csr_map::mcause::intr::machine_timer, 0);
 }
 
 void trap::e_external_interrupt() {
-    #ifdef DASM_EN
-    DASM_PTR_TRAP << "External interrupt";
+    #ifdef EXEC_LOG_EN
+    if (dasm) trap_msg() << "External interrupt";
     #endif
     trap_inst(csr_map::mcause::intr::machine_ext, 0);
 }
@@ -15,8 +15,8 @@ class trap {
         trap_state_update_fn_t fn_ptr_trap_state_update;
         const uint32_t& pc;
         const uint32_t& inst;
-        #ifdef DASM_EN
-        dasm_str* dasm;
+        #ifdef EXEC_LOG_EN
+        dasm_str* dasm = nullptr; // messages are built only when set
         #endif
 
     public:
@@ -37,7 +37,7 @@ class trap {
         }
         bool is_trapped() { return inst_trapped; }
         void clear_trap() { inst_trapped = false; }
-        #ifdef DASM_EN
+        #ifdef EXEC_LOG_EN
         void set_dasm(dasm_str* d) { dasm = d; }
         #endif
 
@@ -62,4 +62,7 @@ class trap {
 
     private:
         void trap_inst(uint32_t cause, uint32_t tval);
+        #ifdef EXEC_LOG_EN
+        std::ostringstream& trap_msg();
+        #endif
 };
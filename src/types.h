@@ -29,11 +29,16 @@ constexpr bool is_pow2(uint32_t n) {
 // Memory
 namespace mem_map {
     constexpr uint32_t base_addr = 0x8000'0000;
-    constexpr uint32_t mem_size = 131072; // 0x2'0000
-    //constexpr uint32_t mem_size = 262144; // 0x4'0000
+    constexpr uint32_t mem_size = 131072; // 0x2'0000, default for --mem_size
+    constexpr uint32_t mem_size_max = 0x4000'0000; // 1 GB
     static_assert (is_pow2(mem_size));
-    constexpr uint32_t addr_bits = is_log2(mem_size); // 17 bits
-    constexpr uint32_t addr_mask = (mem_size - 1);
+    constexpr uint32_t addr_bits = is_log2(mem_size); // 17 bits, default size
+    constexpr uint32_t addr_mask = (base_addr - 1); // offset from base_addr
+    // main memory is allocated in pages, on first write
+    constexpr uint32_t page_bits = 12;
+    constexpr uint32_t page_size = (1u << page_bits);
+    constexpr uint32_t page_mask = (page_size - 1);
+    static_assert (mem_size >= page_size);
     constexpr uint32_t uart0_addr = 0x1001'3000;
     constexpr uint32_t uart0_rx_data_addr = (uart0_addr + 0x04);
     constexpr uint32_t uart0_tx_data_addr = (uart0_addr + 0x08);
@@ -406,9 +411,26 @@ struct symbol_lut_entry_t {
     std::string name;
 };
 
+// symbol index of the nearest preceding symbol, per halfword of an
+// executable range, 0 if there is none
+struct symbol_pc_lut_t {
+    uint32_t base; // absolute address
+    uint32_t size; // bytes
+    std::vector<uint16_t> idx;
+};
+
+// calling context tree node, one per unique callstack
+// node 0 is the root (empty callstack), children are interned by symbol
+struct callstack_node_t {
+    uint32_t parent;
+    uint16_t idx; // symbol at the top of this callstack
+    bool saved; // counts were closed on this callstack at least once
+};
+
+// taken on every Nth occurrence of a perf event, in sampling mode
 struct symbol_tracking_t {
-    std::vector<uint16_t> idx_callstack;
-    std::vector<uint16_t> idx_callstack_prev;
+    uint32_t node; // current callstack
+    uint32_t node_prev;
     uint32_t fallthrough_pc;
     bool fallthrough_valid;
     bool updated;
@@ -505,6 +527,7 @@ namespace cache_cfg {
     constexpr uint32_t byte_addr_mask = (line_size - 1); // 0x3F, bottom 6 bits
     constexpr uint32_t max_sets = 1024;
     constexpr uint32_t max_ways = 128;
+    constexpr uint32_t max_rrpv_bits = 8;
 }
 
 // dasm
@@ -516,7 +539,8 @@ struct dasm_str {
         std::ostringstream simd_b;
         std::ostringstream simd_c;
         std::string asm_str;
-        std::string op;
+        const char* op = "";
+        bool en = false; // text is built only when something consumes it
     public:
         void finish_inst() {
             asm_ss << simd_ss.str();
@@ -524,6 +548,7 @@ struct dasm_str {
         }
         void clear_str() {
             asm_ss.str("");
+            asm_ss << std::right; // no alignment left over from skipped text
             simd_ss.str("");
         }
 };
@@ -579,9 +604,10 @@ struct prof_pc_t {
 
 struct cfg_t {
     prof_pc_t prof_pc;
-    rf_names_t rf_names;
+    rf_names_t rf_names = rf_names_t::mode_x;
     uint32_t mem_dump_start;
     uint32_t mem_dump_size;
+    uint32_t mem_size = mem_map::mem_size;
     std::vector<perf_event_t> perf_events;
     uint64_t run_insts;
     uint64_t run_steps;
@@ -589,15 +615,25 @@ struct cfg_t {
     bool rf_usage;
     bool no_callstack;
     bool prof_show;
-    bool log;
-    bool log_always;
-    bool log_state;
-    bool log_hw_models;
+    bool log = false;
+    bool log_bin = false;
+    bool log_always = false;
+    bool log_state = false;
+    bool log_hw_models = false;
     bool show_state;
     bool exit_on_trap;
     bool uart_show;
     std::string uart_in;
     std::string out_dir;
+    std::string ckpt_save;
+    std::string ckpt_restore;
+    bool fast_forward = false;
+    uint64_t ff_warmup = 0;
+    uint64_t prof_inst_start = 0;
+    uint64_t bbv_interval = 0;
+    uint64_t smarts_period = 0;
+    uint64_t smarts_unit = 0;
+    uint64_t perf_sample = 0;
 };
 
 struct logging_flags_t {
@@ -605,5 +641,7 @@ struct logging_flags_t {
     bool act;
     bool always;
     bool state;
+    bool txt; // exec.log
+    bool bin; // exec.bin
     void activate(bool in) { act = en && (in || always); }
 };
@@ -9,8 +9,14 @@
 #include "../src/defines.h"
 
 #define CHECK_PASS "0x051e tohost        : 0x00000001"
-#define SIM_BIN "../../src/build_gtest/ama-riscv-sim " // runs from test subdir
+// build dir and args are set per build variant, see test/Makefile
+#ifndef SIM_BDIR
+#define SIM_BDIR "build_gtest"
+#endif
+#ifndef SIM_ARGS
 #define SIM_ARGS "--bp_run_all "
+#endif
+#define SIM_BIN "../../src/" SIM_BDIR "/ama-riscv-sim " // runs from test subdir
 #define SIM_EXEC SIM_BIN SIM_ARGS
 
 struct cmd_setup {
@@ -37,6 +43,22 @@ class sim_test : public ::testing::TestWithParam<std::string> {
         }
 
     protected:
+        // architectural state at the end of the run, without host timing
+        std::string read_state(const std::string &log_name) {
+            std::ifstream log_file(log_name);
+            std::string line, state;
+            bool found = false;
+            while (std::getline(log_file, line)) {
+                auto has = [&](const char* s) {
+                    return line.find(s) != std::string::npos;
+                };
+                found |= has("SIMULATION FINISHED");
+                if (found && !has("Simulation performance"))
+                    state += line + "\n";
+            }
+            return state;
+        }
+
         bool check_test_result(const std::string &test_path) {
             cmd_setup cs = setup(test_path);
             int test_result = system(cs.sim_cmd.c_str());
@@ -107,6 +129,47 @@ TEST_F(sim_test, elf_file_not_found) {
     ASSERT_TRUE(check_error("not_found", "Failed to load ELF file."));
 }
 
+// restored run has to end in the same state as the uninterrupted one,
+// a few consecutive points so that some of them are right after a branch
+// lean variants show the state, others compare hw stats
+TEST_F(sim_test, ckpt_round_trip) {
+    const std::string elf = "../../examples/dhrystone.elf";
+    const std::string out = "examples_dhrystone_out_";
+    for (uint32_t n = 20005; n <= 20010; n++) {
+        std::string ns = std::to_string(n);
+        std::string ckpt = "dhrystone_" + ns + ".ckpt";
+        std::string log = "ckpt_round_trip_" + ns;
+        #ifdef SIM_LEAN
+        std::string start = "";
+        #else
+        // hw stats of the full run count from the restore point too
+        std::string start = " --prof_inst_start " + ns;
+        #endif
+        std::vector<std::string> tags = {"full", "save", "rest"};
+        std::vector<std::string> cmds = {
+            start,
+            " --run_insts " + ns + " --ckpt_save " + ckpt,
+            start + " --ckpt_restore " + ckpt
+        };
+        for (size_t i = 0; i < cmds.size(); i++) {
+            std::string cmd = SIM_EXEC + elf + " --out_dir_tag " + tags[i] +
+                "_" + ns + cmds[i] + " > " + log + "_" + tags[i] +
+                "_dump.log 2>&1";
+            ASSERT_EQ(system(cmd.c_str()), 0) << "Failed to run: " << cmd;
+        }
+        #ifdef SIM_LEAN
+        EXPECT_EQ(read_state(log + "_full_dump.log"),
+                  read_state(log + "_rest_dump.log"))
+            << "State differs after restore at instruction " << ns;
+        #else
+        std::string diff = "diff -q " + out + "full_" + ns + "/hw_stats.json " +
+            out + "rest_" + ns + "/hw_stats.json > /dev/null";
+        EXPECT_EQ(system(diff.c_str()), 0) << "HW stats differ after restore"
+            << " at instruction " << ns;
+        #endif
+    }
+}
+
 /* FIXME: need to generate oversized elf file
 TEST_F(sim_test, bin_file_oversized) {
     // generate dummy bin file larger than MEM_SIZE